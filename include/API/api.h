@@ -19,13 +19,20 @@
 
 #include "API/errors.h"
 
+#include <cstddef>
+#include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
 #include <unordered_map>
+#include <vector>
 
 namespace qssc {
 
+namespace config {
+struct QSSConfig;
+} // namespace config
+
 /// @brief Call the qss-compiler
 /// @param argc the number of argument strings
 /// @param argv array of argument strings
@@ -35,6 +42,68 @@ namespace qssc {
 int compile(int argc, char const **argv, std::string *outputString,
             std::optional<DiagnosticCallback> diagnosticCb);
 
+/// @brief Call the qss-compiler with a typed configuration
+///
+/// Unlike the argv based entry point this does not parse or modify the global
+/// command line options. It may be called concurrently from several threads.
+/// @param config the compilation configuration. Its input source is replaced
+/// by input, and its input type must be set.
+/// @param input the source to compile
+/// @param outputString the buffer receiving the compilation result, e.g., the
+/// payload bytes
+/// @param diagnosticCb an optional callback that will receive emitted
+/// diagnostics
+/// @return 0 on success
+int compile(const config::QSSConfig &config, std::string_view input,
+            std::string *outputString,
+            std::optional<DiagnosticCallback> diagnosticCb = std::nullopt);
+
+/// @brief A long-lived compiler that is reused across many compilations.
+///
+/// Creating a session performs the fixed startup work of the qss-compiler
+/// once: options are parsed, passes are registered, the dialects are loaded
+/// into an MLIRContext (along with its thread pool) and the target is
+/// constructed from its configuration. Each job then only creates the state
+/// that is specific to it, i.e., the input, the module, the payload and the
+/// output.
+///
+/// All options, including the target and its configuration, are fixed when
+/// the session is created. Jobs submitted to the same session are serialized.
+class CompilerSession {
+public:
+  /// @brief Create a compiler session
+  /// @param argc the number of argument strings
+  /// @param argv array of argument strings, as accepted by compile. The input
+  /// named here is ignored as each job supplies its own.
+  /// @param diagnosticCb an optional callback that will receive emitted
+  /// diagnostics of jobs that do not supply their own
+  /// @return the session, or nullptr if it could not be created
+  static std::unique_ptr<CompilerSession>
+  create(int argc, char const **argv,
+         std::optional<DiagnosticCallback> diagnosticCb = std::nullopt);
+
+  ~CompilerSession();
+
+  CompilerSession(const CompilerSession &) = delete;
+  CompilerSession &operator=(const CompilerSession &) = delete;
+
+  /// @brief Compile a single job with this session
+  /// @param input the path of the input file or, for sessions created with
+  /// --direct, the input source itself
+  /// @param outputString an optional buffer for the compilation result
+  /// @param diagnosticCb an optional callback that will receive emitted
+  /// diagnostics
+  /// @return 0 on success
+  int compile(std::string_view input, std::string *outputString,
+              std::optional<DiagnosticCallback> diagnosticCb = std::nullopt);
+
+private:
+  CompilerSession();
+
+  struct Impl;
+  std::unique_ptr<Impl> impl;
+};
+
 /// @brief Call the parameter binder
 /// @param target name of the target to employ
 /// @param moduleInputPath path of the module to use as input
@@ -52,5 +121,56 @@ int bindArguments(std::string_view target, std::string_view configPath,
                   std::string *inMemoryOutput,
                   const std::optional<DiagnosticCallback> &onDiagnostic);
 
+/// @brief Call the parameter binder for many sets of arguments against one
+/// module. The target is created and the module signature is parsed once,
+/// and the argument sets are bound in parallel.
+/// @param target name of the target to employ
+/// @param moduleInput path or contents of the module to use as input
+/// @param payloadOutputPaths paths of the payloads to generate as output, one
+/// per argument set, or empty to return the payloads in inMemoryOutputs
+/// @param arguments the sets of bindings to apply, one payload per set
+/// @param treatWarningsAsErrors return errors in place of warnings
+/// @param inMemoryOutputs receives one payload per argument set when
+/// payloadOutputPaths is empty
+/// @param diagnosticCb an optional callback that will receive emitted
+/// diagnostics
+/// @param emitOverlays output a compact overlay of the changes to the module
+/// per argument set instead of a full payload, see payload::PayloadOverlay
+/// @return 0 on success
+int bindArgumentsBatch(
+    std::string_view target, std::string_view configPath,
+    std::string_view moduleInput,
+    std::vector<std::string> const &payloadOutputPaths,
+    std::vector<std::unordered_map<std::string, double>> const &arguments,
+    bool treatWarningsAsErrors, bool enableInMemoryInput,
+    std::vector<std::string> *inMemoryOutputs,
+    const std::optional<DiagnosticCallback> &onDiagnostic,
+    bool emitOverlays = false);
+
+/// @brief Call the parameter binder for the points of a sweep given as a
+/// matrix of parameter values, as bindArgumentsBatch does. Patch points are
+/// encoded a column of values at a time.
+/// @param parameterNames the name of the parameter of each row of values
+/// @param values parameterNames.size() rows of numPoints values each, in
+/// row-major order
+/// @param numPoints the number of points of the sweep, one payload per point
+int bindArgumentColumns(
+    std::string_view target, std::string_view configPath,
+    std::string_view moduleInput,
+    std::vector<std::string> const &payloadOutputPaths,
+    std::vector<std::string> const &parameterNames,
+    std::vector<double> const &values, size_t numPoints,
+    bool treatWarningsAsErrors, bool enableInMemoryInput,
+    std::vector<std::string> *inMemoryOutputs,
+    const std::optional<DiagnosticCallback> &onDiagnostic,
+    bool emitOverlays = false);
+
+/// @brief Release the targets cached by the parameter binders. The binders
+/// create a target once per target name and configuration path and reuse it
+/// until the modification time or size of the configuration file changes.
+/// Clear the cache to free the targets or to pick up changes to a target
+/// that do not touch its configuration file.
+void clearBindTargetCache();
+
 } // namespace qssc
 #endif // QSS_COMPILER_LIB_H
@@ -26,15 +26,27 @@
 #include "API/errors.h"
 #include "Dialect/QCS/IR/QCSTypes.h"
 
+#include "Arguments/BindingPlan.h"
 #include "Arguments/Signature.h"
 #include "Payload/Payload.h"
 
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Error.h"
 
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace llvm {
+class ThreadPool;
+} // namespace llvm
+
 namespace qssc::arguments {
 
-using ArgumentType = std::variant<std::optional<double>>;
 using OptDiagnosticCallback = std::optional<qssc::DiagnosticCallback>;
 
 class ArgumentSource {
@@ -59,6 +71,32 @@ public:
   getPayload(llvm::StringRef payloadOutputPath, bool enableInMemory) = 0;
   virtual llvm::Expected<Signature>
   parseSignature(qssc::payload::PatchablePayload *payload) = 0;
+  /// @brief Parse the signature of payload into a binding plan, which is
+  /// what binding uses. The default resolves the signature returned by
+  /// parseSignature. Targets whose payloads hold binary signatures override
+  /// this to build the plan straight from a BinarySignatureView over
+  /// PatchablePayload::viewMember, see BindingPlan::create.
+  virtual llvm::Expected<BindingPlan>
+  parseBindingPlan(qssc::payload::PatchablePayload *payload);
+  /// @brief Encode value as the bytes to be written at the offset of
+  /// patchPoint, appending them to bytes. Returns false if the patch point
+  /// must be bound by patch() on the binary, which is the default. When
+  /// every patch point of a binary can be encoded, the binary is patched
+  /// through PatchablePayload::patchMember without being read.
+  virtual llvm::Expected<bool> encodePatch(PatchPoint const &patchPoint,
+                                           ArgumentType const &value,
+                                           llvm::SmallVectorImpl<char> &bytes) {
+    return false;
+  }
+  /// @brief Encode the values of the parameter of patchPoint for many
+  /// sweep points, appending one encoding of the same size per value to
+  /// bytes. Returns false if the patch point must be bound by patch(). The
+  /// default encodes each value with encodePatch; targets override this to
+  /// encode a whole column at once, e.g., with loops that vectorize.
+  virtual llvm::Expected<bool>
+  encodePatchColumn(PatchPoint const &patchPoint,
+                    llvm::ArrayRef<double> values,
+                    llvm::SmallVectorImpl<char> &bytes);
   void setTreatWarningsAsErrors(bool val) { treatWarningsAsErrors_ = val; }
 
 protected:
@@ -77,6 +115,50 @@ public:
   create(std::vector<char> &buf, OptDiagnosticCallback onDiagnostic) = 0;
   virtual BindArgumentsImplementation *
   create(std::string &str, OptDiagnosticCallback onDiagnostic) = 0;
+  /// @brief Whether BindArgumentsImplementation instances created for
+  /// different binaries may patch concurrently, i.e., whether they are
+  /// thread safe per instance. If so, binaries are patched in parallel when
+  /// a thread pool is available.
+  virtual bool supportsParallelPatching() const { return false; }
+};
+
+/// @brief Serializes the creation of bind implementations by a target
+/// factory, which is not required to be thread safe.
+class SynchronizedBindArgumentsFactory
+    : public BindArgumentsImplementationFactory {
+public:
+  explicit SynchronizedBindArgumentsFactory(
+      BindArgumentsImplementationFactory &factory)
+      : factory_(factory) {}
+
+  BindArgumentsImplementation *
+  create(OptDiagnosticCallback onDiagnostic) override {
+    // NOLINTNEXTLINE(clang-diagnostic-ctad-maybe-unsupported)
+    std::lock_guard lock(mutex_);
+    return factory_.create(std::move(onDiagnostic));
+  }
+
+  BindArgumentsImplementation *
+  create(std::vector<char> &buf, OptDiagnosticCallback onDiagnostic) override {
+    // NOLINTNEXTLINE(clang-diagnostic-ctad-maybe-unsupported)
+    std::lock_guard lock(mutex_);
+    return factory_.create(buf, std::move(onDiagnostic));
+  }
+
+  BindArgumentsImplementation *
+  create(std::string &str, OptDiagnosticCallback onDiagnostic) override {
+    // NOLINTNEXTLINE(clang-diagnostic-ctad-maybe-unsupported)
+    std::lock_guard lock(mutex_);
+    return factory_.create(str, std::move(onDiagnostic));
+  }
+
+  bool supportsParallelPatching() const override {
+    return factory_.supportsParallelPatching();
+  }
+
+private:
+  BindArgumentsImplementationFactory &factory_;
+  std::mutex mutex_;
 };
 
 // TODO generalize type of arguments
@@ -86,7 +168,62 @@ llvm::Error bindArguments(llvm::StringRef moduleInput,
                           bool treatWarningsAsErrors, bool enableInMemoryInput,
                           std::string *inMemoryOutput,
                           BindArgumentsImplementationFactory &factory,
-                          const OptDiagnosticCallback &onDiagnostic);
+                          const OptDiagnosticCallback &onDiagnostic,
+                          llvm::ThreadPool *threadPool = nullptr);
+
+/// @brief Bind values, ordered by the parameter indices of plan, to payload.
+/// Binding performs no lookups by parameter name unless a binary has patch
+/// points that encoder cannot encode.
+/// @param encoder Encodes patch points, see
+/// BindArgumentsImplementation::encodePatch
+/// @param factory Creates the implementations patching binaries that cannot
+/// be encoded
+/// @param threadPool Patches such binaries concurrently if the factory
+/// supports parallel patching. Binaries are always read sequentially.
+llvm::Error applyBindingPlan(qssc::payload::PatchablePayload *payload,
+                             BindingPlan const &plan,
+                             llvm::ArrayRef<ArgumentType> values,
+                             bool treatWarningsAsErrors,
+                             BindArgumentsImplementation &encoder,
+                             BindArgumentsImplementationFactory &factory,
+                             const OptDiagnosticCallback &onDiagnostic,
+                             llvm::ThreadPool *threadPool = nullptr);
+
+class ColumnarArguments;
+
+/// @brief Bind each point of a sweep to its own copy of one compiled module
+/// as bindArgumentsBatch does. Patch points are encoded a column at a time
+/// with BindArgumentsImplementation::encodePatchColumn before any point is
+/// bound.
+/// @param payloadOutputPaths One output path per point, or empty to return
+/// the payloads in inMemoryOutputs
+llvm::Error bindArgumentColumns(
+    llvm::StringRef moduleInput, llvm::ArrayRef<std::string> payloadOutputPaths,
+    ColumnarArguments const &arguments, bool treatWarningsAsErrors,
+    bool enableInMemoryInput, std::vector<std::string> *inMemoryOutputs,
+    BindArgumentsImplementationFactory &factory,
+    const OptDiagnosticCallback &onDiagnostic, llvm::ThreadPool *threadPool,
+    bool emitOverlays = false);
+
+/// @brief Bind each of argumentSets to its own copy of one compiled module.
+/// The module is read and its signature parsed once, then the argument sets
+/// are bound concurrently on threadPool, or sequentially if it is null.
+/// @param payloadOutputPaths One output path per argument set, or empty to
+/// return the payloads in inMemoryOutputs
+/// @param inMemoryOutputs Resized to hold one payload per argument set when
+/// payloadOutputPaths is empty
+/// @param emitOverlays Output a payload::PayloadOverlay on moduleInput per
+/// argument set rather than a full payload, so that the module is not copied
+/// per argument set
+/// @return The errors of all failed argument sets, in order
+llvm::Error bindArgumentsBatch(
+    llvm::StringRef moduleInput, llvm::ArrayRef<std::string> payloadOutputPaths,
+    llvm::ArrayRef<ArgumentSource const *> argumentSets,
+    bool treatWarningsAsErrors, bool enableInMemoryInput,
+    std::vector<std::string> *inMemoryOutputs,
+    BindArgumentsImplementationFactory &factory,
+    const OptDiagnosticCallback &onDiagnostic, llvm::ThreadPool *threadPool,
+    bool emitOverlays = false);
 
 } // namespace qssc::arguments
 
@@ -0,0 +1,102 @@
+//===- BindingPlan.h --------------------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares the BindingPlan, a form of a circuit signature in
+///  which parameter expressions are resolved to dense indices so that
+///  arguments can be bound repeatedly without looking up parameters by name.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef ARGUMENTS_BINDINGPLAN_H
+#define ARGUMENTS_BINDINGPLAN_H
+
+#include "Arguments/Signature.h"
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <variant>
+#include <vector>
+
+namespace qssc::arguments {
+
+using ArgumentType = std::variant<std::optional<double>>;
+
+class ArgumentSource;
+
+class BindingPlan {
+public:
+  /// @brief A patch point with its parameter resolved to a dense index
+  struct Entry {
+    uint64_t offset;
+    uint32_t parameter;
+    /// The patch point of the signature the entry was resolved from
+    PatchPoint const *patchPoint;
+  };
+
+  struct Binary {
+    std::string name;
+    std::vector<Entry> entries;
+  };
+
+  /// @brief Resolve the parameters of signature, which is owned by the plan.
+  /// Parameters are numbered in order of first appearance.
+  explicit BindingPlan(Signature signature);
+
+  /// @brief Build a plan straight from a binary signature, without
+  /// materializing a Signature. Parameters are taken from the parameter
+  /// table of view and numbered in its order, so no expression is looked up
+  /// per patch point. The plan does not refer to the buffer of view.
+  static llvm::Expected<BindingPlan> create(BinarySignatureView const &view);
+
+  // entries point into the owned signature or patch points
+  BindingPlan(const BindingPlan &) = delete;
+  BindingPlan &operator=(const BindingPlan &) = delete;
+  BindingPlan(BindingPlan &&) = default;
+  BindingPlan &operator=(BindingPlan &&) = default;
+
+  llvm::ArrayRef<Binary> getBinaries() const { return binaries; }
+
+  size_t getNumParameters() const { return parameterNames.size(); }
+  llvm::ArrayRef<std::string> getParameterNames() const {
+    return parameterNames;
+  }
+  std::optional<uint32_t> lookupParameter(llvm::StringRef name) const;
+
+  /// @brief Look up the value of every parameter in arguments once, ordered
+  /// by parameter index
+  std::vector<ArgumentType> resolve(ArgumentSource const &arguments) const;
+
+private:
+  BindingPlan() = default;
+
+  /// Owns the patch points of plans resolved from a Signature
+  Signature signature;
+  /// Owns the patch points of plans built from a BinarySignatureView
+  std::vector<PatchPoint> patchPoints;
+  std::vector<Binary> binaries;
+  std::vector<std::string> parameterNames;
+  llvm::StringMap<uint32_t> parameterIndices;
+}; // class BindingPlan
+
+} // namespace qssc::arguments
+
+#endif // ARGUMENTS_BINDINGPLAN_H
@@ -0,0 +1,82 @@
+//===- ColumnarArguments.h --------------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares ColumnarArguments, the argument values of a parameter
+///  sweep held as one column of values per parameter.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef ARGUMENTS_COLUMNARARGUMENTS_H
+#define ARGUMENTS_COLUMNARARGUMENTS_H
+
+#include "Arguments/Arguments.h"
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace qssc::arguments {
+
+/// @brief Argument values for the points of a sweep, held as a parameters x
+/// points matrix so that columns of values, e.g., from NumPy arrays, are
+/// bound without being converted to one ArgumentSource per point. The
+/// matrix is borrowed, not copied.
+class ColumnarArguments {
+public:
+  /// @brief ArgumentSource for one point of the sweep
+  class Point : public ArgumentSource {
+  public:
+    Point(ColumnarArguments const &arguments, size_t point)
+        : arguments_(arguments), point_(point) {}
+    ArgumentType getArgumentValue(llvm::StringRef name) const override;
+
+  private:
+    ColumnarArguments const &arguments_;
+    size_t point_;
+  };
+
+  /// @param parameterNames The name of the parameter of each row
+  /// @param values Matrix of parameterNames.size() rows of numPoints values
+  /// in row-major order, which must outlive the arguments
+  static llvm::Expected<ColumnarArguments>
+  create(llvm::ArrayRef<std::string> parameterNames,
+         llvm::ArrayRef<double> values, size_t numPoints);
+
+  size_t getNumParameters() const { return indices_.size(); }
+  size_t getNumPoints() const { return numPoints_; }
+
+  /// @brief Get the values of the parameter name for all points, if any
+  std::optional<llvm::ArrayRef<double>> getColumn(llvm::StringRef name) const;
+  Point getPoint(size_t point) const { return Point(*this, point); }
+
+private:
+  ColumnarArguments(llvm::ArrayRef<double> values, size_t numPoints)
+      : values_(values), numPoints_(numPoints) {}
+
+  llvm::ArrayRef<double> values_;
+  size_t numPoints_;
+  llvm::StringMap<uint32_t> indices_;
+}; // class ColumnarArguments
+
+} // namespace qssc::arguments
+
+#endif // ARGUMENTS_COLUMNARARGUMENTS_H
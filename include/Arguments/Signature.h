@@ -29,7 +29,9 @@
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Error.h"
 
+#include <cstdint>
 #include <map>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -70,8 +72,14 @@ public:
                               const PatchPoint &p);
   void dump();
 
+  /// @brief Serialize to the line based text format (version 1)
   std::string serialize();
 
+  /// @brief Serialize to the binary format (version 2), see
+  /// BinarySignatureView
+  std::string serializeBinary() const;
+
+  /// @brief Deserialize a signature in either the text or the binary format
   static llvm::Expected<Signature>
   deserialize(llvm::StringRef,
               const std::optional<qssc::DiagnosticCallback> &onDiagnostic,
@@ -80,6 +88,88 @@ public:
   bool isEmpty() { return patchPointsByBinary.size() == 0; }
 };
 
+/// @brief Read-only view of a signature in the binary format (version 2).
+///
+/// The format consists of a fixed size header followed by fixed width
+/// records, so that a view is created in constant time over a buffer that
+/// may be memory mapped, and individual records are read on demand. All
+/// integers are little endian. Strings, i.e., binary names, expressions and
+/// patch types, are deduplicated in a string table and referenced by index.
+/// Accessors given an index past the counts of the header do not read the
+/// buffer; they return an empty string, zero, or the respective count as an
+/// invalid index.
+///
+///   header:      magic "QSSC_SIG", version, numStrings, numBinaries,
+///                numPatchPoints, numParameters, stringDataSize (u32 each)
+///   strings:     numStrings x {offset, size} (u32) into the string data
+///   binaries:    numBinaries x {name, firstPatchPoint, numPatchPoints} (u32)
+///   patchPoints: numPatchPoints x {offset (u64), expression, patchType,
+///                binary, reserved (u32)}, grouped by binary
+///   parameters:  numParameters x {expression, firstEntry, numEntries} (u32),
+///                sorted by expression
+///   entries:     numPatchPoints x patch point index (u32), grouped by
+///                parameter
+///   string data: stringDataSize bytes
+class BinarySignatureView {
+public:
+  static constexpr uint32_t version = 2;
+
+  /// @brief Whether buffer starts like a binary signature
+  static bool isBinarySignature(llvm::StringRef buffer);
+
+  /// @brief Create a view over buffer, which must outlive the view. Only
+  /// the header and the section bounds are validated.
+  static llvm::Expected<BinarySignatureView> create(llvm::StringRef buffer);
+
+  uint32_t getNumBinaries() const { return numBinaries; }
+  uint32_t getNumPatchPoints() const { return numPatchPoints; }
+  uint32_t getNumParameters() const { return numParameters; }
+
+  llvm::StringRef getBinaryName(uint32_t binary) const;
+  /// @brief The patch points of binary are the consecutive range
+  /// [getFirstPatchPoint(binary), + getNumPatchPoints(binary))
+  uint32_t getFirstPatchPoint(uint32_t binary) const;
+  uint32_t getNumPatchPoints(uint32_t binary) const;
+
+  uint64_t getPatchPointOffset(uint32_t patchPoint) const;
+  llvm::StringRef getPatchPointExpression(uint32_t patchPoint) const;
+  llvm::StringRef getPatchPointType(uint32_t patchPoint) const;
+  uint32_t getPatchPointBinary(uint32_t patchPoint) const;
+  PatchPoint getPatchPoint(uint32_t patchPoint) const;
+
+  llvm::StringRef getParameterName(uint32_t parameter) const;
+  /// @brief Find the parameter with the given expression by binary search
+  std::optional<uint32_t> findParameter(llvm::StringRef expression) const;
+  /// @brief Number of patch points bound to parameter
+  uint32_t getNumParameterPatchPoints(uint32_t parameter) const;
+  /// @brief Index of the entry-th patch point bound to parameter, or
+  /// getNumPatchPoints() if the entry is out of range
+  uint32_t getParameterPatchPoint(uint32_t parameter, uint32_t entry) const;
+
+  /// @brief Materialize the signature
+  Signature toSignature() const;
+
+private:
+  BinarySignatureView() = default;
+
+  llvm::StringRef getString(uint32_t index) const;
+  uint32_t readField(uint64_t sectionOffset, uint64_t recordSize,
+                     uint32_t record, uint32_t field) const;
+
+  llvm::StringRef buffer;
+  uint32_t numStrings = 0;
+  uint32_t numBinaries = 0;
+  uint32_t numPatchPoints = 0;
+  uint32_t numParameters = 0;
+  uint64_t stringsOffset = 0;
+  uint64_t binariesOffset = 0;
+  uint64_t patchPointsOffset = 0;
+  uint64_t parametersOffset = 0;
+  uint64_t entriesOffset = 0;
+  uint64_t stringDataOffset = 0;
+  uint64_t stringDataSize = 0;
+};
+
 } // namespace qssc::arguments
 
 #endif // PARAMETER_SIGNATURE_H
@@ -164,6 +164,18 @@ public:
   }
   bool shouldEmitPlaintextPayload() const { return emitPlaintextPayloadFlag; }
 
+  QSSConfig &streamPayload(bool flag) {
+    streamPayloadFlag = flag;
+    return *this;
+  }
+  bool shouldStreamPayload() const { return streamPayloadFlag; }
+
+  QSSConfig &setPayloadCompression(std::string spec) {
+    payloadCompression = std::move(spec);
+    return *this;
+  }
+  llvm::StringRef getPayloadCompression() const { return payloadCompression; }
+
   QSSConfig &includeSource(bool flag) {
     includeSourceFlag = flag;
     return *this;
@@ -228,6 +240,12 @@ protected:
   bool showConfigFlag = false;
   /// @brief Should the plaintext payload be emitted
   bool emitPlaintextPayloadFlag = false;
+  /// @brief Should payload files be streamed to the output as each target
+  /// finishes emitting rather than after the whole payload is built
+  bool streamPayloadFlag = false;
+  /// @brief Per-file payload compression rules in the format understood by
+  /// the payload, e.g. "*.bin=zstd,*.mlir=deflate". Empty stores all files.
+  std::string payloadCompression;
   /// @brief Should the input source be included in the payload
   bool includeSourceFlag = false;
   /// @brief Should the IR be compiled for the target
@@ -254,6 +272,12 @@ void setContextConfig(mlir::MLIRContext *context, const QSSConfig &config);
 /// @param context The context to lookup the configuration for.
 llvm::Expected<const QSSConfig &> getContextConfig(mlir::MLIRContext *context);
 
+/// @brief Release the configuration registered for this context. Must be
+/// called before the context is destroyed as a new context may be allocated
+/// at the same address.
+/// @param context The context to release the configuration of.
+void releaseContextConfig(mlir::MLIRContext *context);
+
 /// @brief Load a dynamic dialect plugin
 /// @param pluginPath Path to the plugin
 /// @param registry Dialect registry to register the plugin dialect with
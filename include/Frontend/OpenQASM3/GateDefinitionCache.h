@@ -0,0 +1,94 @@
+//===- GateDefinitionCache.h ------------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares the cache of the QUIR definitions generated for
+///  OpenQASM 3 gate declarations.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef OPENQASM3_GATE_DEFINITION_CACHE_H
+#define OPENQASM3_GATE_DEFINITION_CACHE_H
+
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/Operation.h"
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace qssc::frontend::openqasm3 {
+
+/// @brief Process-wide cache of the definitions generated for gate
+/// declarations, e.g., those of standard gate and calibration libraries that
+/// every program includes, keyed by a description of the declaration.
+/// Definitions are stored as MLIR bytecode, so they are reused across
+/// compilations and contexts and can be persisted in a directory to be reused
+/// across processes.
+///
+/// Definitions are found by a hash of their key but are stored together with
+/// the full key, which is compared on lookup, so that declarations whose
+/// keys collide never share a definition.
+class GateDefinitionCache {
+public:
+  static GateDefinitionCache &instance();
+
+  /// @brief Insert the definition cached for key at the insertion point of
+  /// builder
+  /// @param key Description of the declaration, which must capture
+  /// everything that the generated definition depends on
+  /// @param directory If not empty, the directory definitions are persisted
+  /// in, which is searched if the definition is not cached in memory
+  /// @return the inserted definition or nullptr if none is cached
+  mlir::Operation *lookup(llvm::StringRef key, mlir::OpBuilder &builder,
+                          llvm::StringRef directory = "");
+
+  /// @brief Cache definition for key and persist it in directory if that is
+  /// not empty. Failures to persist a definition are ignored.
+  void insert(llvm::StringRef key, mlir::Operation *definition,
+              llvm::StringRef directory = "");
+
+  /// @brief Drop all definitions cached in memory
+  void clear();
+
+private:
+  GateDefinitionCache() = default;
+
+  struct Definition {
+    std::string key;
+    std::string bytecode;
+  };
+
+  static uint64_t computeHash(llvm::StringRef key);
+  static std::string getPath(llvm::StringRef directory, uint64_t hash);
+
+  /// Read a definition persisted by serialize(), none if file is malformed
+  static std::shared_ptr<const Definition> deserialize(llvm::StringRef file);
+  /// Persist definition as the size of its key as a little endian 64-bit
+  /// integer, followed by its key and its bytecode
+  static void serialize(llvm::raw_ostream &os, Definition const &definition);
+
+  std::mutex mutex;
+  llvm::DenseMap<uint64_t, std::shared_ptr<const Definition>> definitions;
+}; // class GateDefinitionCache
+
+} // namespace qssc::frontend::openqasm3
+
+#endif // OPENQASM3_GATE_DEFINITION_CACHE_H
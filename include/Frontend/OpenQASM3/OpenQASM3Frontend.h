@@ -45,6 +45,12 @@ namespace qssc::frontend::openqasm3 {
 /// @param diagnosticCb a callback that will receive emitted diagnostics
 /// @return an llvm::Error in case of failure, or llvm::Error::success()
 /// otherwise
+///
+/// May be called from several threads, each with a module of its own
+/// context. The parser library keeps its state in process-wide singletons,
+/// so only parsing and converting the AST are serialized across threads,
+/// while reading the input and verifying the generated IR run concurrently.
+/// Diagnostics are delivered to the diagnosticCb of the calling thread.
 llvm::Error parse(std::string const &source, bool sourceIsFilename,
                   bool emitRawAST, bool emitPrettyAST, bool emitMLIR,
                   mlir::ModuleOp newModule,
@@ -24,19 +24,20 @@
 #include "Dialect/QUIR/Transforms/Passes.h"
 #include "Frontend/OpenQASM3/BaseQASM3Visitor.h"
 #include "Frontend/OpenQASM3/QUIRVariableBuilder.h"
+#include "Frontend/OpenQASM3/ScopedSSAValues.h"
 
 #include "mlir/Dialect/Complex/IR/Complex.h"
 #include "llvm/Support/Error.h"
 
-#include <unordered_map>
+#include <cstdint>
 
 namespace qssc::frontend::openqasm3 {
 
 class QUIRGenQASM3Visitor : public BaseQASM3Visitor {
 private:
-  // References to MLIR single static assignment Values
-  // (TODO needs to be refactored)
-  std::unordered_map<std::string, mlir::Value> ssaValues;
+  // References to MLIR single static assignment Values of the variables in
+  // scope
+  ScopedSSAValues ssaValues;
   std::vector<mlir::Value> ssaOtherValues;
   mlir::OpBuilder builder;
   mlir::OpBuilder topLevelBuilder;
@@ -78,6 +79,10 @@ private:
   llvm::Expected<std::string> resolveQCParam(const QASM::ASTGateNode *gateNode,
                                              unsigned int index);
 
+  /// Key of the definition generated for a gate declaration in the
+  /// GateDefinitionCache
+  std::string getGateCacheKey(const QASM::ASTGateDeclarationNode *node);
+
   /// \brief
   /// Create a diagnostic with the specified severity and location from the
   /// provided AST node.
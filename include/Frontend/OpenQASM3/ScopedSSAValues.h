@@ -0,0 +1,158 @@
+//===- ScopedSSAValues.h ----------------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares the scoped table of the SSA values of the variables
+///  visible while generating QUIR from OpenQASM 3.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef OPENQASM3_SCOPED_SSA_VALUES_H
+#define OPENQASM3_SCOPED_SSA_VALUES_H
+
+#include "mlir/IR/Value.h"
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/iterator.h"
+
+#include <cassert>
+#include <cstddef>
+#include <optional>
+#include <utility>
+
+namespace qssc::frontend::openqasm3 {
+
+/// @brief The SSA values of the variables visible at the current point of
+/// QUIR generation, by name. Values set in a nested scope shadow those of
+/// enclosing scopes until the nested scope is left.
+///
+/// The visible values are kept in a single map and every change made within
+/// a scope is recorded in an undo log, so entering a scope takes constant
+/// time and leaving it takes time linear in the number of values it set,
+/// independent of the number of visible values.
+///
+/// Iteration visits the visible values in the order their names were first
+/// set, so that what is generated from it, e.g., the arguments of circuits,
+/// does not depend on the hashing of the names.
+class ScopedSSAValues {
+  using Entry = llvm::StringMapEntry<mlir::Value>;
+
+public:
+  using const_iterator =
+      llvm::pointee_iterator<llvm::SmallVectorImpl<Entry *>::const_iterator,
+                             Entry const>;
+
+  /// @brief A nested scope, which sees the values of its enclosing scopes,
+  /// for its lifetime
+  class Scope {
+  public:
+    explicit Scope(ScopedSSAValues &table) : table(table) {
+      table.scopeStarts.push_back(table.undoLog.size());
+    }
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+    ~Scope() { table.popScope(); }
+
+  private:
+    ScopedSSAValues &table;
+  };
+
+  /// @brief A scope which does not see the values of its enclosing scopes,
+  /// e.g., the body of a gate declaration, for its lifetime
+  class IsolatedScope;
+
+  /// @brief The value of name, none if name is not visible
+  std::optional<mlir::Value> lookup(llvm::StringRef name) const {
+    auto pos = values.find(name);
+    if (pos == values.end())
+      return std::nullopt;
+    return pos->second;
+  }
+  bool contains(llvm::StringRef name) const { return values.count(name); }
+
+  const_iterator begin() const { return const_iterator(order.begin()); }
+  const_iterator end() const { return const_iterator(order.end()); }
+
+  /// @brief Set the value of name in the innermost scope
+  void set(llvm::StringRef name, mlir::Value value) {
+    auto [pos, inserted] = values.try_emplace(name, value);
+    if (inserted)
+      order.push_back(&*pos);
+    if (!scopeStarts.empty())
+      undoLog.push_back({&*pos, inserted ? std::optional<mlir::Value>()
+                                         : std::optional(pos->second)});
+    pos->second = value;
+  }
+
+private:
+  struct Change {
+    Entry *entry;
+    /// Value before the change, none if the change added the entry
+    std::optional<mlir::Value> previous;
+  };
+
+  void popScope() {
+    size_t const start = scopeStarts.pop_back_val();
+    while (undoLog.size() > start) {
+      Change const change = undoLog.pop_back_val();
+      if (change.previous) {
+        change.entry->second = *change.previous;
+        continue;
+      }
+      // entries are removed in the reverse order of their insertion, so an
+      // entry added within a scope is always the last one in order
+      assert(order.back() == change.entry && "scopes must be left in order");
+      order.pop_back();
+      values.erase(change.entry->getKey());
+    }
+  }
+
+  llvm::StringMap<mlir::Value> values;
+  /// Entries of values in the order they were inserted
+  llvm::SmallVector<Entry *> order;
+  /// Changes made within the open scopes, in order
+  llvm::SmallVector<Change> undoLog;
+  /// Size of the undo log when each open scope was entered
+  llvm::SmallVector<size_t> scopeStarts;
+}; // class ScopedSSAValues
+
+/// Swaps the table with an empty one, which is constant time
+class ScopedSSAValues::IsolatedScope {
+public:
+  explicit IsolatedScope(ScopedSSAValues &table) : table(table) {
+    std::swap(table.values, saved.values);
+    std::swap(table.order, saved.order);
+    std::swap(table.undoLog, saved.undoLog);
+    std::swap(table.scopeStarts, saved.scopeStarts);
+  }
+  IsolatedScope(const IsolatedScope &) = delete;
+  IsolatedScope &operator=(const IsolatedScope &) = delete;
+  ~IsolatedScope() {
+    std::swap(table.values, saved.values);
+    std::swap(table.order, saved.order);
+    std::swap(table.undoLog, saved.undoLog);
+    std::swap(table.scopeStarts, saved.scopeStarts);
+  }
+
+private:
+  ScopedSSAValues &table;
+  ScopedSSAValues saved;
+};
+
+} // namespace qssc::frontend::openqasm3
+
+#endif // OPENQASM3_SCOPED_SSA_VALUES_H
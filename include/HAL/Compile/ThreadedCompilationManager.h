@@ -23,8 +23,18 @@
 
 #include "HAL/Compile/TargetCompilationManager.h"
 
+#include "llvm/ADT/ArrayRef.h"
+
+#include <cstdint>
+#include <map>
+#include <memory>
 #include <mutex>
+#include <optional>
+#include <shared_mutex>
 #include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace qssc::hal::compile {
 
@@ -56,12 +66,39 @@ protected:
       const TargetCompilationManager::WalkTargetModulesFunction
           &postChildrenCallbackFunc);
 
+  /// Dependency driven walker for a target system's modules using the current
+  /// MLIRContext's threadpool. Each stage of a target and its post-children
+  /// callback are submitted as separate tasks as soon as their inputs are
+  /// ready: the stages of a target run in order after the stages of its
+  /// parent, and the post-children callback once the target's stages and all
+  /// of its children's subtrees have completed. No thread waits on an
+  /// individual level of the target tree. Falls back to
+  /// walkTargetModulesThreaded if dependency scheduling or multithreading is
+  /// disabled.
+  llvm::Error scheduleTargetModules(
+      Target *target, mlir::ModuleOp targetModuleOp, mlir::TimingScope &timing,
+      llvm::ArrayRef<TargetCompilationManager::WalkTargetModulesFunction>
+          stages,
+      const TargetCompilationManager::WalkTargetModulesFunction
+          &postChildrenCallbackFunc);
+
   virtual void printIR(llvm::Twine msg, mlir::Operation *op,
                        llvm::raw_ostream &out) override;
 
 public:
   using PMBuilder = std::function<llvm::Error(mlir::PassManager &)>;
 
+  /// Policies for the order in which the children of a target are submitted
+  /// for compilation.
+  enum class ChildOrderingPolicy {
+    /// Submit children in the order they were declared by their parent.
+    Declaration,
+    /// Submit the children with the highest cost first. The durations
+    /// recorded by previous compilations are used if available for all
+    /// siblings, otherwise the estimate of Target::estimateCompilationCost.
+    Cost,
+  };
+
   ThreadedCompilationManager(qssc::hal::TargetSystem &target,
                              mlir::MLIRContext *context, PMBuilder pmBuilder);
   virtual ~ThreadedCompilationManager() = default;
@@ -72,6 +109,31 @@ public:
                                      qssc::payload::Payload &payload,
                                      bool doCompileMLIR = true) override;
 
+  /// @brief Enable or disable the reuse of the pass managers built for each
+  /// target between compilations. Enabled by default. Pass managers are never
+  /// reused for compilations with timing enabled.
+  void enablePassManagerCache(bool enable = true);
+
+  /// @brief Set the key identifying the options the pass managers are built
+  /// with, i.e., everything that influences the pass manager builder. Pass
+  /// managers cached under a different key are not reused.
+  void setPipelineOptionsKey(std::string key);
+
+  /// @brief Discard all cached pass managers. Must be called if the passes a
+  /// target adds change without a change of the pipeline options key.
+  void invalidatePassManagerCache();
+
+  /// @brief Set the order in which the children of a target are submitted
+  /// for compilation. Defaults to ChildOrderingPolicy::Cost.
+  void setChildOrderingPolicy(ChildOrderingPolicy policy);
+
+  /// @brief Discard the target durations recorded by previous compilations.
+  void clearRecordedCosts();
+
+  /// @brief Enable or disable the dependency driven target scheduler.
+  /// Enabled by default. If disabled, targets are walked level by level.
+  void enableDependencyScheduling(bool enable = true);
+
   bool isMultithreadingEnabled() {
     return getContext()->isMultithreadingEnabled();
   }
@@ -80,8 +142,37 @@ public:
 private:
   // Used to store initialized and registered pass managers
   // with the context prior to compilation.
-  std::map<Target *, mlir::PassManager> targetPassManagers_;
-  // target pass manager map mutex
+  std::map<Target *, std::shared_ptr<mlir::PassManager>> targetPassManagers_;
+  // Pass managers retained between compilations, keyed by target and
+  // pipeline options key.
+  std::map<std::pair<Target *, std::string>, std::shared_ptr<mlir::PassManager>>
+      passManagerCache_;
+  // Key of the pipeline options the pass managers are currently built with.
+  std::string pipelineOptionsKey_;
+  // Whether pass managers are reused between compilations.
+  bool passManagerCacheEnabled_ = true;
+  // Whether targets are walked with the dependency driven scheduler.
+  bool dependencySchedulingEnabled_ = true;
+
+  // Order in which the children of a target are submitted.
+  ChildOrderingPolicy childOrderingPolicy_ = ChildOrderingPolicy::Cost;
+  // Duration in nanoseconds of each target's own stages in the most recent
+  // compilation.
+  std::unordered_map<Target *, uint64_t> recordedCosts_;
+  // recorded costs mutex
+  std::mutex recordedCostsMutex_;
+
+  /// Order the children of a target for submission following the child
+  /// ordering policy.
+  void
+  orderChildren_(std::vector<std::pair<Target *, mlir::ModuleOp>> &children);
+  /// Record the duration of one of the stages of a target. The first stage of
+  /// a compilation replaces the duration recorded by a previous compilation.
+  void recordCost_(Target *target, uint64_t nanoseconds, bool firstStage);
+  /// Get the duration recorded for a target and all of its descendants,
+  /// provided all of them have been recorded. Requires recordedCostsMutex_.
+  std::optional<uint64_t> getRecordedSubtreeCost_(Target *target);
+  // target pass manager map and cache mutex
   std::shared_mutex targetPassManagersMutex_;
 
   // ensures we register passes with the context
@@ -103,18 +194,21 @@ private:
   void registerPassManagerWithContext_(mlir::PassManager &pm);
   /// Thread safely get the passmanager for a target.
   mlir::PassManager &getTargetPassManager_(Target *target);
-  /// Thread safely set the passmanager for a target.
-  mlir::PassManager &createTargetPassManager_(Target *target);
+  /// Thread safely set the passmanager for a target, optionally retaining it
+  /// in the cache.
+  void setTargetPassManager_(Target *target,
+                             std::shared_ptr<mlir::PassManager> pm, bool cache);
+  /// Thread safely select the cached passmanager for a target if one exists.
+  bool lookupCachedPassManager_(Target *target);
 
   /// Compiles the input module for a single target.
   llvm::Error compileMLIRTarget_(Target &target, mlir::ModuleOp targetModuleOp,
                                  mlir::TimingScope &timing);
-  /// Compiles the input payload for a single target.
-  llvm::Error compilePayloadTarget_(Target &target,
-                                    mlir::ModuleOp targetModuleOp,
-                                    qssc::payload::Payload &payload,
-                                    mlir::TimingScope &timing,
-                                    bool doCompileMLIR);
+  /// Emits the compiled module of a single target to the payload.
+  llvm::Error emitToPayloadTarget_(Target &target,
+                                   mlir::ModuleOp targetModuleOp,
+                                   qssc::payload::Payload &payload,
+                                   mlir::TimingScope &timing);
 
   PMBuilder pmBuilder;
 
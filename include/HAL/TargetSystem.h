@@ -29,6 +29,7 @@
 #include "mlir/Pass/PassManager.h"
 #include "mlir/Pass/PassRegistry.h"
 
+#include <cstdint>
 #include <optional>
 #include <string>
 #include <vector>
@@ -130,6 +131,15 @@ public:
   /// @param payload The payload to populate for this target.
   virtual llvm::Error emitToPayloadPostChildren(mlir::ModuleOp targetModuleOp,
                                                 payload::Payload &payload);
+  /// @brief Estimate the cost of compiling this target and emitting it to the
+  /// payload. The TargetCompilationManager uses the estimate to start the
+  /// most expensive of sibling targets first, so only the relative order of
+  /// the estimates of siblings is significant. The default estimate is the
+  /// number of operations within the target's module.
+  /// @param targetModuleOp The target module before running the target's
+  /// passes.
+  /// @return The estimated cost.
+  virtual uint64_t estimateCompilationCost(mlir::ModuleOp targetModuleOp);
 
   virtual ~Target() = default;
 
@@ -51,6 +51,10 @@ public:
   llvm::Expected<qssc::hal::TargetSystem *>
   getTarget(mlir::MLIRContext *context) const;
 
+  /// Release the target system registered for the given context. Must be
+  /// called before destroying a context that a target was created for.
+  void releaseTarget(mlir::MLIRContext *context);
+
   /// Register this target's MLIR passes with the QSSC system.
   /// Should only be called once on initialization.
   llvm::Error registerTargetPasses() const;
@@ -23,10 +23,14 @@
 
 #include "Arguments/Arguments.h"
 #include "Payload/Payload.h"
+#include "Payload/PayloadBuffer.h"
 
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Error.h"
 
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <zip.h>
@@ -34,10 +38,15 @@
 namespace qssc::payload {
 class PatchableZipPayload : public PatchablePayload {
 public:
-  PatchableZipPayload(std::string path, bool enableInMemory)
-      : path(std::move(path)), zip(nullptr), enableInMemory(enableInMemory) {}
-  PatchableZipPayload(llvm::StringRef path, bool enableInMemory)
-      : path(path), zip(nullptr), enableInMemory(enableInMemory) {}
+  /// @brief Open the payload file at path, or if enableInMemory, the
+  /// payload held in path, which is taken over without copying
+  PatchableZipPayload(std::string path, bool enableInMemory);
+  /// @brief Open the payload file at path, or if enableInMemory, a copy of
+  /// the payload held in path
+  PatchableZipPayload(llvm::StringRef path, bool enableInMemory);
+  /// @brief Open the in memory payload held by buffer. A borrowed buffer is
+  /// copied when it is first patched.
+  explicit PatchableZipPayload(PayloadBuffer buffer);
 
   // deny copying and moving (no need for special handling of the resource
   // struct zip *)
@@ -49,6 +58,9 @@ public:
   ~PatchableZipPayload();
 
   llvm::Error writeBack() override;
+  /// @brief Append the payload to outputString. In memory payloads are moved
+  /// into an empty outputString without copying, after which this payload
+  /// is empty.
   llvm::Error writeString(std::string *outputString) override;
   void discardChanges();
 
@@ -57,6 +69,21 @@ public:
   llvm::Expected<ContentBuffer &>
   readMember(llvm::StringRef path, bool markForWriteBack = true) override;
 
+  /// @brief Patch a member in place when it is stored uncompressed,
+  /// updating its checksum. Payload files are patched through a memory
+  /// mapping and in memory payloads in their buffer. This costs
+  /// O(patch size) rather than O(payload size), and the change is applied
+  /// immediately, i.e., it is not undone by discardChanges(). Other members
+  /// and members that have been read for write back are patched through
+  /// readMember() and writeBack().
+  llvm::Error patchMember(llvm::StringRef path, uint64_t offset,
+                          llvm::ArrayRef<char> bytes) override;
+
+  /// @brief View a member stored uncompressed directly in the mapped payload
+  /// file or in the in memory payload. Other members and members that have
+  /// been read for write back are viewed through readMember().
+  llvm::Expected<llvm::StringRef> viewMember(llvm::StringRef path) override;
+
   struct zip *getBackingZip() {
     if (auto err = ensureOpen()) {
       llvm::errs() << err;
@@ -79,7 +106,18 @@ private:
 
   std::unordered_map<std::string, TrackedFile> files;
 
+  /// The payload bytes that are patched in place: the mapped payload file,
+  /// or the in memory payload
+  struct InPlaceArchive;
+  std::unique_ptr<InPlaceArchive> inPlace;
+  /// Set once mapping the payload file failed
+  bool mappingUnavailable = false;
+
   llvm::Error ensureOpen();
+  /// @brief Get the payload bytes and the index of their members for in
+  /// place patching. Returns nullptr if the payload cannot be patched in
+  /// place, e.g., as it uses zip64 extensions.
+  InPlaceArchive *getInPlaceArchive();
   llvm::Error addFileToZip(zip_t *zip, const std::string &path,
                            ContentBuffer &buf, zip_error_t &err);
 };
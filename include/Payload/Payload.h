@@ -23,16 +23,30 @@
 
 #include <Config/QSSConfig.h>
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <filesystem>
 #include <iostream>
+#include <memory>
 #include <mutex>
+#include <optional>
 #include <string>
 #include <unordered_map>
+#include <variant>
 #include <vector>
 
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/raw_os_ostream.h"
 #include "llvm/Support/raw_ostream.h"
 
+namespace llvm {
+class ThreadPool;
+} // namespace llvm
+
 namespace qssc::payload {
 
 struct PayloadConfig {
@@ -41,19 +55,101 @@ struct PayloadConfig {
   qssc::config::QSSVerbosity verbosity;
 };
 
+/// @brief The contents of a single payload file. Owns whichever buffer the
+/// producer handed over so that it can be written out without being copied.
+class PayloadFile {
+public:
+  PayloadFile() = default;
+  explicit PayloadFile(std::string contents) : storage(std::move(contents)) {}
+  explicit PayloadFile(std::unique_ptr<llvm::MemoryBuffer> contents)
+      : storage(std::move(contents)) {}
+  explicit PayloadFile(std::vector<char> contents)
+      : storage(std::move(contents)) {}
+
+  /// @brief View of the contents, valid until the file is next modified.
+  llvm::StringRef getBuffer() const;
+  size_t size() const { return getBuffer().size(); }
+  /// @brief Get the contents as a mutable string. Contents held in a memory
+  /// buffer or byte vector are copied into a string on the first call.
+  std::string &getString();
+
+private:
+  std::variant<std::string, std::unique_ptr<llvm::MemoryBuffer>,
+               std::vector<char>>
+      storage;
+}; // class PayloadFile
+
+/// @brief Concurrent map from paths to payload files. Paths are hashed onto a
+/// fixed number of shards, each guarded by its own mutex, so that targets
+/// emitting in parallel rarely contend with each other. Entries are never
+/// relocated, so references returned by getOrCreate remain valid until the
+/// file is removed. Iteration order is made deterministic by orderedNames.
+class PayloadFileStore {
+public:
+  /// @brief Get the file fName, creating an empty file if it does not exist
+  PayloadFile &getOrCreate(const std::filesystem::path &fName);
+  /// @brief Get the file fName or nullptr if it does not exist
+  PayloadFile *lookup(const std::filesystem::path &fName);
+  /// @brief Add or replace the file fName
+  void set(const std::filesystem::path &fName, PayloadFile contents);
+  /// @brief Remove the file fName and return its contents if it existed
+  std::optional<PayloadFile> take(const std::filesystem::path &fName);
+  /// @brief Get the names of all files in lexicographic order
+  std::vector<std::filesystem::path> orderedNames() const;
+  size_t size() const;
+
+private:
+  static constexpr size_t numShards = 64;
+
+  // A hash function object to work with unordered_* containers:
+  struct PathHash {
+    std::size_t operator()(std::filesystem::path const &p) const noexcept {
+      return std::filesystem::hash_value(p);
+    }
+  };
+
+  struct Shard {
+    mutable std::mutex mutex;
+    std::unordered_map<std::filesystem::path, PayloadFile, PathHash> files;
+  };
+
+  Shard &getShard(const std::filesystem::path &fName);
+
+  std::array<Shard, numShards> shards;
+}; // class PayloadFileStore
+
 // Payload class will wrap the QSS Payload and interface with the qss-compiler
 class Payload {
 public:
   using PluginConfiguration = PayloadConfig;
 
+  /// @brief Attributes the files created on the calling thread to a single
+  /// target emission. When the payload is streaming, committing the scope
+  /// writes those files to the output and releases their contents. Files
+  /// must not be modified after the emission that created them commits.
+  /// Scopes nest; only the innermost scope on a thread collects files.
+  class EmissionScope {
+  public:
+    explicit EmissionScope(Payload &payload);
+    EmissionScope(const EmissionScope &) = delete;
+    EmissionScope &operator=(const EmissionScope &) = delete;
+    ~EmissionScope();
+
+    /// @brief Stream the files created within this scope. A no-op when the
+    /// payload is not streaming.
+    llvm::Error commit();
+
+  private:
+    Payload &payload;
+    bool active = false;
+  };
+
 public:
   Payload()
       : prefix(""), name("exp"), verbosity(qssc::config::QSSVerbosity::Warn) {}
   explicit Payload(PayloadConfig config)
       : prefix(std::move(config.prefix) + "/"), name(std::move(config.name)),
-        verbosity(config.verbosity) {
-    files.clear();
-  }
+        verbosity(config.verbosity) {}
   virtual ~Payload() = default;
 
   // get/add the file fName and return a pointer to its data
@@ -68,28 +164,62 @@ public:
   virtual void writePlain(std::ostream &stream) = 0;
   virtual void writePlain(llvm::raw_ostream &stream) = 0;
   virtual void addFile(llvm::StringRef filename, llvm::StringRef str) = 0;
+  // add the file filename taking ownership of contents without copying
+  void addFile(llvm::StringRef filename, std::string &&contents);
+  void addFile(llvm::StringRef filename,
+               std::unique_ptr<llvm::MemoryBuffer> contents);
+  void addFile(llvm::StringRef filename, std::vector<char> &&contents);
+  // disambiguates string literals between the copying and moving overloads
+  void addFile(llvm::StringRef filename, const char *str) {
+    addFile(filename, llvm::StringRef(str));
+  }
+
+  /// @brief Whether files may be streamed to the output with beginStreaming
+  virtual bool supportsStreaming() const { return false; }
+  /// @brief Start streaming files to stream as their emission scopes commit.
+  /// Must be called before any target emits to the payload, and stream must
+  /// remain valid until finishStreaming returns.
+  virtual llvm::Error beginStreaming(llvm::raw_ostream &stream);
+  /// @brief Write all files that have not been streamed yet and complete the
+  /// output. Replaces write() for a streaming payload.
+  virtual llvm::Error finishStreaming();
+  bool isStreaming() const { return streaming; }
+
+  /// @brief Configure per-file compression from a payload specific
+  /// specification. Payloads that do not compress reject any non-empty
+  /// specification.
+  virtual llvm::Error setCompression(llvm::StringRef spec);
+  /// @brief Set the thread pool to use for parallel work while writing. The
+  /// payload writes sequentially when no pool is set.
+  void setThreadPool(llvm::ThreadPool *pool) { threadPool = pool; }
 
   const std::string &getName() const { return name; }
   const std::string &getPrefix() const { return prefix; }
 
 protected:
-  // Class mutex
-  std::mutex _mtx;
-
   // return an ordered list of filenames
   auto orderedFileNames() -> std::vector<std::filesystem::path>;
 
-  // A hash function object to work with unordered_* containers:
-  struct PathHash {
-    std::size_t operator()(std::filesystem::path const &p) const noexcept {
-      return std::filesystem::hash_value(p);
-    }
-  };
+  /// @brief Record that fName was created or replaced by the calling thread
+  /// so that the enclosing EmissionScope streams it.
+  void noteFileCreated(const std::filesystem::path &fName);
+  /// @brief Remove the listed files from the payload and stream them.
+  llvm::Error streamFiles(llvm::ArrayRef<std::filesystem::path> fNames);
+  /// @brief Write a single completed file to the streaming output. The
+  /// contents are released once this returns.
+  virtual llvm::Error streamFile(const std::filesystem::path &fName,
+                                 const PayloadFile &contents);
+  /// @brief Add or replace the file fName, taking ownership of contents
+  void setFile(const std::filesystem::path &fName, PayloadFile contents);
 
   std::string prefix;
   std::string name;
   qssc::config::QSSVerbosity verbosity;
-  std::unordered_map<std::filesystem::path, std::string, PathHash> files;
+  PayloadFileStore files;
+  /// @brief Set between beginStreaming and finishStreaming
+  bool streaming = false;
+  /// @brief Thread pool for parallel work while writing, may be null
+  llvm::ThreadPool *threadPool = nullptr;
 }; // class Payload
 
 // PatchablePayload for payloads that support patching after compilation
@@ -101,6 +231,20 @@ public:
   readMember(llvm::StringRef path, bool markForWriteBack = true) = 0;
   virtual llvm::Error writeBack() = 0;
   virtual llvm::Error writeString(std::string *outputString) = 0;
+
+  /// @brief Overwrite bytes of the member path starting at offset. The
+  /// default implementation patches the buffer returned by readMember, so
+  /// the change is written by writeBack. Payloads that can patch their
+  /// storage directly override this to avoid reading the whole member.
+  virtual llvm::Error patchMember(llvm::StringRef path, uint64_t offset,
+                                  llvm::ArrayRef<char> bytes);
+
+  /// @brief Read-only view of the contents of member path, valid until any
+  /// member is patched or the payload is written back. The default
+  /// implementation views the buffer returned by readMember. Payloads that
+  /// can view their storage directly override this to avoid copying the
+  /// member.
+  virtual llvm::Expected<llvm::StringRef> viewMember(llvm::StringRef path);
 }; // class PatchablePayload
 
 } // namespace qssc::payload
@@ -0,0 +1,96 @@
+//===- PayloadBuffer.h ------------------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+//
+// Declares the PayloadBuffer class, which holds the bytes of a compiled
+// payload while it is opened, patched and emitted.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef PAYLOAD_PAYLOADBUFFER_H
+#define PAYLOAD_PAYLOADBUFFER_H
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/FileSystem.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <variant>
+
+namespace qssc::payload {
+
+/// @brief The bytes of a payload, carried from opening through patching to
+/// output with at most one copy. A buffer either borrows memory owned by the
+/// caller, owns a string, or maps a file. Borrowed buffers are copied the
+/// first time they are written to.
+///
+/// All copies of payload bytes made through buffers are counted, see
+/// getBytesCopied().
+class PayloadBuffer {
+public:
+  /// @brief Borrow data, which must outlive the buffer and is not modified
+  static PayloadBuffer borrow(llvm::StringRef data);
+  /// @brief Take ownership of data without copying it
+  static PayloadBuffer adopt(std::string data);
+  /// @brief Own a copy of data
+  static PayloadBuffer copy(llvm::StringRef data);
+  /// @brief Map the file at path. Writes to a writable mapping change the
+  /// file.
+  static llvm::Expected<PayloadBuffer> mapFile(llvm::StringRef path,
+                                               bool writable);
+
+  /// @brief Copy the file at from to to
+  static llvm::Error copyFile(llvm::StringRef from, llvm::StringRef to);
+
+  llvm::StringRef getData() const;
+  size_t size() const { return getData().size(); }
+
+  /// @brief Get a writable view of the contents, copying borrowed contents
+  /// and read only mappings first
+  llvm::MutableArrayRef<char> getMutableData();
+
+  /// @brief Release the contents as a string. Only copies if the buffer does
+  /// not own a string.
+  std::string takeString();
+
+  /// @brief Write the contents to the file at path
+  llvm::Error writeToFile(llvm::StringRef path) const;
+
+  /// @brief Number of payload bytes copied by buffers in this process
+  static uint64_t getBytesCopied();
+  static void resetBytesCopied();
+
+private:
+  struct Mapping {
+    llvm::sys::fs::mapped_file_region region;
+    bool writable;
+  };
+
+  using Storage =
+      std::variant<llvm::StringRef, std::string, std::unique_ptr<Mapping>>;
+
+  explicit PayloadBuffer(Storage storage) : storage(std::move(storage)) {}
+
+  static void noteBytesCopied(uint64_t numBytes);
+
+  Storage storage;
+}; // class PayloadBuffer
+
+} // namespace qssc::payload
+
+#endif // PAYLOAD_PAYLOADBUFFER_H
@@ -0,0 +1,167 @@
+//===- PayloadOverlay.h -----------------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+//
+// Declares payload overlays, which record the bytes that binding arguments
+// changes in a shared base payload instead of copying the whole payload.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef PAYLOAD_PAYLOADOVERLAY_H
+#define PAYLOAD_PAYLOADOVERLAY_H
+
+#include "Payload/Payload.h"
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/STLFunctionalExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace qssc::payload {
+
+/// @brief Changes to the members of a base payload, recorded as
+/// (member, offset, bytes) patches together with a hash of the base payload
+/// they apply to. Patches are applied in order, so later patches win where
+/// they overlap.
+///
+/// The serialized format (version 1) is little endian:
+///   "QSSC_OVL", u32 version, u32 number of patches, u64 base hash
+///   per patch: u32 member name size, u32 patch size, u64 offset,
+///   member name, patch bytes
+class PayloadOverlay {
+public:
+  static constexpr uint32_t version = 1;
+
+  struct Patch {
+    std::string member;
+    uint64_t offset;
+    std::vector<char> bytes;
+  };
+
+  explicit PayloadOverlay(uint64_t baseHash) : baseHash(baseHash) {}
+
+  /// @brief Hash of the serialized base payload that overlays are checked
+  /// against
+  static uint64_t hashBase(llvm::StringRef base);
+  uint64_t getBaseHash() const { return baseHash; }
+  /// @brief Fail unless base is the payload this overlay applies to
+  llvm::Error verifyBase(llvm::StringRef base) const;
+
+  void addPatch(llvm::StringRef member, uint64_t offset,
+                llvm::ArrayRef<char> bytes);
+  llvm::ArrayRef<Patch> getPatches() const { return patches; }
+  bool empty() const { return patches.empty(); }
+
+  /// @brief Apply all patches to payload through
+  /// PatchablePayload::patchMember, e.g., to materialize a bound payload
+  /// from a copy of the base payload
+  llvm::Error apply(PatchablePayload &payload) const;
+
+  std::string serialize() const;
+  static bool isOverlay(llvm::StringRef buffer);
+  static llvm::Expected<PayloadOverlay> deserialize(llvm::StringRef buffer);
+
+private:
+  uint64_t baseHash;
+  std::vector<Patch> patches;
+}; // class PayloadOverlay
+
+/// @brief Read only view of a base payload with an overlay applied. Members
+/// are read from the base payload, and the patches of a member are applied
+/// to a copy of it when it is first read, so members without patches are
+/// never copied.
+class OverlayPayload : public PatchablePayload {
+public:
+  /// @param base The payload the overlay applies to, which must outlive
+  /// this view and is not modified
+  OverlayPayload(PatchablePayload &base, PayloadOverlay overlay);
+
+  /// @brief Read a member with its patches applied. Members are not written
+  /// back, i.e., markForWriteBack is ignored.
+  llvm::Expected<ContentBuffer &>
+  readMember(llvm::StringRef path, bool markForWriteBack = true) override;
+  /// @brief Fails as the base payload is shared. Use PayloadOverlay::apply
+  /// on a copy of the base payload instead.
+  llvm::Error writeBack() override;
+  /// @brief Fails as the base payload is shared. Use PayloadOverlay::apply
+  /// on a copy of the base payload instead.
+  llvm::Error writeString(std::string *outputString) override;
+
+  const PayloadOverlay &getOverlay() const { return overlay; }
+
+private:
+  PatchablePayload &base;
+  PayloadOverlay overlay;
+  /// Indices of the patches of each member
+  llvm::StringMap<llvm::SmallVector<size_t>> patchesByMember;
+  /// Patched copies of the members that have been read
+  llvm::StringMap<ContentBuffer> patchedMembers;
+}; // class OverlayPayload
+
+/// @brief Payload that records the changes made to a shared base payload as
+/// an overlay instead of applying them. Patches through patchMember are
+/// recorded as they are; members changed through readMember are copied and
+/// compared against the base payload on writeBack.
+class OverlayRecordingPayload : public PatchablePayload {
+public:
+  /// @param base The payload changes are recorded against, which must
+  /// outlive this payload and is not modified
+  /// @param baseMutex If not null, held while reading from base so that
+  /// several recording payloads can share it across threads
+  OverlayRecordingPayload(PatchablePayload &base, uint64_t baseHash,
+                          std::mutex *baseMutex = nullptr);
+
+  llvm::Expected<ContentBuffer &>
+  readMember(llvm::StringRef path, bool markForWriteBack = true) override;
+  /// @brief Record the changes to the members read for write back
+  llvm::Error writeBack() override;
+  /// @brief Append the serialized overlay to outputString
+  llvm::Error writeString(std::string *outputString) override;
+  /// @brief Record a patch without reading the member unless it has been
+  /// read already. Patches are checked against the member size when the
+  /// overlay is applied.
+  llvm::Error patchMember(llvm::StringRef path, uint64_t offset,
+                          llvm::ArrayRef<char> bytes) override;
+
+  const PayloadOverlay &getOverlay() const { return overlay; }
+
+private:
+  struct TrackedMember {
+    ContentBuffer buf;
+    bool writeBack;
+  };
+
+  /// @brief Call fn with the member path of the base payload, holding
+  /// baseMutex if any
+  llvm::Error
+  withBaseMember(llvm::StringRef path,
+                 llvm::function_ref<void(const ContentBuffer &)> fn);
+
+  PatchablePayload &base;
+  std::mutex *baseMutex;
+  PayloadOverlay overlay;
+  llvm::StringMap<TrackedMember> members;
+}; // class OverlayRecordingPayload
+
+} // namespace qssc::payload
+
+#endif // PAYLOAD_PAYLOADOVERLAY_H
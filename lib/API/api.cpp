@@ -18,6 +18,7 @@
 
 #include "API/errors.h"
 #include "Arguments/Arguments.h"
+#include "Arguments/ColumnarArguments.h"
 #include "Config/CLIConfig.h"
 #include "Config/QSSConfig.h"
 #include "Dialect/OQ3/Transforms/Passes.h"
@@ -38,6 +39,8 @@
 #include "Plugin/PluginInfo.h"
 #include "QSSC.h"
 
+#include "mlir/Bytecode/BytecodeReader.h"
+#include "mlir/Bytecode/BytecodeWriter.h"
 #include "mlir/Conversion/Passes.h"
 #include "mlir/IR/AsmState.h"
 #include "mlir/IR/BuiltinOps.h"
@@ -59,24 +62,31 @@
 #include "mlir/Target/LLVMIR/Dialect/LLVMIR/LLVMToLLVMIRTranslation.h"
 #include "mlir/Tools/ParseUtilities.h"
 
+#include "llvm/ADT/ScopeExit.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Chrono.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/ToolOutputFile.h"
 #include "llvm/Support/raw_ostream.h"
 
+#include <cstdint>
 #include <filesystem>
-#include <fstream>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <optional>
-#include <sstream>
 #include <string>
 #include <string_view>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 using namespace mlir;
 using namespace qssc::config;
@@ -143,6 +153,17 @@ void showPayloads_() {
   }
 }
 
+/// @brief Lookup the registry entry of the target selected by the config.
+/// @param config The configuration selecting the target.
+/// @return The selected target's info, or the null target's if none is set.
+qssc::hal::registry::TargetSystemInfo &
+getTargetInfo_(const qssc::config::QSSConfig &config) {
+  return *qssc::hal::registry::TargetSystemRegistry::lookupPluginInfo(
+              config.getTargetName().value_or(""))
+              .value_or(qssc::hal::registry::TargetSystemRegistry::
+                            nullTargetSystemInfo());
+}
+
 /// @brief Build the target for this MLIRContext based on the supplied config.
 /// @param context The supplied context to build the target for.
 /// @param config The configuration defining the context to build.
@@ -168,11 +189,7 @@ buildTarget_(MLIRContext *context, const qssc::config::QSSConfig &config,
           llvm::inconvertibleErrorCode(),
           "Error: A target configuration path was not specified.");
   }
-  qssc::hal::registry::TargetSystemInfo &targetInfo =
-      *qssc::hal::registry::TargetSystemRegistry::lookupPluginInfo(
-           targetName.value_or(""))
-           .value_or(qssc::hal::registry::TargetSystemRegistry::
-                         nullTargetSystemInfo());
+  qssc::hal::registry::TargetSystemInfo &targetInfo = getTargetInfo_(config);
 
   std::optional<llvm::StringRef> conf{};
   if (targetConfigPath.has_value())
@@ -201,6 +218,20 @@ llvm::Error generateQEM_(
     std::unique_ptr<qssc::payload::Payload> payload, mlir::ModuleOp moduleOp,
     llvm::raw_ostream *ostream, mlir::TimingScope &timing) {
 
+  // Streaming writes each target's files as soon as it has emitted them so
+  // the whole payload is never held in memory at once.
+  const bool streamPayload = config.shouldStreamPayload() &&
+                             !config.shouldEmitPlaintextPayload() &&
+                             payload->supportsStreaming();
+  if (streamPayload)
+    if (auto err = payload->beginStreaming(*ostream))
+      return err;
+
+  // Members may be compressed in parallel when the payload is written
+  auto *context = moduleOp->getContext();
+  if (context->isMultithreadingEnabled())
+    payload->setThreadPool(&context->getThreadPool());
+
   mlir::TimingScope buildQEMTiming = timing.nest("build-qem");
   targetCompilationManager->enableTiming(buildQEMTiming);
   if (auto err = targetCompilationManager->compilePayload(
@@ -211,6 +242,8 @@ llvm::Error generateQEM_(
 
   mlir::TimingScope const writePayloadTiming =
       buildQEMTiming.nest("write-payload");
+  if (streamPayload)
+    return payload->finishStreaming();
   if (config.shouldEmitPlaintextPayload())
     payload->writePlain(*ostream);
   else
@@ -219,18 +252,33 @@ llvm::Error generateQEM_(
   return llvm::Error::success();
 }
 
-/// @brief Print the output to an ostream.
+/// @brief Print the output to an ostream, as bytecode if the configuration
+/// asks for it and as text otherwise.
 /// @param ostream The ostream to populate.
 /// @param moduleOp The ModuleOp to dump.
-void dumpMLIR_(llvm::raw_ostream *ostream, mlir::ModuleOp moduleOp) {
-  moduleOp.print(*ostream);
-  *ostream << '\n';
+/// @param config Compilation configuration options
+llvm::Error dumpMLIR_(llvm::raw_ostream *ostream, mlir::ModuleOp moduleOp,
+                      const QSSConfig &config) {
+  if (!config.shouldEmitBytecode()) {
+    moduleOp.print(*ostream);
+    *ostream << '\n';
+    return llvm::Error::success();
+  }
+
+  mlir::BytecodeWriterConfig writerConfig;
+  if (auto version = config.bytecodeVersionToEmit())
+    writerConfig.setDesiredBytecodeVersion(*version);
+  if (mlir::failed(mlir::writeBytecodeToFile(moduleOp, *ostream, writerConfig)))
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "Failed to emit MLIR bytecode");
+  return llvm::Error::success();
 }
 
 using ErrorHandler = function_ref<LogicalResult(const Twine &)>;
 
-llvm::Error buildPassManager_(mlir::PassManager &pm, bool verifyPasses) {
-  if (mlir::failed(mlir::applyPassManagerCLOptions(pm)))
+llvm::Error buildPassManager_(mlir::PassManager &pm, bool verifyPasses,
+                              bool applyCLOptions) {
+  if (applyCLOptions && mlir::failed(mlir::applyPassManagerCLOptions(pm)))
     return llvm::createStringError(
         llvm::inconvertibleErrorCode(),
         "Unable to apply pass manager command line options");
@@ -243,8 +291,8 @@ llvm::Error buildPassManager_(mlir::PassManager &pm, bool verifyPasses) {
 
 llvm::Error buildPassManager(const QSSConfig &config, mlir::PassManager &pm,
                              ErrorHandler errorHandler, bool verifyPasses,
-                             mlir::TimingScope &timing) {
-  if (auto err = buildPassManager_(pm, verifyPasses))
+                             bool applyCLOptions, mlir::TimingScope &timing) {
+  if (auto err = buildPassManager_(pm, verifyPasses, applyCLOptions))
     return err;
 
   pm.enableTiming(timing);
@@ -286,9 +334,7 @@ llvm::Error emitMLIR_(
   }
 
   // Print the output.
-  dumpMLIR_(ostream, moduleOp);
-
-  return llvm::Error::success();
+  return dumpMLIR_(ostream, moduleOp, config);
 }
 
 /// @brief Emit a QEM payload from the compiler
@@ -303,28 +349,42 @@ llvm::Error emitQEM_(
     qssc::hal::compile::ThreadedCompilationManager &targetCompilationManager,
     mlir::TimingScope &timing) {
   if (config.shouldIncludeSource()) {
+    // MLIR inputs are copied as they are, so bytecode inputs are kept as
+    // bytecode under their own extension
     if (config.isDirectInput()) {
+      llvm::MemoryBufferRef const input(config.getInputSource(), "direct");
       if (config.getInputType() == InputType::QASM)
         payload->addFile("manifest/input.qasm",
                          (config.getInputSource() + "\n").str());
+      else if (config.getInputType() == InputType::MLIR &&
+               mlir::isBytecode(input))
+        payload->addFile("manifest/input.mlirbc", config.getInputSource());
       else if (config.getInputType() == InputType::MLIR)
         payload->addFile("manifest/input.mlir",
                          (config.getInputSource() + "\n").str());
       else
         llvm_unreachable("Unhandled input file type");
     } else { // just copy the input file
-      std::ifstream fileStream(config.getInputSource().str());
-      std::stringstream fileSS;
-      fileSS << fileStream.rdbuf();
+      // the file is mapped rather than read into a string where possible and
+      // the buffer is handed over to the payload without copying
+      auto input = llvm::MemoryBuffer::getFile(
+          config.getInputSource(), /*IsText=*/false,
+          /*RequiresNullTerminator=*/false);
+      if (!input)
+        return llvm::createStringError(input.getError(),
+                                       "Failed to read input file " +
+                                           config.getInputSource() +
+                                           " for the payload manifest");
 
       if (config.getInputType() == InputType::QASM)
-        payload->addFile("manifest/input.qasm", fileSS.str());
+        payload->addFile("manifest/input.qasm", std::move(input.get()));
       else if (config.getInputType() == InputType::MLIR)
-        payload->addFile("manifest/input.mlir", fileSS.str());
+        payload->addFile(mlir::isBytecode(input.get()->getMemBufferRef())
+                             ? "manifest/input.mlirbc"
+                             : "manifest/input.mlir",
+                         std::move(input.get()));
       else
         llvm_unreachable("Unhandled input file type");
-
-      fileStream.close();
     }
   }
 
@@ -387,20 +447,38 @@ void diagEngineHandler(mlir::Diagnostic &diagnostic,
   return;
 }
 
-llvm::Error compile_(int argc, char const **argv, std::string *outputString,
-                     std::optional<qssc::DiagnosticCallback> diagnosticCb) {
+/// @brief Register the standard passes with MLIR exactly once per process.
+///
+///        Pass pipelines may only be registered a single time, tools which
+///        compile repeatedly in-process must go through this function.
+llvm::Error registerPassesOnce_() {
+  static std::once_flag registerPassesFlag;
+  static std::string registerPassesError;
+  std::call_once(registerPassesFlag, [] {
+    if (auto err = qssc::dialect::registerPasses())
+      registerPassesError = llvm::toString(std::move(err));
+  });
 
-  // Initialize LLVM to start.
-  llvm::InitLLVM const y(argc, argv);
+  if (!registerPassesError.empty())
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   registerPassesError);
+  return llvm::Error::success();
+}
 
+/// @brief Register all command line options and parse argv into them.
+/// @param argc the number of argument strings
+/// @param argv array of argument strings
+/// @param registry The registry to populate with the standard dialects. Must
+/// outlive the parsed options.
+llvm::Error parseCLOptions_(int argc, char const **argv,
+                            mlir::DialectRegistry &registry) {
   // Register the standard passes with MLIR.
   // Must precede the command line parsing.
-  if (auto err = qssc::dialect::registerPasses())
+  if (auto err = registerPassesOnce_())
     return err;
 
   // Register the standard dialects with MLIR and prepare a registry and pass
   // pipeline
-  mlir::DialectRegistry registry;
   qssc::dialect::registerDialects(registry);
 
   // Register all extensions
@@ -410,26 +488,18 @@ llvm::Error compile_(int argc, char const **argv, std::string *outputString,
   // Register CL config builder prior to parsing
   CLIConfigBuilder::registerCLOptions(registry);
   llvm::cl::SetVersionPrinter(&printVersion);
+  // Options retain their values from any previous parse within this process.
+  llvm::cl::ResetAllOptionOccurrences();
   llvm::cl::ParseCommandLineOptions(
       argc, argv, "Quantum System Software (QSS) Backend Compiler\n");
 
-  DefaultTimingManager tm;
-  applyDefaultTimingManagerCLOptions(tm);
-  TimingScope timing = tm.getRootScope();
-
-  // The MLIR context for this compilation event.
-  // Instantiate after parsing command line options.
-  MLIRContext context{};
-
-  mlir::TimingScope buildConfigTiming = timing.nest("build-config");
-  auto configResult = qssc::config::buildToolConfig();
-  if (auto err = configResult.takeError())
-    return err;
-  qssc::config::QSSConfig const config = configResult.get();
-  qssc::config::setContextConfig(&context, config);
-  buildConfigTiming.stop();
+  return llvm::Error::success();
+}
 
-  // Populate the context
+/// @brief Populate an MLIRContext for compilation with the given config.
+void prepareContext_(mlir::MLIRContext &context,
+                     const mlir::DialectRegistry &registry,
+                     const QSSConfig &config) {
   context.appendDialectRegistry(registry);
   context.allowUnregisteredDialects(config.shouldAllowUnregisteredDialects());
   context.printOpOnDiagnostic(!config.shouldVerifyDiagnostics());
@@ -438,32 +508,88 @@ llvm::Error compile_(int argc, char const **argv, std::string *outputString,
   // LLVM IR
   mlir::registerBuiltinDialectTranslation(context);
   mlir::registerLLVMDialectTranslation(context);
+}
 
+/// @brief Handle the informational --show-* options.
+/// @return true if one of the options was handled and compilation should stop.
+bool handleShowOptions_(const mlir::DialectRegistry &registry,
+                        const QSSConfig &config) {
   if (config.shouldShowDialects()) {
     showDialects_(registry);
-    return llvm::Error::success();
+    return true;
   }
 
   if (config.shouldShowTargets()) {
     showTargets_();
-    return llvm::Error::success();
+    return true;
   }
 
   if (config.shouldShowPayloads()) {
     showPayloads_();
-    return llvm::Error::success();
+    return true;
   }
 
   if (config.shouldShowConfig()) {
     config.emit(llvm::outs());
-    return llvm::Error::success();
+    return true;
   }
 
-  // Build the target for compilation
-  auto targetResult = buildTarget_(&context, config, timing);
-  if (auto err = targetResult.takeError())
-    return err;
-  auto &target = targetResult.get();
+  return false;
+}
+
+/// @brief Build the target compilation manager for a context and its target.
+/// @param applyCLOptions Whether to apply the command line options to the
+/// manager and the pass managers it builds.
+llvm::Expected<std::unique_ptr<qssc::hal::compile::ThreadedCompilationManager>>
+buildTargetCompilationManager_(mlir::MLIRContext &context,
+                               qssc::hal::TargetSystem &target,
+                               const QSSConfig &config, bool applyCLOptions) {
+  bool const verifyPasses = config.shouldVerifyPasses();
+
+  auto targetCompilationManager =
+      std::make_unique<qssc::hal::compile::ThreadedCompilationManager>(
+          target, &context,
+          [verifyPasses, applyCLOptions](mlir::PassManager &pm) -> llvm::Error {
+            if (auto err = buildPassManager_(pm, verifyPasses, applyCLOptions))
+              return err;
+            return llvm::Error::success();
+          });
+  // Pass managers built by the builder above are only reused for the same
+  // builder options.
+  targetCompilationManager->setPipelineOptionsKey(
+      (llvm::Twine("verify-each=") + llvm::Twine(verifyPasses) +
+       ",cl-options=" + llvm::Twine(applyCLOptions))
+          .str());
+  if (applyCLOptions &&
+      mlir::failed(qssc::hal::compile::applyTargetCompilationManagerCLOptions(
+          *targetCompilationManager)))
+    return llvm::createStringError(
+        llvm::inconvertibleErrorCode(),
+        "Unable to apply target compilation options.");
+
+  return targetCompilationManager;
+}
+
+/// @brief Compile a single input with an already prepared context and target.
+///
+///        This holds all of the per-job state of a compilation, the input
+///        buffer, the module, the payload and the output. Everything else may
+///        be shared between compilations.
+/// @param context The prepared MLIR context to compile within
+/// @param config Compilation configuration options for this job
+/// @param targetCompilationManager The target's compilation scheduler
+/// @param outputString an optional buffer for the compilation result
+/// @param diagnosticCb an optional callback that will receive emitted
+/// diagnostics
+/// @param applyCLOptions Whether to apply the command line options to the
+/// pass managers
+/// @param timing The timing scope of this job
+llvm::Error compileModule_(
+    mlir::MLIRContext &context, const QSSConfig &config,
+    qssc::hal::compile::ThreadedCompilationManager &targetCompilationManager,
+    std::string *outputString,
+    const std::optional<qssc::DiagnosticCallback> &diagnosticCb,
+    bool applyCLOptions, mlir::TimingScope &timing) {
 
   // Set up the input, which is loaded from a file by name by default. With the
   // "--direct" option, the input program can be provided as a string to stdin.
@@ -481,10 +607,6 @@ llvm::Error compile_(int argc, char const **argv, std::string *outputString,
                                             /*bufferName=*/"direct");
   }
 
-  context.getDiagEngine().registerHandler([&](mlir::Diagnostic &diagnostic) {
-    diagEngineHandler(diagnostic, diagnosticCb);
-  });
-
   // Set up the output.
   llvm::raw_ostream *ostream;
   std::optional<llvm::raw_string_ostream> outStringStream;
@@ -519,6 +641,8 @@ llvm::Error compile_(int argc, char const **argv, std::string *outputString,
       payload = std::move(
           payloadInfo.value()->createPluginInstance(payloadConfig).get());
     }
+    if (auto err = payload->setCompression(config.getPayloadCompression()))
+      return err;
   }
 
   if (outputString) {
@@ -533,14 +657,16 @@ llvm::Error compile_(int argc, char const **argv, std::string *outputString,
     ostream = &outputFile->os();
   }
 
-  mlir::ModuleOp moduleOp;
+  // The module is owned by this job and is released from the context once
+  // the job completes.
+  mlir::OwningOpRef<mlir::ModuleOp> module;
 
   if (config.getInputType() == InputType::QASM) {
 
     mlir::TimingScope loadQASM3Timing = timing.nest("load-qasm3");
 
     if (config.getEmitAction() >= EmitAction::MLIR) {
-      moduleOp = mlir::ModuleOp::create(FileLineColLoc::get(
+      module = mlir::ModuleOp::create(FileLineColLoc::get(
           &context,
           config.isDirectInput() ? std::string{"-"} : config.getInputSource(),
           0, 0));
@@ -550,8 +676,8 @@ llvm::Error compile_(int argc, char const **argv, std::string *outputString,
             config.getInputSource().str(), !config.isDirectInput(),
             config.getEmitAction() == EmitAction::AST,
             config.getEmitAction() == EmitAction::ASTPretty,
-            config.getEmitAction() >= EmitAction::MLIR, moduleOp, diagnosticCb,
-            loadQASM3Timing))
+            config.getEmitAction() >= EmitAction::MLIR, module.get(),
+            diagnosticCb, loadQASM3Timing))
       return frontendError;
 
     if (config.getEmitAction() < EmitAction::MLIR)
@@ -608,9 +734,11 @@ llvm::Error compile_(int argc, char const **argv, std::string *outputString,
 
     context.enableMultithreading(wasThreadingEnabled);
 
-    moduleOp = mlir::dyn_cast<mlir::ModuleOp>(op.release());
+    module = mlir::dyn_cast<mlir::ModuleOp>(op.release());
   } // if input == MLIR
 
+  mlir::ModuleOp const moduleOp = module.get();
+
   auto errorHandler = [&](const Twine &msg) {
     // format msg to python handler as a compilation failure
     (void)qssc::emitDiagnostic(diagnosticCb, qssc::Severity::Error,
@@ -623,27 +751,13 @@ llvm::Error compile_(int argc, char const **argv, std::string *outputString,
   // at this point we have QUIR+Pulse in the moduleOp from either the
   // QASM/AST or MLIR file
 
-  bool verifyPasses = config.shouldVerifyPasses();
-
-  auto targetCompilationManager =
-      qssc::hal::compile::ThreadedCompilationManager(
-          target, &context, [&](mlir::PassManager &pm) -> llvm::Error {
-            if (auto err = buildPassManager_(pm, verifyPasses))
-              return err;
-            return llvm::Error::success();
-          });
-  if (mlir::failed(qssc::hal::compile::applyTargetCompilationManagerCLOptions(
-          targetCompilationManager)))
-    return llvm::createStringError(
-        llvm::inconvertibleErrorCode(),
-        "Unable to apply target compilation options.");
-
   // Run additional passes specified on the command line
 
   mlir::TimingScope commandLinePassesTiming =
       timing.nest("command-line-passes");
   mlir::PassManager pm(&context);
-  if (auto err = buildPassManager(config, pm, errorHandler, verifyPasses,
+  if (auto err = buildPassManager(config, pm, errorHandler,
+                                  config.shouldVerifyPasses(), applyCLOptions,
                                   commandLinePassesTiming))
     return err;
 
@@ -678,8 +792,269 @@ llvm::Error compile_(int argc, char const **argv, std::string *outputString,
 
   return llvm::Error::success();
 }
+
+llvm::Error compile_(int argc, char const **argv, std::string *outputString,
+                     std::optional<qssc::DiagnosticCallback> diagnosticCb) {
+
+  // Initialize LLVM to start.
+  llvm::InitLLVM const y(argc, argv);
+
+  mlir::DialectRegistry registry;
+  if (auto err = parseCLOptions_(argc, argv, registry))
+    return err;
+
+  DefaultTimingManager tm;
+  applyDefaultTimingManagerCLOptions(tm);
+  TimingScope timing = tm.getRootScope();
+
+  // The MLIR context for this compilation event.
+  // Instantiate after parsing command line options.
+  MLIRContext context{};
+
+  mlir::TimingScope buildConfigTiming = timing.nest("build-config");
+  auto configResult = qssc::config::buildToolConfig();
+  if (auto err = configResult.takeError())
+    return err;
+  qssc::config::QSSConfig const config = configResult.get();
+  qssc::config::setContextConfig(&context, config);
+  buildConfigTiming.stop();
+  // The configuration must be released before its context is destroyed.
+  auto releaseConfig = llvm::make_scope_exit(
+      [&]() { qssc::config::releaseContextConfig(&context); });
+
+  // Populate the context
+  prepareContext_(context, registry, config);
+
+  if (handleShowOptions_(registry, config))
+    return llvm::Error::success();
+
+  // Build the target for compilation
+  auto targetResult = buildTarget_(&context, config, timing);
+  if (auto err = targetResult.takeError())
+    return err;
+  auto &target = targetResult.get();
+
+  context.getDiagEngine().registerHandler([&](mlir::Diagnostic &diagnostic) {
+    diagEngineHandler(diagnostic, diagnosticCb);
+  });
+
+  auto targetCompilationManager =
+      buildTargetCompilationManager_(context, target, config,
+                                     /*applyCLOptions=*/true);
+  if (auto err = targetCompilationManager.takeError())
+    return err;
+
+  return compileModule_(context, config, **targetCompilationManager,
+                        outputString, diagnosticCb, /*applyCLOptions=*/true,
+                        timing);
+}
+
+/// @brief Compile the input with a typed configuration, leaving the command
+/// line options untouched.
+llvm::Error compileWithConfig_(
+    const QSSConfig &inputConfig, std::string_view input,
+    std::string *outputString,
+    const std::optional<qssc::DiagnosticCallback> &diagnosticCb) {
+  if (!outputString)
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "An output buffer must be provided.");
+
+  // Passes are registered once for the process. Nothing else below touches
+  // the command line options so that compilations may run concurrently.
+  if (auto err = registerPassesOnce_())
+    return err;
+
+  QSSConfig config = inputConfig;
+  config.setInputSource(std::string(input)).directInput(true);
+  if (config.getInputType() == InputType::None)
+    return llvm::createStringError(
+        llvm::inconvertibleErrorCode(),
+        "The input source format must be specified for direct input.");
+  if (config.getEmitAction() == EmitAction::None)
+    config.setEmitAction(EmitAction::MLIR);
+
+  mlir::DialectRegistry registry;
+  qssc::dialect::registerDialects(registry);
+  mlir::registerAllExtensions(registry);
+
+  // Timing is not reported for typed compilations.
+  DefaultTimingManager tm;
+  TimingScope timing = tm.getRootScope();
+
+  MLIRContext context{};
+  qssc::config::setContextConfig(&context, config);
+  // The configuration must be released before its context is destroyed.
+  auto releaseConfig = llvm::make_scope_exit(
+      [&]() { qssc::config::releaseContextConfig(&context); });
+  prepareContext_(context, registry, config);
+
+  if (handleShowOptions_(registry, config))
+    return llvm::Error::success();
+
+  auto targetResult = buildTarget_(&context, config, timing);
+  if (auto err = targetResult.takeError())
+    return err;
+  // The target must be released before its context is destroyed.
+  auto releaseTarget = llvm::make_scope_exit(
+      [&]() { getTargetInfo_(config).releaseTarget(&context); });
+
+  context.getDiagEngine().registerHandler([&](mlir::Diagnostic &diagnostic) {
+    diagEngineHandler(diagnostic, diagnosticCb);
+  });
+
+  auto targetCompilationManager = buildTargetCompilationManager_(
+      context, targetResult.get(), config, /*applyCLOptions=*/false);
+  if (auto err = targetCompilationManager.takeError())
+    return err;
+
+  return compileModule_(context, config, **targetCompilationManager,
+                        outputString, diagnosticCb, /*applyCLOptions=*/false,
+                        timing);
+}
 } // anonymous namespace
 
+/// This is the implementation class (following the Pimpl idiom) for
+/// CompilerSession. It owns all of the state which outlives a single job.
+struct qssc::CompilerSession::Impl {
+  ~Impl();
+
+  /// Parse the session options and build the long-lived compilation state.
+  llvm::Error initialize(int argc, char const **argv);
+
+  /// Compile a single job against the long-lived compilation state.
+  llvm::Error compile(std::string_view input, std::string *outputString,
+                      std::optional<DiagnosticCallback> jobDiagnosticCb);
+
+  /// Registry of the dialects loaded into the context.
+  mlir::DialectRegistry registry;
+  /// The context shared by all jobs, along with its thread pool.
+  std::unique_ptr<mlir::MLIRContext> context;
+  /// The configuration the session was created with.
+  QSSConfig config;
+  /// The registry entry owning the session's target.
+  qssc::hal::registry::TargetSystemInfo *targetInfo = nullptr;
+  /// The target compilation manager for the session's target.
+  std::unique_ptr<qssc::hal::compile::ThreadedCompilationManager>
+      targetCompilationManager;
+  /// Diagnostic callback used when a job does not supply its own.
+  std::optional<DiagnosticCallback> sessionDiagnosticCb;
+  /// Diagnostic callback of the currently running job.
+  std::optional<DiagnosticCallback> diagnosticCb;
+  /// Serializes jobs submitted to this session.
+  std::mutex jobMutex;
+};
+
+qssc::CompilerSession::Impl::~Impl() {
+  // The target and the pass managers built for it must not outlive the
+  // context they were created for.
+  targetCompilationManager.reset();
+  if (targetInfo)
+    targetInfo->releaseTarget(context.get());
+  if (context)
+    qssc::config::releaseContextConfig(context.get());
+}
+
+llvm::Error qssc::CompilerSession::Impl::initialize(int argc,
+                                                    char const **argv) {
+  if (auto err = parseCLOptions_(argc, argv, registry))
+    return err;
+
+  DefaultTimingManager tm;
+  applyDefaultTimingManagerCLOptions(tm);
+  TimingScope timing = tm.getRootScope();
+
+  // Instantiate after parsing command line options.
+  context = std::make_unique<mlir::MLIRContext>();
+
+  auto configResult = qssc::config::buildToolConfig();
+  if (auto err = configResult.takeError())
+    return err;
+  config = configResult.get();
+  qssc::config::setContextConfig(context.get(), config);
+
+  prepareContext_(*context, registry, config);
+  // Load all of the registered dialects up front rather than on first use by
+  // a job.
+  context->loadAllAvailableDialects();
+
+  auto targetResult = buildTarget_(context.get(), config, timing);
+  if (auto err = targetResult.takeError())
+    return err;
+  targetInfo = &getTargetInfo_(config);
+
+  context->getDiagEngine().registerHandler(
+      [this](mlir::Diagnostic &diagnostic) {
+        diagEngineHandler(diagnostic, diagnosticCb);
+      });
+
+  auto targetCompilationManagerResult =
+      buildTargetCompilationManager_(*context, targetResult.get(), config,
+                                     /*applyCLOptions=*/true);
+  if (auto err = targetCompilationManagerResult.takeError())
+    return err;
+  targetCompilationManager = std::move(*targetCompilationManagerResult);
+
+  return llvm::Error::success();
+}
+
+llvm::Error qssc::CompilerSession::Impl::compile(
+    std::string_view input, std::string *outputString,
+    std::optional<DiagnosticCallback> jobDiagnosticCb) {
+  // NOLINTNEXTLINE(clang-diagnostic-ctad-maybe-unsupported)
+  std::lock_guard const lock(jobMutex);
+
+  diagnosticCb =
+      jobDiagnosticCb.has_value() ? jobDiagnosticCb : sessionDiagnosticCb;
+
+  DefaultTimingManager tm;
+  applyDefaultTimingManagerCLOptions(tm);
+  TimingScope timing = tm.getRootScope();
+
+  QSSConfig jobConfig = config;
+  jobConfig.setInputSource(std::string(input));
+  if (jobConfig.getInputType() == InputType::None)
+    return llvm::createStringError(
+        llvm::inconvertibleErrorCode(),
+        "The input source format must be specified with -X when creating a "
+        "compiler session.");
+  qssc::config::setContextConfig(context.get(), jobConfig);
+
+  auto err = compileModule_(*context, jobConfig, *targetCompilationManager,
+                            outputString, diagnosticCb,
+                            /*applyCLOptions=*/true, timing);
+  diagnosticCb = std::nullopt;
+  return err;
+}
+
+qssc::CompilerSession::CompilerSession() : impl(std::make_unique<Impl>()) {}
+
+qssc::CompilerSession::~CompilerSession() = default;
+
+std::unique_ptr<qssc::CompilerSession>
+qssc::CompilerSession::create(int argc, char const **argv,
+                              std::optional<DiagnosticCallback> diagnosticCb) {
+  std::unique_ptr<CompilerSession> session(new CompilerSession());
+  session->impl->sessionDiagnosticCb = std::move(diagnosticCb);
+  session->impl->diagnosticCb = session->impl->sessionDiagnosticCb;
+  if (auto err = session->impl->initialize(argc, argv)) {
+    llvm::logAllUnhandledErrors(std::move(err), llvm::errs(), "Error: ");
+    return nullptr;
+  }
+  session->impl->diagnosticCb = std::nullopt;
+  return session;
+}
+
+int qssc::CompilerSession::compile(
+    std::string_view input, std::string *outputString,
+    std::optional<DiagnosticCallback> diagnosticCb) {
+  if (auto err = impl->compile(input, outputString, std::move(diagnosticCb))) {
+    llvm::logAllUnhandledErrors(std::move(err), llvm::errs(), "Error: ");
+    return 1;
+  }
+
+  return 0;
+}
+
 int qssc::compile(int argc, char const **argv, std::string *outputString,
                   std::optional<DiagnosticCallback> diagnosticCb) {
   if (auto err = compile_(argc, argv, outputString, std::move(diagnosticCb))) {
@@ -690,6 +1065,18 @@ int qssc::compile(int argc, char const **argv, std::string *outputString,
   return 0;
 }
 
+int qssc::compile(const QSSConfig &config, std::string_view input,
+                  std::string *outputString,
+                  std::optional<DiagnosticCallback> diagnosticCb) {
+  if (auto err =
+          compileWithConfig_(config, input, outputString, diagnosticCb)) {
+    llvm::logAllUnhandledErrors(std::move(err), llvm::errs(), "Error: ");
+    return 1;
+  }
+
+  return 0;
+}
+
 class MapAngleArgumentSource : public qssc::arguments::ArgumentSource {
 
 public:
@@ -711,22 +1098,138 @@ private:
   const std::unordered_map<std::string, double> &parameterMap;
 };
 
-llvm::Error
-_bindArguments(std::string_view target, std::string_view configPath,
-               std::string_view moduleInput, std::string_view payloadOutputPath,
-               std::unordered_map<std::string, double> const &arguments,
-               bool treatWarningsAsErrors, bool enableInMemoryInput,
-               std::string *inMemoryOutput,
-               const std::optional<qssc::DiagnosticCallback> &onDiagnostic) {
+namespace {
+/// Targets created for binding arguments. Creating a target parses its
+/// configuration and builds its child targets, so the linker keeps one
+/// target per target name and configuration path across calls and rebuilds
+/// it only once the configuration file changes.
+class BindTargetCache {
+public:
+  /// Modification time and size of a configuration file, if it exists
+  using ConfigStamp =
+      std::optional<std::pair<llvm::sys::TimePoint<>, uint64_t>>;
+
+  /// A target created in a context of its own for binding arguments
+  class Entry {
+  public:
+    Entry(qssc::hal::registry::TargetSystemInfo &targetInfo,
+          ConfigStamp stamp)
+        : targetInfo(targetInfo), stamp(std::move(stamp)) {}
+    Entry(const Entry &) = delete;
+    Entry &operator=(const Entry &) = delete;
+    ~Entry() { targetInfo.releaseTarget(&context); }
+
+    /// Factory of the target, which may be shared by concurrent binds
+    qssc::arguments::BindArgumentsImplementationFactory &getFactory() {
+      return *factory;
+    }
 
-  MLIRContext context{};
+    llvm::ThreadPool *getThreadPool() {
+      return context.isMultithreadingEnabled() ? &context.getThreadPool()
+                                               : nullptr;
+    }
+
+  private:
+    friend class BindTargetCache;
+
+    qssc::hal::registry::TargetSystemInfo &targetInfo;
+    ConfigStamp stamp;
+    MLIRContext context;
+    std::optional<qssc::arguments::SynchronizedBindArgumentsFactory> factory;
+  };
+
+  static BindTargetCache &get() {
+    static BindTargetCache cache;
+    return cache;
+  }
+
+  /// Get the cached target for target and configPath, creating it if it is
+  /// not cached or its configuration file has changed. Entries stay valid
+  /// while they are in use even if they are replaced in the cache.
+  llvm::Expected<std::shared_ptr<Entry>>
+  lookup(std::string_view target, std::string_view configPath,
+         const std::optional<qssc::DiagnosticCallback> &onDiagnostic);
+
+  void clear() {
+    std::map<Key, std::shared_ptr<Entry>> released;
+    {
+      // NOLINTNEXTLINE(clang-diagnostic-ctad-maybe-unsupported)
+      std::lock_guard const lock(mutex);
+      released.swap(entries);
+    }
+    // Targets are released outside of the lock.
+  }
+
+private:
+  using Key = std::pair<std::string, std::string>;
+
+  static ConfigStamp getConfigStamp(std::string_view configPath);
+  static llvm::Expected<std::shared_ptr<Entry>>
+  create(std::string_view target, std::string_view configPath,
+         ConfigStamp stamp,
+         const std::optional<qssc::DiagnosticCallback> &onDiagnostic);
+
+  std::mutex mutex;
+  std::map<Key, std::shared_ptr<Entry>> entries;
+};
+
+BindTargetCache::ConfigStamp
+BindTargetCache::getConfigStamp(std::string_view configPath) {
+  llvm::sys::fs::file_status status;
+  if (configPath.empty() ||
+      llvm::sys::fs::status(llvm::StringRef(configPath), status))
+    return std::nullopt;
+  return std::make_pair(status.getLastModificationTime(), status.getSize());
+}
+
+llvm::Expected<std::shared_ptr<BindTargetCache::Entry>>
+BindTargetCache::lookup(
+    std::string_view target, std::string_view configPath,
+    const std::optional<qssc::DiagnosticCallback> &onDiagnostic) {
+  Key key{std::string(target), std::string(configPath)};
+  ConfigStamp stamp = getConfigStamp(configPath);
+
+  std::shared_ptr<Entry> stale;
+  {
+    // NOLINTNEXTLINE(clang-diagnostic-ctad-maybe-unsupported)
+    std::lock_guard const lock(mutex);
+    auto pos = entries.find(key);
+    if (pos != entries.end()) {
+      if (pos->second->stamp == stamp)
+        return pos->second;
+      stale = std::move(pos->second);
+      entries.erase(pos);
+    }
+  }
+  // The stale target is released once its last bind completes.
+  stale.reset();
+
+  // Targets are created outside of the lock, so concurrent misses for the
+  // same key may both create a target; the last one created is cached.
+  auto created = create(target, configPath, stamp, onDiagnostic);
+  if (!created)
+    return created.takeError();
+
+  // NOLINTNEXTLINE(clang-diagnostic-ctad-maybe-unsupported)
+  std::lock_guard const lock(mutex);
+  entries[std::move(key)] = created.get();
+  return created;
+}
+
+llvm::Expected<std::shared_ptr<BindTargetCache::Entry>>
+BindTargetCache::create(
+    std::string_view target, std::string_view configPath, ConfigStamp stamp,
+    const std::optional<qssc::DiagnosticCallback> &onDiagnostic) {
 
   qssc::hal::registry::TargetSystemInfo &targetInfo =
       *qssc::hal::registry::TargetSystemRegistry::lookupPluginInfo(target)
            .value_or(qssc::hal::registry::TargetSystemRegistry::
                          nullTargetSystemInfo());
 
-  auto created = targetInfo.createTarget(&context, llvm::StringRef(configPath));
+  auto entry = std::make_shared<Entry>(targetInfo, std::move(stamp));
+
+  auto created =
+      targetInfo.createTarget(&entry->context, llvm::StringRef(configPath));
   if (auto err = created.takeError()) {
     return llvm::joinErrors(
         llvm::createStringError(llvm::inconvertibleErrorCode(),
@@ -734,7 +1237,7 @@ _bindArguments(std::string_view target, std::string_view configPath,
         std::move(err));
   }
 
-  auto targetInst = targetInfo.getTarget(&context);
+  auto targetInst = targetInfo.getTarget(&entry->context);
   if (auto err = targetInst.takeError()) {
     return llvm::joinErrors(
         llvm::createStringError(llvm::inconvertibleErrorCode(),
@@ -742,8 +1245,6 @@ _bindArguments(std::string_view target, std::string_view configPath,
         std::move(err));
   }
 
-  MapAngleArgumentSource const source(arguments);
-
   auto factory = targetInst.get()->getBindArgumentsImplementationFactory();
   if ((!factory.has_value()) || (factory.value() == nullptr)) {
     return qssc::emitDiagnostic(
@@ -751,11 +1252,88 @@ _bindArguments(std::string_view target, std::string_view configPath,
         qssc::ErrorCategory::QSSLinkerNotImplemented,
         "Unable to load bind arguments implementation for target.");
   }
-  qssc::arguments::BindArgumentsImplementationFactory &factoryRef =
-      *factory.value();
+  entry->factory.emplace(*factory.value());
+  return entry;
+}
+} // anonymous namespace
+
+llvm::Error
+_bindArguments(std::string_view target, std::string_view configPath,
+               std::string_view moduleInput, std::string_view payloadOutputPath,
+               std::unordered_map<std::string, double> const &arguments,
+               bool treatWarningsAsErrors, bool enableInMemoryInput,
+               std::string *inMemoryOutput,
+               const std::optional<qssc::DiagnosticCallback> &onDiagnostic) {
+
+  auto bindTarget =
+      BindTargetCache::get().lookup(target, configPath, onDiagnostic);
+  if (auto err = bindTarget.takeError())
+    return err;
+  auto &entry = **bindTarget;
+
+  MapAngleArgumentSource const source(arguments);
+
   return qssc::arguments::bindArguments(
       moduleInput, payloadOutputPath, source, treatWarningsAsErrors,
-      enableInMemoryInput, inMemoryOutput, factoryRef, onDiagnostic);
+      enableInMemoryInput, inMemoryOutput, entry.getFactory(), onDiagnostic,
+      entry.getThreadPool());
+}
+
+llvm::Error _bindArgumentsBatch(
+    std::string_view target, std::string_view configPath,
+    std::string_view moduleInput,
+    std::vector<std::string> const &payloadOutputPaths,
+    std::vector<std::unordered_map<std::string, double>> const &arguments,
+    bool treatWarningsAsErrors, bool enableInMemoryInput,
+    std::vector<std::string> *inMemoryOutputs,
+    const std::optional<qssc::DiagnosticCallback> &onDiagnostic,
+    bool emitOverlays) {
+
+  auto bindTarget =
+      BindTargetCache::get().lookup(target, configPath, onDiagnostic);
+  if (auto err = bindTarget.takeError())
+    return err;
+  auto &entry = **bindTarget;
+
+  std::vector<MapAngleArgumentSource> sources;
+  sources.reserve(arguments.size());
+  std::vector<qssc::arguments::ArgumentSource const *> argumentSets;
+  argumentSets.reserve(arguments.size());
+  for (auto const &parameterMap : arguments)
+    argumentSets.push_back(&sources.emplace_back(parameterMap));
+
+  return qssc::arguments::bindArgumentsBatch(
+      moduleInput, payloadOutputPaths, argumentSets, treatWarningsAsErrors,
+      enableInMemoryInput, inMemoryOutputs, entry.getFactory(), onDiagnostic,
+      entry.getThreadPool(), emitOverlays);
+}
+
+llvm::Error _bindArgumentColumns(
+    std::string_view target, std::string_view configPath,
+    std::string_view moduleInput,
+    std::vector<std::string> const &payloadOutputPaths,
+    std::vector<std::string> const &parameterNames,
+    std::vector<double> const &values, size_t numPoints,
+    bool treatWarningsAsErrors, bool enableInMemoryInput,
+    std::vector<std::string> *inMemoryOutputs,
+    const std::optional<qssc::DiagnosticCallback> &onDiagnostic,
+    bool emitOverlays) {
+
+  auto bindTarget =
+      BindTargetCache::get().lookup(target, configPath, onDiagnostic);
+  if (auto err = bindTarget.takeError())
+    return err;
+  auto &entry = **bindTarget;
+
+  auto arguments = qssc::arguments::ColumnarArguments::create(
+      parameterNames, values, numPoints);
+  if (auto err = arguments.takeError())
+    return err;
+
+  return qssc::arguments::bindArgumentColumns(
+      moduleInput, payloadOutputPaths, arguments.get(), treatWarningsAsErrors,
+      enableInMemoryInput, inMemoryOutputs, entry.getFactory(), onDiagnostic,
+      entry.getThreadPool(), emitOverlays);
 }
 
 int qssc::bindArguments(
@@ -775,3 +1353,46 @@ int qssc::bindArguments(
   }
   return 0;
 }
+
+int qssc::bindArgumentsBatch(
+    std::string_view target, std::string_view configPath,
+    std::string_view moduleInput,
+    std::vector<std::string> const &payloadOutputPaths,
+    std::vector<std::unordered_map<std::string, double>> const &arguments,
+    bool treatWarningsAsErrors, bool enableInMemoryInput,
+    std::vector<std::string> *inMemoryOutputs,
+    const std::optional<qssc::DiagnosticCallback> &onDiagnostic,
+    bool emitOverlays) {
+
+  if (auto err = _bindArgumentsBatch(
+          target, configPath, moduleInput, payloadOutputPaths, arguments,
+          treatWarningsAsErrors, enableInMemoryInput, inMemoryOutputs,
+          onDiagnostic, emitOverlays)) {
+    llvm::logAllUnhandledErrors(std::move(err), llvm::errs());
+    return 1;
+  }
+  return 0;
+}
+
+int qssc::bindArgumentColumns(
+    std::string_view target, std::string_view configPath,
+    std::string_view moduleInput,
+    std::vector<std::string> const &payloadOutputPaths,
+    std::vector<std::string> const &parameterNames,
+    std::vector<double> const &values, size_t numPoints,
+    bool treatWarningsAsErrors, bool enableInMemoryInput,
+    std::vector<std::string> *inMemoryOutputs,
+    const std::optional<qssc::DiagnosticCallback> &onDiagnostic,
+    bool emitOverlays) {
+
+  if (auto err = _bindArgumentColumns(
+          target, configPath, moduleInput, payloadOutputPaths, parameterNames,
+          values, numPoints, treatWarningsAsErrors, enableInMemoryInput,
+          inMemoryOutputs, onDiagnostic, emitOverlays)) {
+    llvm::logAllUnhandledErrors(std::move(err), llvm::errs());
+    return 1;
+  }
+  return 0;
+}
+
+void qssc::clearBindTargetCache() { BindTargetCache::get().clear(); }
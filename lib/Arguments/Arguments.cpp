@@ -20,37 +20,300 @@
 
 #include "Arguments/Arguments.h"
 #include "API/errors.h"
+#include "Arguments/BindingPlan.h"
+#include "Arguments/ColumnarArguments.h"
 #include "Arguments/Signature.h"
 #include "Payload/Payload.h"
+#include "Payload/PayloadBuffer.h"
+#include "Payload/PayloadOverlay.h"
 
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/Twine.h"
 #include "llvm/Support/Error.h"
-#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/raw_ostream.h"
 
-#include <fstream>
-#include <iostream>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <map>
 #include <memory>
-#include <sstream>
+#include <mutex>
+#include <optional>
 #include <string>
 #include <system_error>
 #include <utility>
+#include <vector>
 
 namespace qssc::arguments {
 
 using namespace payload;
 
-llvm::Error updateParameters(qssc::payload::PatchablePayload *payload,
-                             Signature &sig, ArgumentSource const &arguments,
+namespace {
+/// Answers lookups by name from values ordered by the parameters of a plan,
+/// for binaries that are patched through BindArgumentsImplementation::patch
+class PlanArgumentSource : public ArgumentSource {
+public:
+  PlanArgumentSource(BindingPlan const &plan,
+                     llvm::ArrayRef<ArgumentType> values)
+      : plan_(plan), values_(values) {}
+
+  ArgumentType getArgumentValue(llvm::StringRef name) const override {
+    auto parameter = plan_.lookupParameter(name);
+    if (!parameter.has_value() || parameter.value() >= values_.size())
+      return std::nullopt;
+    return values_[parameter.value()];
+  }
+
+private:
+  BindingPlan const &plan_;
+  llvm::ArrayRef<ArgumentType> values_;
+};
+
+/// Wrap onDiagnostic so that it may be called from several threads at once
+OptDiagnosticCallback synchronizeDiagnostics(
+    const OptDiagnosticCallback &onDiagnostic, std::mutex &mutex) {
+  if (!onDiagnostic.has_value())
+    return std::nullopt;
+  return [&onDiagnostic, &mutex](const Diagnostic &diagnostic) {
+    // NOLINTNEXTLINE(clang-diagnostic-ctad-maybe-unsupported)
+    std::lock_guard lock(mutex);
+    onDiagnostic.value()(diagnostic);
+  };
+}
+
+/// Encodings of the patch points of a binding plan for every point of a
+/// sweep, encoded a column at a time. Patch points of the same parameter and
+/// patch type share a column.
+class EncodedColumns {
+public:
+  static llvm::Expected<EncodedColumns>
+  create(BindingPlan const &plan, ColumnarArguments const &arguments,
+         BindArgumentsImplementation &encoder) {
+    EncodedColumns encodedColumns;
+    std::map<std::pair<uint32_t, llvm::StringRef>, uint32_t> columnIndices;
+    size_t const numPoints = arguments.getNumPoints();
+    auto const parameterNames = plan.getParameterNames();
+
+    for (auto const &binary : plan.getBinaries()) {
+      for (auto const &entry : binary.entries) {
+        PatchPoint const *patchPoint = entry.patchPoint;
+        auto [pos, inserted] = columnIndices.try_emplace(
+            {entry.parameter, patchPoint->patchType()},
+            encodedColumns.columns_.size());
+        if (!inserted) {
+          if (pos->second != noColumn)
+            encodedColumns.patchPointColumns_[patchPoint] = pos->second;
+          continue;
+        }
+
+        // missing arguments are reported when binding each point
+        auto values = arguments.getColumn(parameterNames[entry.parameter]);
+        Column column;
+        if (values.has_value() && numPoints != 0) {
+          auto encoded =
+              encoder.encodePatchColumn(*patchPoint, *values, column.bytes);
+          if (!encoded)
+            return encoded.takeError();
+          if (encoded.get()) {
+            column.width = column.bytes.size() / numPoints;
+            encodedColumns.patchPointColumns_[patchPoint] = pos->second;
+            encodedColumns.columns_.push_back(std::move(column));
+            continue;
+          }
+        }
+        pos->second = noColumn;
+      }
+    }
+    return encodedColumns;
+  }
+
+  /// Get the encoding of patchPoint for point, if it has been encoded
+  std::optional<llvm::ArrayRef<char>> lookup(PatchPoint const &patchPoint,
+                                             size_t point) const {
+    auto pos = patchPointColumns_.find(&patchPoint);
+    if (pos == patchPointColumns_.end())
+      return std::nullopt;
+    auto const &column = columns_[pos->second];
+    return llvm::ArrayRef<char>(column.bytes)
+        .slice(point * column.width, column.width);
+  }
+
+private:
+  static constexpr uint32_t noColumn = std::numeric_limits<uint32_t>::max();
+
+  struct Column {
+    llvm::SmallVector<char, 0> bytes;
+    size_t width = 0;
+  };
+
+  std::vector<Column> columns_;
+  llvm::DenseMap<PatchPoint const *, uint32_t> patchPointColumns_;
+};
+
+/// Encodes the patch points of one point of a sweep from its encoded
+/// columns, deferring to the target for everything else
+class ColumnPointEncoder : public BindArgumentsImplementation {
+public:
+  ColumnPointEncoder(BindArgumentsImplementation &target,
+                     EncodedColumns const &columns, size_t point)
+      : target_(target), columns_(columns), point_(point) {}
+
+  llvm::Error patch(PatchPoint const &patchPoint,
+                    ArgumentSource const &arguments) override {
+    return target_.patch(patchPoint, arguments);
+  }
+  llvm::Error parseParamMapIntoSignature(llvm::StringRef paramMapContents,
+                                         llvm::StringRef paramMapFileName,
+                                         Signature &sig) override {
+    return target_.parseParamMapIntoSignature(paramMapContents,
+                                              paramMapFileName, sig);
+  }
+  PatchablePayload *getPayload(llvm::StringRef payloadOutputPath,
+                               bool enableInMemory) override {
+    return target_.getPayload(payloadOutputPath, enableInMemory);
+  }
+  llvm::Expected<Signature> parseSignature(PatchablePayload *payload) override {
+    return target_.parseSignature(payload);
+  }
+  llvm::Expected<BindingPlan>
+  parseBindingPlan(PatchablePayload *payload) override {
+    return target_.parseBindingPlan(payload);
+  }
+  llvm::Expected<bool>
+  encodePatch(PatchPoint const &patchPoint, ArgumentType const &value,
+              llvm::SmallVectorImpl<char> &bytes) override {
+    if (auto encoded = columns_.lookup(patchPoint, point_)) {
+      bytes.append(encoded->begin(), encoded->end());
+      return true;
+    }
+    return target_.encodePatch(patchPoint, value, bytes);
+  }
+
+private:
+  BindArgumentsImplementation &target_;
+  EncodedColumns const &columns_;
+  size_t point_;
+};
+} // anonymous namespace
+
+llvm::Expected<BindingPlan>
+BindArgumentsImplementation::parseBindingPlan(PatchablePayload *payload) {
+  auto sigOrError = parseSignature(payload);
+  if (!sigOrError)
+    return sigOrError.takeError();
+  return BindingPlan(std::move(sigOrError.get()));
+}
+
+llvm::Expected<bool> BindArgumentsImplementation::encodePatchColumn(
+    PatchPoint const &patchPoint, llvm::ArrayRef<double> values,
+    llvm::SmallVectorImpl<char> &bytes) {
+  size_t const begin = bytes.size();
+  std::optional<size_t> width;
+  for (double const value : values) {
+    size_t const valueBegin = bytes.size();
+    auto encoded = encodePatch(patchPoint, value, bytes);
+    if (!encoded)
+      return encoded.takeError();
+    if (!encoded.get() ||
+        (width.has_value() && bytes.size() - valueBegin != width.value())) {
+      // drop partial column
+      bytes.truncate(begin);
+      return false;
+    }
+    width = bytes.size() - valueBegin;
+  }
+  return true;
+}
+
+llvm::Error applyBindingPlan(qssc::payload::PatchablePayload *payload,
+                             BindingPlan const &plan,
+                             llvm::ArrayRef<ArgumentType> values,
                              bool treatWarningsAsErrors,
+                             BindArgumentsImplementation &encoder,
                              BindArgumentsImplementationFactory &factory,
-                             const OptDiagnosticCallback &onDiagnostic) {
+                             const OptDiagnosticCallback &onDiagnostic,
+                             llvm::ThreadPool *threadPool) {
+
+  if (values.size() != plan.getNumParameters())
+    return llvm::createStringError(
+        llvm::inconvertibleErrorCode(),
+        "Expected one argument value per parameter of the binding plan");
+
+  bool const parallel = threadPool && factory.supportsParallelPatching();
+  PlanArgumentSource const arguments(plan, values);
+
+  std::mutex diagnosticMutex;
+  OptDiagnosticCallback const binaryOnDiagnostic =
+      parallel ? synchronizeDiagnostics(onDiagnostic, diagnosticMutex)
+               : onDiagnostic;
+
+  // binaries read for patching by the target, patched after all have been
+  // read when patching in parallel
+  struct PendingBinary {
+    BindingPlan::Binary const *binaryPlan;
+    std::unique_ptr<BindArgumentsImplementation> binary;
+  };
+  std::vector<PendingBinary> pending;
 
-  for (const auto &[binaryName, patchPoints] : sig.patchPointsByBinary) {
+  auto patchBinary = [&](PendingBinary const &item) -> llvm::Error {
+    for (auto const &entry : item.binaryPlan->entries)
+      if (auto err = item.binary->patch(*entry.patchPoint, arguments))
+        return err;
+    return llvm::Error::success();
+  };
+
+  // encoded patches of one binary, reused across binaries
+  llvm::SmallVector<char, 256> encoded;
+  llvm::SmallVector<size_t, 32> encodedEnds;
+
+  for (auto const &binaryPlan : plan.getBinaries()) {
+    auto const &binaryName = binaryPlan.name;
+    auto const &entries = binaryPlan.entries;
+
+    if (entries.empty()) // no patch points
+      continue;
+
+    // encode all patch points before patching any, so that a binary is
+    // either patched directly or read and patched as a whole
+    encoded.clear();
+    encodedEnds.clear();
+    bool allEncoded = true;
+    for (auto const &entry : entries) {
+      auto encodedOrErr =
+          encoder.encodePatch(*entry.patchPoint, values[entry.parameter],
+                              encoded);
+      if (!encodedOrErr)
+        return encodedOrErr.takeError();
+      if (!encodedOrErr.get()) {
+        allEncoded = false;
+        break;
+      }
+      encodedEnds.push_back(encoded.size());
+    }
 
-    if (patchPoints.size() == 0) // no patch points
+    if (allEncoded) {
+      // patch the payload directly without reading the binary
+      size_t begin = 0;
+      for (size_t i = 0; i < entries.size(); ++i) {
+        llvm::ArrayRef<char> const bytes(encoded.data() + begin,
+                                         encodedEnds[i] - begin);
+        begin = encodedEnds[i];
+        if (auto error =
+                payload->patchMember(binaryName, entries[i].offset, bytes))
+          return emitDiagnostic(onDiagnostic, qssc::Severity::Error,
+                                qssc::ErrorCategory::QSSLinkSignatureError,
+                                "Error patching " + binaryName + " " +
+                                    toString(std::move(error)));
+      }
       continue;
+    }
 
+    // payloads are not thread safe, so members are always read here
     auto binaryDataOrErr = payload->readMember(binaryName);
 
     if (!binaryDataOrErr) {
@@ -63,59 +326,80 @@ llvm::Error updateParameters(qssc::payload::PatchablePayload *payload,
 
     auto &binaryData = binaryDataOrErr.get();
 
-    auto binary = std::shared_ptr<BindArgumentsImplementation>(
-        factory.create(binaryData, onDiagnostic));
-    binary->setTreatWarningsAsErrors(treatWarningsAsErrors);
+    PendingBinary item{&binaryPlan,
+                       std::unique_ptr<BindArgumentsImplementation>(
+                           factory.create(binaryData, binaryOnDiagnostic))};
+    item.binary->setTreatWarningsAsErrors(treatWarningsAsErrors);
 
-    for (auto const &patchPoint : patchPoints)
-      if (auto err = binary->patch(patchPoint, arguments))
+    if (!parallel) {
+      if (auto err = patchBinary(item))
         return err;
+      continue;
+    }
+    pending.push_back(std::move(item));
   }
 
-  return llvm::Error::success();
-}
-
-llvm::Error bindArguments(llvm::StringRef moduleInput,
-                          llvm::StringRef payloadOutputPath,
-                          ArgumentSource const &arguments,
-                          bool treatWarningsAsErrors, bool enableInMemoryInput,
-                          std::string *inMemoryOutput,
-                          BindArgumentsImplementationFactory &factory,
-                          const OptDiagnosticCallback &onDiagnostic) {
+  if (pending.empty())
+    return llvm::Error::success();
 
-  bool const enableInMemoryOutput = payloadOutputPath == "";
+  // each binary has its own buffer and implementation instance, which
+  // targets supporting parallel patching allow to be used concurrently
+  std::vector<std::optional<llvm::Error>> failures(pending.size());
+  llvm::ThreadPoolTaskGroup tasks(*threadPool);
+  for (size_t i = 0; i < pending.size(); ++i)
+    tasks.async([&, i] {
+      if (auto err = patchBinary(pending[i]))
+        failures[i].emplace(std::move(err));
+    });
+  tasks.wait();
 
-  // placeholder string for data on disk if required
-  std::string inputFromDisk;
+  llvm::Error result = llvm::Error::success();
+  for (auto &failure : failures)
+    if (failure.has_value())
+      result = llvm::joinErrors(std::move(result), std::move(*failure));
+  return result;
+}
 
-  if (!enableInMemoryInput) {
-    // compile payload on disk
-    // copy to link payload if not returning in memory
-    // load from disk into string if returning in memory
-    if (!enableInMemoryOutput) {
-      std::error_code const copyError =
-          llvm::sys::fs::copy_file(moduleInput, payloadOutputPath);
-      if (copyError)
-        return llvm::make_error<llvm::StringError>(
-            "Failed to copy circuit module to payload", copyError);
-    } else {
-      // read from disk to process in memory
-      std::ostringstream buf;
-      std::ifstream const input(moduleInput.str().c_str());
-      buf << input.rdbuf();
-      inputFromDisk = buf.str();
-      moduleInput = inputFromDisk;
-      enableInMemoryInput = true;
-    }
-  }
+/// Bind arguments into a copy of moduleInput written to payloadOutputPath,
+/// or returned in inMemoryOutput if the path is empty. Parses the signature
+/// of the payload unless a binding plan is given. Patch points are encoded
+/// from encodedColumns at point if given.
+llvm::Error bindPayload(llvm::StringRef moduleInput,
+                        llvm::StringRef payloadOutputPath,
+                        ArgumentSource const &arguments,
+                        bool treatWarningsAsErrors, bool enableInMemoryInput,
+                        std::string *inMemoryOutput,
+                        BindArgumentsImplementationFactory &factory,
+                        const OptDiagnosticCallback &onDiagnostic,
+                        BindingPlan const *plan,
+                        llvm::ThreadPool *threadPool,
+                        EncodedColumns const *encodedColumns = nullptr,
+                        size_t point = 0) {
+  bool const enableInMemoryOutput = payloadOutputPath == "";
 
-  if (!enableInMemoryOutput && enableInMemoryInput) {
-    // if payload in memory but returning on disk
-    // copy to disk and process from there
-    std::ofstream payload;
-    payload.open(payloadOutputPath.str(), std::ios::binary);
-    payload.write(moduleInput.str().c_str(), moduleInput.str().length());
-    payload.close();
+  // Stage the payload so that it is copied at most once: payloads returned
+  // in memory are copied by the payload when it is opened in memory, while
+  // payloads returned on disk are copied to the output file once and then
+  // patched in place there.
+  std::unique_ptr<llvm::MemoryBuffer> inputFromDisk;
+  if (!enableInMemoryInput && enableInMemoryOutput) {
+    // map the module instead of reading it
+    auto bufferOrErr = llvm::MemoryBuffer::getFile(
+        moduleInput, /*IsText=*/false, /*RequiresNullTerminator=*/false);
+    if (!bufferOrErr)
+      return llvm::make_error<llvm::StringError>(
+          "Failed to read circuit module " + moduleInput,
+          bufferOrErr.getError());
+    inputFromDisk = std::move(bufferOrErr.get());
+    moduleInput = inputFromDisk->getBuffer();
+    enableInMemoryInput = true;
+  } else if (!enableInMemoryInput) {
+    if (auto err = PayloadBuffer::copyFile(moduleInput, payloadOutputPath))
+      return err;
+  } else if (!enableInMemoryOutput) {
+    if (auto err = PayloadBuffer::borrow(moduleInput).writeToFile(
+            payloadOutputPath))
+      return err;
     enableInMemoryInput = false;
   }
 
@@ -129,39 +413,239 @@ llvm::Error bindArguments(llvm::StringRef moduleInput,
   auto payload = std::unique_ptr<PatchablePayload>(
       binary->getPayload(payloadData, enableInMemoryInput));
 
-  auto sigOrError = binary->parseSignature(payload.get());
-  if (auto err = sigOrError.takeError())
-    return err;
+  std::optional<BindingPlan> parsedPlan;
+  if (!plan) {
+    auto planOrError = binary->parseBindingPlan(payload.get());
+    if (auto err = planOrError.takeError())
+      return err;
+    parsedPlan.emplace(std::move(planOrError.get()));
+    plan = &parsedPlan.value();
+  }
 
-  if (auto err = updateParameters(payload.get(), sigOrError.get(), arguments,
-                                  treatWarningsAsErrors, factory, onDiagnostic))
+  std::optional<ColumnPointEncoder> columnEncoder;
+  BindArgumentsImplementation *encoder = binary.get();
+  if (encodedColumns)
+    encoder = &columnEncoder.emplace(*binary, *encodedColumns, point);
+
+  if (auto err = applyBindingPlan(payload.get(), *plan,
+                                  plan->resolve(arguments),
+                                  treatWarningsAsErrors, *encoder, factory,
+                                  onDiagnostic, threadPool))
     return err;
 
-  // setup linked payload I/O
-  // if enableInMemoryOutput is true:
-  //    write to string
-  // if enableInMemoryInput is true:
-  //    payload is not on disk yet, do not assume payload->writeBack()
-  //    will write the full payload to disk so: write to string,
-  //    dump string to disk and clear string
-  // if enableInMemoryInput is false:
-  //    payload was on disk originally use writeBack
+  // payloads returned on disk are complete after writeBack, while payloads
+  // returned in memory are moved out of the payload
   if (auto err = payload->writeBack())
     return err;
-  if (enableInMemoryOutput || enableInMemoryInput) {
+  if (enableInMemoryOutput)
     if (auto err = payload->writeString(inMemoryOutput))
       return err;
-    if (!enableInMemoryOutput) {
-      auto pathStr = payloadOutputPath.str();
-      std::ofstream out(pathStr);
-      out << inMemoryOutput;
-      out.close();
-      // clear output string
-      *inMemoryOutput = "";
-    }
-  }
 
   return llvm::Error::success();
 }
 
+/// Bind arguments as an overlay on the shared payload base written to
+/// overlayOutputPath, or returned in inMemoryOutput if the path is empty.
+/// baseMutex serializes reads from base. Patch points are encoded from
+/// encodedColumns at point if given.
+llvm::Error bindOverlay(PatchablePayload &base, uint64_t baseHash,
+                        std::mutex &baseMutex,
+                        llvm::StringRef overlayOutputPath,
+                        ArgumentSource const &arguments,
+                        bool treatWarningsAsErrors, std::string *inMemoryOutput,
+                        BindArgumentsImplementationFactory &factory,
+                        const OptDiagnosticCallback &onDiagnostic,
+                        BindingPlan const &plan, llvm::ThreadPool *threadPool,
+                        EncodedColumns const *encodedColumns = nullptr,
+                        size_t point = 0) {
+  auto binary = std::unique_ptr<BindArgumentsImplementation>(
+      factory.create(onDiagnostic));
+  binary->setTreatWarningsAsErrors(treatWarningsAsErrors);
+
+  std::optional<ColumnPointEncoder> columnEncoder;
+  BindArgumentsImplementation *encoder = binary.get();
+  if (encodedColumns)
+    encoder = &columnEncoder.emplace(*binary, *encodedColumns, point);
+
+  OverlayRecordingPayload overlay(base, baseHash, &baseMutex);
+  if (auto err = applyBindingPlan(&overlay, plan, plan.resolve(arguments),
+                                  treatWarningsAsErrors, *encoder, factory,
+                                  onDiagnostic, threadPool))
+    return err;
+  if (auto err = overlay.writeBack())
+    return err;
+
+  if (overlayOutputPath.empty())
+    return overlay.writeString(inMemoryOutput);
+  return PayloadBuffer::adopt(overlay.getOverlay().serialize())
+      .writeToFile(overlayOutputPath);
+}
+
+llvm::Error bindArguments(llvm::StringRef moduleInput,
+                          llvm::StringRef payloadOutputPath,
+                          ArgumentSource const &arguments,
+                          bool treatWarningsAsErrors, bool enableInMemoryInput,
+                          std::string *inMemoryOutput,
+                          BindArgumentsImplementationFactory &factory,
+                          const OptDiagnosticCallback &onDiagnostic,
+                          llvm::ThreadPool *threadPool) {
+  return bindPayload(moduleInput, payloadOutputPath, arguments,
+                     treatWarningsAsErrors, enableInMemoryInput,
+                     inMemoryOutput, factory, onDiagnostic,
+                     /*plan=*/nullptr, threadPool);
+}
+
+namespace {
+/// Bind argumentSets as documented for bindArgumentsBatch. If columns is
+/// given, argumentSets are its points and patch points are encoded from its
+/// columns.
+llvm::Error bindBatch(llvm::StringRef moduleInput,
+                      llvm::ArrayRef<std::string> payloadOutputPaths,
+                      llvm::ArrayRef<ArgumentSource const *> argumentSets,
+                      ColumnarArguments const *columns,
+                      bool treatWarningsAsErrors, bool enableInMemoryInput,
+                      std::vector<std::string> *inMemoryOutputs,
+                      BindArgumentsImplementationFactory &factory,
+                      const OptDiagnosticCallback &onDiagnostic,
+                      llvm::ThreadPool *threadPool, bool emitOverlays) {
+
+  bool const enableInMemoryOutput = payloadOutputPaths.empty();
+  if (!enableInMemoryOutput && payloadOutputPaths.size() != argumentSets.size())
+    return llvm::createStringError(
+        llvm::inconvertibleErrorCode(),
+        "Expected one payload output path per argument set");
+  if (enableInMemoryOutput && inMemoryOutputs == nullptr)
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "inMemoryOutputs buffer is null");
+
+  // load the module once if it is on disk, so that every argument set is
+  // bound from the same in memory copy
+  std::unique_ptr<llvm::MemoryBuffer> inputFromDisk;
+  if (!enableInMemoryInput) {
+    auto bufferOrErr = llvm::MemoryBuffer::getFile(
+        moduleInput, /*IsText=*/false, /*RequiresNullTerminator=*/false);
+    if (!bufferOrErr)
+      return llvm::make_error<llvm::StringError>(
+          "Failed to read circuit module " + moduleInput,
+          bufferOrErr.getError());
+    inputFromDisk = std::move(bufferOrErr.get());
+    moduleInput = inputFromDisk->getBuffer();
+  }
+
+  // diagnostics may be emitted from several threads at once
+  std::mutex diagnosticMutex;
+  OptDiagnosticCallback const synchronizedOnDiagnostic =
+      synchronizeDiagnostics(onDiagnostic, diagnosticMutex);
+  SynchronizedBindArgumentsFactory synchronizedFactory(factory);
+
+  // parse the signature and resolve its parameters once for all argument
+  // sets
+  auto binary = std::unique_ptr<BindArgumentsImplementation>(
+      synchronizedFactory.create(synchronizedOnDiagnostic));
+  binary->setTreatWarningsAsErrors(treatWarningsAsErrors);
+  auto payload = std::unique_ptr<PatchablePayload>(
+      binary->getPayload(moduleInput, /*enableInMemory=*/true));
+  auto planOrError = binary->parseBindingPlan(payload.get());
+  if (auto err = planOrError.takeError())
+    return err;
+  BindingPlan const plan(std::move(planOrError.get()));
+
+  // encode whole columns before binding any point
+  std::optional<EncodedColumns> encodedColumns;
+  if (columns) {
+    auto encoded = EncodedColumns::create(plan, *columns, *binary);
+    if (!encoded)
+      return encoded.takeError();
+    encodedColumns.emplace(std::move(encoded.get()));
+  }
+  EncodedColumns const *encodedColumnsPtr =
+      encodedColumns ? &encodedColumns.value() : nullptr;
+
+  if (enableInMemoryOutput)
+    inMemoryOutputs->assign(argumentSets.size(), std::string());
+
+  // overlays record their changes against the payload opened above, which
+  // is shared by all argument sets
+  uint64_t const baseHash =
+      emitOverlays ? PayloadOverlay::hashBase(moduleInput) : 0;
+  std::mutex baseMutex;
+
+  // failures are collected per argument set and reported in order
+  std::vector<std::optional<std::string>> failures(argumentSets.size());
+
+  auto bindSet = [&](size_t i) {
+    llvm::StringRef const outputPath =
+        enableInMemoryOutput ? llvm::StringRef() : payloadOutputPaths[i];
+    std::string *output =
+        enableInMemoryOutput ? &(*inMemoryOutputs)[i] : nullptr;
+    llvm::Error err =
+        emitOverlays
+            ? bindOverlay(*payload, baseHash, baseMutex, outputPath,
+                          *argumentSets[i], treatWarningsAsErrors, output,
+                          synchronizedFactory, synchronizedOnDiagnostic, plan,
+                          threadPool, encodedColumnsPtr, i)
+            : bindPayload(moduleInput, outputPath, *argumentSets[i],
+                          treatWarningsAsErrors, /*enableInMemoryInput=*/true,
+                          output, synchronizedFactory,
+                          synchronizedOnDiagnostic, &plan, threadPool,
+                          encodedColumnsPtr, i);
+    if (err)
+      failures[i] = toString(std::move(err));
+  };
+
+  if (threadPool) {
+    llvm::ThreadPoolTaskGroup tasks(*threadPool);
+    for (size_t i = 0; i < argumentSets.size(); ++i)
+      tasks.async(bindSet, i);
+    tasks.wait();
+  } else {
+    for (size_t i = 0; i < argumentSets.size(); ++i)
+      bindSet(i);
+  }
+
+  llvm::Error result = llvm::Error::success();
+  for (size_t i = 0; i < failures.size(); ++i)
+    if (failures[i].has_value())
+      result = llvm::joinErrors(
+          std::move(result),
+          llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                  "Binding argument set " + llvm::Twine(i) +
+                                      ": " + failures[i].value()));
+  return result;
+}
+} // anonymous namespace
+
+llvm::Error bindArgumentsBatch(
+    llvm::StringRef moduleInput, llvm::ArrayRef<std::string> payloadOutputPaths,
+    llvm::ArrayRef<ArgumentSource const *> argumentSets,
+    bool treatWarningsAsErrors, bool enableInMemoryInput,
+    std::vector<std::string> *inMemoryOutputs,
+    BindArgumentsImplementationFactory &factory,
+    const OptDiagnosticCallback &onDiagnostic, llvm::ThreadPool *threadPool,
+    bool emitOverlays) {
+  return bindBatch(moduleInput, payloadOutputPaths, argumentSets,
+                   /*columns=*/nullptr, treatWarningsAsErrors,
+                   enableInMemoryInput, inMemoryOutputs, factory, onDiagnostic,
+                   threadPool, emitOverlays);
+}
+
+llvm::Error bindArgumentColumns(
+    llvm::StringRef moduleInput, llvm::ArrayRef<std::string> payloadOutputPaths,
+    ColumnarArguments const &arguments, bool treatWarningsAsErrors,
+    bool enableInMemoryInput, std::vector<std::string> *inMemoryOutputs,
+    BindArgumentsImplementationFactory &factory,
+    const OptDiagnosticCallback &onDiagnostic, llvm::ThreadPool *threadPool,
+    bool emitOverlays) {
+  std::vector<ColumnarArguments::Point> points;
+  std::vector<ArgumentSource const *> argumentSets;
+  points.reserve(arguments.getNumPoints());
+  argumentSets.reserve(arguments.getNumPoints());
+  for (size_t point = 0; point < arguments.getNumPoints(); ++point)
+    argumentSets.push_back(&points.emplace_back(arguments.getPoint(point)));
+
+  return bindBatch(moduleInput, payloadOutputPaths, argumentSets, &arguments,
+                   treatWarningsAsErrors, enableInMemoryInput, inMemoryOutputs,
+                   factory, onDiagnostic, threadPool, emitOverlays);
+}
+
 } // namespace qssc::arguments
@@ -0,0 +1,129 @@
+//===- BindingPlan.cpp ------------------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements the BindingPlan of a circuit signature
+///
+//===----------------------------------------------------------------------===//
+
+#include "Arguments/BindingPlan.h"
+#include "Arguments/Arguments.h"
+#include "Arguments/Signature.h"
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/Twine.h"
+#include "llvm/Support/Error.h"
+
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <utility>
+#include <vector>
+
+using namespace qssc::arguments;
+
+BindingPlan::BindingPlan(Signature signature)
+    : signature(std::move(signature)) {
+  binaries.reserve(this->signature.patchPointsByBinary.size());
+  for (auto const &[binaryName, patchPoints] :
+       this->signature.patchPointsByBinary) {
+    auto &binary = binaries.emplace_back();
+    binary.name = binaryName;
+    binary.entries.reserve(patchPoints.size());
+    for (auto const &patchPoint : patchPoints) {
+      auto [pos, inserted] = parameterIndices.try_emplace(
+          patchPoint.expression(), parameterNames.size());
+      if (inserted)
+        parameterNames.emplace_back(patchPoint.expression());
+      binary.entries.push_back({patchPoint.offset(), pos->second, &patchPoint});
+    }
+  }
+}
+
+llvm::Expected<BindingPlan>
+BindingPlan::create(BinarySignatureView const &view) {
+  BindingPlan plan;
+  uint32_t const numPatchPoints = view.getNumPatchPoints();
+  uint32_t const numParameters = view.getNumParameters();
+
+  // invert the parameter entries of the view to find the parameter of each
+  // patch point
+  constexpr uint32_t unresolved = std::numeric_limits<uint32_t>::max();
+  std::vector<uint32_t> patchPointParameters(numPatchPoints, unresolved);
+  plan.parameterNames.reserve(numParameters);
+  for (uint32_t parameter = 0; parameter < numParameters; ++parameter) {
+    llvm::StringRef const name = view.getParameterName(parameter);
+    if (!plan.parameterIndices.try_emplace(name, parameter).second)
+      return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                     "Duplicate parameter " + name +
+                                         " in binary signature");
+    plan.parameterNames.emplace_back(name);
+    uint32_t const numEntries = view.getNumParameterPatchPoints(parameter);
+    for (uint32_t entry = 0; entry < numEntries; ++entry) {
+      uint32_t const patchPoint =
+          view.getParameterPatchPoint(parameter, entry);
+      if (patchPoint < numPatchPoints)
+        patchPointParameters[patchPoint] = parameter;
+    }
+  }
+
+  // entries point to the patch points, which are therefore never
+  // reallocated
+  plan.patchPoints.reserve(numPatchPoints);
+  plan.binaries.reserve(view.getNumBinaries());
+  for (uint32_t binary = 0; binary < view.getNumBinaries(); ++binary) {
+    auto &binaryPlan = plan.binaries.emplace_back();
+    binaryPlan.name = view.getBinaryName(binary).str();
+    uint64_t const first = view.getFirstPatchPoint(binary);
+    uint64_t const last = first + view.getNumPatchPoints(binary);
+    // binaries must cover consecutive ranges, so that no more patch points
+    // are added than have been reserved
+    if (first != plan.patchPoints.size() || last > numPatchPoints)
+      return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                     "Patch points of " + binaryPlan.name +
+                                         " are not grouped by binary in the "
+                                         "binary signature");
+    binaryPlan.entries.reserve(last - first);
+    for (uint64_t patchPoint = first; patchPoint < last; ++patchPoint) {
+      uint32_t const parameter = patchPointParameters[patchPoint];
+      if (parameter == unresolved)
+        return llvm::createStringError(
+            llvm::inconvertibleErrorCode(),
+            "Patch point " + llvm::Twine(patchPoint) +
+                " has no parameter in the binary signature");
+      auto const &added =
+          plan.patchPoints.emplace_back(view.getPatchPoint(patchPoint));
+      binaryPlan.entries.push_back({added.offset(), parameter, &added});
+    }
+  }
+  return plan;
+}
+
+std::optional<uint32_t>
+BindingPlan::lookupParameter(llvm::StringRef name) const {
+  auto pos = parameterIndices.find(name);
+  if (pos == parameterIndices.end())
+    return std::nullopt;
+  return pos->second;
+}
+
+std::vector<ArgumentType>
+BindingPlan::resolve(ArgumentSource const &arguments) const {
+  std::vector<ArgumentType> values;
+  values.reserve(parameterNames.size());
+  for (auto const &name : parameterNames)
+    values.push_back(arguments.getArgumentValue(name));
+  return values;
+}
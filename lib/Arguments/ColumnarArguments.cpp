@@ -0,0 +1,69 @@
+//===- ColumnarArguments.cpp ------------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements ColumnarArguments
+///
+//===----------------------------------------------------------------------===//
+
+#include "Arguments/ColumnarArguments.h"
+#include "Arguments/Arguments.h"
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/Twine.h"
+#include "llvm/Support/Error.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+using namespace qssc::arguments;
+
+ArgumentType
+ColumnarArguments::Point::getArgumentValue(llvm::StringRef name) const {
+  auto column = arguments_.getColumn(name);
+  if (!column.has_value())
+    return std::nullopt;
+  return (*column)[point_];
+}
+
+llvm::Expected<ColumnarArguments>
+ColumnarArguments::create(llvm::ArrayRef<std::string> parameterNames,
+                          llvm::ArrayRef<double> values, size_t numPoints) {
+  if (values.size() != parameterNames.size() * numPoints)
+    return llvm::createStringError(
+        llvm::inconvertibleErrorCode(),
+        "Expected " + llvm::Twine(parameterNames.size()) + " x " +
+            llvm::Twine(numPoints) + " argument values but got " +
+            llvm::Twine(values.size()));
+
+  ColumnarArguments arguments(values, numPoints);
+  for (uint32_t i = 0; i < parameterNames.size(); ++i)
+    if (!arguments.indices_.try_emplace(parameterNames[i], i).second)
+      return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                     "Duplicate parameter " +
+                                         parameterNames[i]);
+  return arguments;
+}
+
+std::optional<llvm::ArrayRef<double>>
+ColumnarArguments::getColumn(llvm::StringRef name) const {
+  auto pos = indices_.find(name);
+  if (pos == indices_.end())
+    return std::nullopt;
+  return values_.slice(pos->second * numPoints_, numPoints_);
+}
@@ -24,11 +24,16 @@
 #include "API/errors.h"
 
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/EndianStream.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/raw_ostream.h"
 
+#include <algorithm>
 #include <cstdint>
+#include <map>
 #include <optional>
 #include <sstream>
 #include <string>
@@ -37,6 +42,16 @@
 
 namespace qssc::arguments {
 
+namespace {
+constexpr llvm::StringLiteral binarySignatureMagic("QSSC_SIG");
+constexpr uint64_t headerSize = 32;
+constexpr uint64_t stringRecordSize = 8;
+constexpr uint64_t binaryRecordSize = 12;
+constexpr uint64_t patchPointRecordSize = 24;
+constexpr uint64_t parameterRecordSize = 12;
+constexpr uint64_t entryRecordSize = 4;
+} // anonymous namespace
+
 void Signature::addParameterPatchPoint(llvm::StringRef expression,
                                        llvm::StringRef patchType,
                                        llvm::StringRef binaryComponent,
@@ -86,11 +101,104 @@ std::string Signature::serialize() {
   return s.str();
 }
 
+std::string Signature::serializeBinary() const {
+  // intern strings in order of first use
+  llvm::StringMap<uint32_t> stringIds;
+  std::vector<llvm::StringRef> strings;
+  auto intern = [&](llvm::StringRef str) -> uint32_t {
+    auto [pos, inserted] = stringIds.try_emplace(str, strings.size());
+    if (inserted)
+      strings.push_back(pos->first());
+    return pos->second;
+  };
+
+  uint32_t numPatchPoints = 0;
+  std::map<llvm::StringRef, std::vector<uint32_t>> patchPointsByParameter;
+  for (auto const &[binaryName, patchPoints] : patchPointsByBinary) {
+    intern(binaryName);
+    for (auto const &patchPoint : patchPoints) {
+      intern(patchPoint.expression());
+      intern(patchPoint.patchType());
+      patchPointsByParameter[patchPoint.expression()].push_back(
+          numPatchPoints++);
+    }
+  }
+
+  std::string out;
+  llvm::raw_string_ostream stream(out);
+  llvm::support::endian::Writer writer(stream, llvm::support::little);
+
+  uint32_t stringDataSize = 0;
+  for (auto str : strings)
+    stringDataSize += str.size();
+
+  stream << binarySignatureMagic;
+  writer.write<uint32_t>(BinarySignatureView::version);
+  writer.write<uint32_t>(strings.size());
+  writer.write<uint32_t>(patchPointsByBinary.size());
+  writer.write<uint32_t>(numPatchPoints);
+  writer.write<uint32_t>(patchPointsByParameter.size());
+  writer.write<uint32_t>(stringDataSize);
+
+  uint32_t stringOffset = 0;
+  for (auto str : strings) {
+    writer.write<uint32_t>(stringOffset);
+    writer.write<uint32_t>(str.size());
+    stringOffset += str.size();
+  }
+
+  uint32_t firstPatchPoint = 0;
+  for (auto const &[binaryName, patchPoints] : patchPointsByBinary) {
+    writer.write<uint32_t>(stringIds.lookup(binaryName));
+    writer.write<uint32_t>(firstPatchPoint);
+    writer.write<uint32_t>(patchPoints.size());
+    firstPatchPoint += patchPoints.size();
+  }
+
+  uint32_t binary = 0;
+  for (auto const &[binaryName, patchPoints] : patchPointsByBinary) {
+    for (auto const &patchPoint : patchPoints) {
+      writer.write<uint64_t>(patchPoint.offset());
+      writer.write<uint32_t>(stringIds.lookup(patchPoint.expression()));
+      writer.write<uint32_t>(stringIds.lookup(patchPoint.patchType()));
+      writer.write<uint32_t>(binary);
+      writer.write<uint32_t>(0);
+    }
+    ++binary;
+  }
+
+  uint32_t firstEntry = 0;
+  for (auto const &[expression, entries] : patchPointsByParameter) {
+    writer.write<uint32_t>(stringIds.lookup(expression));
+    writer.write<uint32_t>(firstEntry);
+    writer.write<uint32_t>(entries.size());
+    firstEntry += entries.size();
+  }
+  for (auto const &[expression, entries] : patchPointsByParameter)
+    for (auto entry : entries)
+      writer.write<uint32_t>(entry);
+
+  for (auto str : strings)
+    stream << str;
+
+  stream.flush();
+  return out;
+}
+
 llvm::Expected<Signature> Signature::deserialize(
     llvm::StringRef buffer,
     const std::optional<qssc::DiagnosticCallback> &onDiagnostic,
     bool treatWarningsAsErrors) {
 
+  if (BinarySignatureView::isBinarySignature(buffer)) {
+    auto view = BinarySignatureView::create(buffer);
+    if (!view)
+      return emitDiagnostic(onDiagnostic, qssc::Severity::Error,
+                            qssc::ErrorCategory::QSSLinkSignatureError,
+                            toString(view.takeError()));
+    return view->toSignature();
+  }
+
   Signature sig;
 
   llvm::StringRef line;
@@ -192,4 +300,176 @@ llvm::Expected<Signature> Signature::deserialize(
   return sig;
 }
 
+bool BinarySignatureView::isBinarySignature(llvm::StringRef buffer) {
+  return buffer.startswith(binarySignatureMagic);
+}
+
+llvm::Expected<BinarySignatureView>
+BinarySignatureView::create(llvm::StringRef buffer) {
+  using llvm::support::endian::read32le;
+
+  if (buffer.size() < headerSize || !isBinarySignature(buffer))
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "Invalid binary signature header");
+
+  const char *header = buffer.data() + binarySignatureMagic.size();
+  if (read32le(header) != version)
+    return llvm::createStringError(
+        llvm::inconvertibleErrorCode(),
+        "Invalid binary signature version: " +
+            std::to_string(read32le(header)));
+
+  BinarySignatureView view;
+  view.buffer = buffer;
+  view.numStrings = read32le(header + 4);
+  view.numBinaries = read32le(header + 8);
+  view.numPatchPoints = read32le(header + 12);
+  view.numParameters = read32le(header + 16);
+  view.stringDataSize = read32le(header + 20);
+
+  view.stringsOffset = headerSize;
+  view.binariesOffset =
+      view.stringsOffset + view.numStrings * stringRecordSize;
+  view.patchPointsOffset =
+      view.binariesOffset + view.numBinaries * binaryRecordSize;
+  view.parametersOffset =
+      view.patchPointsOffset + view.numPatchPoints * patchPointRecordSize;
+  view.entriesOffset =
+      view.parametersOffset + view.numParameters * parameterRecordSize;
+  view.stringDataOffset =
+      view.entriesOffset + view.numPatchPoints * entryRecordSize;
+  if (view.stringDataOffset + view.stringDataSize != buffer.size())
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "Invalid binary signature size");
+  return view;
+}
+
+uint32_t BinarySignatureView::readField(uint64_t sectionOffset,
+                                        uint64_t recordSize, uint32_t record,
+                                        uint32_t field) const {
+  return llvm::support::endian::read32le(
+      buffer.data() + sectionOffset + record * recordSize + field * 4);
+}
+
+llvm::StringRef BinarySignatureView::getString(uint32_t index) const {
+  if (index >= numStrings)
+    return {};
+  uint64_t const offset = readField(stringsOffset, stringRecordSize, index, 0);
+  uint64_t const size = readField(stringsOffset, stringRecordSize, index, 1);
+  if (offset + size > stringDataSize)
+    return {};
+  return buffer.substr(stringDataOffset + offset, size);
+}
+
+llvm::StringRef BinarySignatureView::getBinaryName(uint32_t binary) const {
+  if (binary >= numBinaries)
+    return {};
+  return getString(readField(binariesOffset, binaryRecordSize, binary, 0));
+}
+
+uint32_t BinarySignatureView::getFirstPatchPoint(uint32_t binary) const {
+  if (binary >= numBinaries)
+    return numPatchPoints;
+  return readField(binariesOffset, binaryRecordSize, binary, 1);
+}
+
+uint32_t BinarySignatureView::getNumPatchPoints(uint32_t binary) const {
+  if (binary >= numBinaries)
+    return 0;
+  return readField(binariesOffset, binaryRecordSize, binary, 2);
+}
+
+uint64_t BinarySignatureView::getPatchPointOffset(uint32_t patchPoint) const {
+  if (patchPoint >= numPatchPoints)
+    return 0;
+  return llvm::support::endian::read64le(
+      buffer.data() + patchPointsOffset + patchPoint * patchPointRecordSize);
+}
+
+llvm::StringRef
+BinarySignatureView::getPatchPointExpression(uint32_t patchPoint) const {
+  if (patchPoint >= numPatchPoints)
+    return {};
+  return getString(
+      readField(patchPointsOffset, patchPointRecordSize, patchPoint, 2));
+}
+
+llvm::StringRef
+BinarySignatureView::getPatchPointType(uint32_t patchPoint) const {
+  if (patchPoint >= numPatchPoints)
+    return {};
+  return getString(
+      readField(patchPointsOffset, patchPointRecordSize, patchPoint, 3));
+}
+
+uint32_t BinarySignatureView::getPatchPointBinary(uint32_t patchPoint) const {
+  if (patchPoint >= numPatchPoints)
+    return numBinaries;
+  return readField(patchPointsOffset, patchPointRecordSize, patchPoint, 4);
+}
+
+PatchPoint BinarySignatureView::getPatchPoint(uint32_t patchPoint) const {
+  return {getPatchPointExpression(patchPoint), getPatchPointType(patchPoint),
+          getPatchPointOffset(patchPoint)};
+}
+
+llvm::StringRef
+BinarySignatureView::getParameterName(uint32_t parameter) const {
+  if (parameter >= numParameters)
+    return {};
+  return getString(
+      readField(parametersOffset, parameterRecordSize, parameter, 0));
+}
+
+std::optional<uint32_t>
+BinarySignatureView::findParameter(llvm::StringRef expression) const {
+  uint32_t low = 0;
+  uint32_t high = numParameters;
+  while (low < high) {
+    uint32_t const mid = low + (high - low) / 2;
+    int const cmp = getParameterName(mid).compare(expression);
+    if (cmp == 0)
+      return mid;
+    if (cmp < 0)
+      low = mid + 1;
+    else
+      high = mid;
+  }
+  return std::nullopt;
+}
+
+uint32_t
+BinarySignatureView::getNumParameterPatchPoints(uint32_t parameter) const {
+  if (parameter >= numParameters)
+    return 0;
+  return readField(parametersOffset, parameterRecordSize, parameter, 2);
+}
+
+uint32_t BinarySignatureView::getParameterPatchPoint(uint32_t parameter,
+                                                     uint32_t entry) const {
+  if (parameter >= numParameters)
+    return numPatchPoints;
+  uint64_t const index =
+      readField(parametersOffset, parameterRecordSize, parameter, 1) +
+      uint64_t{entry};
+  if (index >= numPatchPoints)
+    return numPatchPoints;
+  return readField(entriesOffset, entryRecordSize, index, 0);
+}
+
+Signature BinarySignatureView::toSignature() const {
+  Signature sig;
+  for (uint32_t binary = 0; binary < numBinaries; ++binary) {
+    auto &patchPoints = sig.patchPointsByBinary[getBinaryName(binary).str()];
+    // clamp the range of malformed records to the patch point section
+    uint64_t const first = std::min(getFirstPatchPoint(binary), numPatchPoints);
+    uint64_t const last =
+        std::min<uint64_t>(first + getNumPatchPoints(binary), numPatchPoints);
+    patchPoints.reserve(patchPoints.size() + (last - first));
+    for (uint64_t patchPoint = first; patchPoint < last; ++patchPoint)
+      patchPoints.push_back(getPatchPoint(patchPoint));
+  }
+  return sig;
+}
+
 } // namespace qssc::arguments
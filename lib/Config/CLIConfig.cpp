@@ -170,6 +170,27 @@ struct QSSConfigCLOptions : public QSSConfig {
         llvm::cl::location(emitPlaintextPayloadFlag), llvm::cl::init(false),
         llvm::cl::cat(qssc::config::getQSSCCLCategory()));
 
+    static llvm::cl::opt<bool, /*ExternalStorage=*/true> const streamPayload(
+        "stream-payload",
+        llvm::cl::desc(
+            "Stream payload files to the output as each target finishes "
+            "emitting. Members are ordered by completion, which may differ "
+            "between runs, and a file may not be written again once the "
+            "target that created it has finished emitting. Ignored for "
+            "plaintext payloads."),
+        llvm::cl::location(streamPayloadFlag), llvm::cl::init(false),
+        llvm::cl::cat(qssc::config::getQSSCCLCategory()));
+
+    static llvm::cl::opt<std::string, /*ExternalStorage=*/true> const
+        payloadCompression_(
+            "payload-compression",
+            llvm::cl::desc("Comma separated <glob>=<store|deflate|zstd> rules "
+                           "selecting the compression of payload files. "
+                           "Unmatched files are stored uncompressed."),
+            llvm::cl::value_desc("rules"),
+            llvm::cl::location(payloadCompression), llvm::cl::init(""),
+            llvm::cl::cat(qssc::config::getQSSCCLCategory()));
+
     static llvm::cl::opt<bool, /*ExternalStorage=*/true> const includeSource(
         "include-source",
         llvm::cl::desc("Write the input source into the payload"),
@@ -378,6 +399,10 @@ struct QSSConfigCLOptions : public QSSConfig {
             << "Warning! The output type in the file extension doesn't "
                "match the output type specified by --emit!";
       }
+      // MLIR output files with the bytecode extension are written as bytecode
+      if (getEmitAction() == EmitAction::MLIR &&
+          getOutputFilePath().endswith_insensitive(".mlirbc"))
+        emitBytecode(true);
     } else {
       if (emitAction == EmitAction::None)
         setEmitAction(EmitAction::MLIR);
@@ -437,6 +462,8 @@ llvm::Error CLIConfigBuilder::populateConfig(QSSConfig &config) {
   config.showPayloadsFlag = clOptionsConfig->showPayloadsFlag;
   config.showConfigFlag = clOptionsConfig->showConfigFlag;
   config.emitPlaintextPayloadFlag = clOptionsConfig->emitPlaintextPayloadFlag;
+  config.streamPayloadFlag = clOptionsConfig->streamPayloadFlag;
+  config.payloadCompression = clOptionsConfig->payloadCompression;
   config.includeSourceFlag = clOptionsConfig->includeSourceFlag;
   config.compileTargetIRFlag = clOptionsConfig->compileTargetIRFlag;
   config.bypassPayloadTargetCompilationFlag =
@@ -453,6 +480,7 @@ llvm::Error CLIConfigBuilder::populateConfig(QSSConfig &config) {
       clOptionsConfig->allowUnregisteredDialectsFlag;
   config.dumpPassPipelineFlag = clOptionsConfig->dumpPassPipelineFlag;
   config.emitBytecodeFlag = clOptionsConfig->emitBytecodeFlag;
+  config.emitBytecodeVersion = clOptionsConfig->emitBytecodeVersion;
   config.irdlFileFlag = clOptionsConfig->irdlFileFlag;
   config.enableDebuggerActionHookFlag =
       clOptionsConfig->enableDebuggerActionHookFlag;
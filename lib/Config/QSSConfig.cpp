@@ -30,6 +30,8 @@
 #include "llvm/Support/raw_ostream.h"
 
 #include <array>
+#include <memory>
+#include <mutex>
 #include <ostream>
 #include <string>
 #include <utility>
@@ -69,6 +71,8 @@ void qssc::config::QSSConfig::emit(llvm::raw_ostream &os) const {
   os << "showPayloads: " << shouldShowPayloads() << "\n";
   os << "showConfig: " << shouldShowConfig() << "\n";
   os << "emitPlaintextPayload: " << shouldEmitPlaintextPayload() << "\n";
+  os << "streamPayload: " << shouldStreamPayload() << "\n";
+  os << "payloadCompression: " << getPayloadCompression() << "\n";
   os << "includeSource: " << shouldIncludeSource() << "\n";
   os << "compileTargetIR: " << shouldCompileTargetIR() << "\n";
   os << "bypassPayloadTargetCompilation: "
@@ -111,27 +115,48 @@ namespace {
 /// QUESTION: Rather than a global registry it seems like it would be much
 /// better to inherit the MLIRContext as QSSContext and set the configuration on
 /// this? Alternatively the QSSContext could own the MLIRContext?
-static llvm::ManagedStatic<llvm::DenseMap<mlir::MLIRContext *, QSSConfig>>
-    contextConfigs{};
+struct ContextConfigRegistry {
+  /// Guards the registry as contexts may be compiled with concurrently.
+  std::mutex mutex;
+  /// Configurations are heap allocated so that references handed out remain
+  /// valid while other contexts are registered.
+  llvm::DenseMap<mlir::MLIRContext *, std::unique_ptr<QSSConfig>> configs;
+};
+
+static llvm::ManagedStatic<ContextConfigRegistry> contextConfigs{};
 
 } // anonymous namespace
 
 void qssc::config::setContextConfig(mlir::MLIRContext *context,
                                     const QSSConfig &config) {
-  (*contextConfigs)[context] = config;
+  // NOLINTNEXTLINE(clang-diagnostic-ctad-maybe-unsupported)
+  std::lock_guard const lock(contextConfigs->mutex);
+  auto &entry = contextConfigs->configs[context];
+  if (entry)
+    *entry = config;
+  else
+    entry = std::make_unique<QSSConfig>(config);
 }
 
 llvm::Expected<const QSSConfig &>
 qssc::config::getContextConfig(mlir::MLIRContext *context) {
-  auto it = contextConfigs->find(context);
-  if (it != contextConfigs->end())
-    return it->getSecond();
+  // NOLINTNEXTLINE(clang-diagnostic-ctad-maybe-unsupported)
+  std::lock_guard const lock(contextConfigs->mutex);
+  auto it = contextConfigs->configs.find(context);
+  if (it != contextConfigs->configs.end())
+    return *it->getSecond();
 
   return llvm::createStringError(
       llvm::inconvertibleErrorCode(),
       "Error: no config registered for the given context.\n");
 }
 
+void qssc::config::releaseContextConfig(mlir::MLIRContext *context) {
+  // NOLINTNEXTLINE(clang-diagnostic-ctad-maybe-unsupported)
+  std::lock_guard const lock(contextConfigs->mutex);
+  contextConfigs->configs.erase(context);
+}
+
 llvm::Expected<QSSConfig> QSSConfigBuilder::buildConfig() {
   QSSConfig config;
   if (auto e = populateConfig(config))
@@ -260,7 +285,8 @@ FileExtension qssc::config::strToFileExtension(const llvm::StringRef extStr) {
     return FileExtension::ASTPretty;
   if (extStr == "qasm" || extStr == "QASM")
     return FileExtension::QASM;
-  if (extStr == "mlir" || extStr == "MLIR")
+  if (extStr == "mlir" || extStr == "MLIR" || extStr == "mlirbc" ||
+      extStr == "MLIRBC")
     return FileExtension::MLIR;
   if (extStr == "wmem" || extStr == "WMEM")
     return FileExtension::WaveMem;
@@ -0,0 +1,171 @@
+//===- GateDefinitionCache.cpp ----------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements the cache of the QUIR definitions generated for
+///  OpenQASM 3 gate declarations.
+///
+//===----------------------------------------------------------------------===//
+
+#include "Frontend/OpenQASM3/GateDefinitionCache.h"
+
+#include "mlir/Bytecode/BytecodeReader.h"
+#include "mlir/Bytecode/BytecodeWriter.h"
+#include "mlir/IR/AsmState.h"
+#include "mlir/IR/Block.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/Diagnostics.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/Support/LogicalResult.h"
+
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Support/xxhash.h"
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+
+using namespace qssc::frontend::openqasm3;
+
+GateDefinitionCache &GateDefinitionCache::instance() {
+  static GateDefinitionCache cache;
+  return cache;
+}
+
+uint64_t GateDefinitionCache::computeHash(llvm::StringRef key) {
+  return llvm::xxh3_64bits(llvm::arrayRefFromStringRef(key));
+}
+
+std::string GateDefinitionCache::getPath(llvm::StringRef directory,
+                                         uint64_t hash) {
+  llvm::SmallString<128> path(directory);
+  llvm::sys::path::append(path, llvm::formatv("{0:x-16}.mlirbc", hash).str());
+  return std::string(path);
+}
+
+std::shared_ptr<const GateDefinitionCache::Definition>
+GateDefinitionCache::deserialize(llvm::StringRef file) {
+  if (file.size() < sizeof(uint64_t))
+    return nullptr;
+  uint64_t const keySize = llvm::support::endian::read64le(file.data());
+  file = file.drop_front(sizeof(uint64_t));
+  if (keySize > file.size())
+    return nullptr;
+  return std::make_shared<const Definition>(
+      Definition{file.take_front(keySize).str(),
+                 file.drop_front(keySize).str()});
+}
+
+void GateDefinitionCache::serialize(llvm::raw_ostream &os,
+                                    Definition const &definition) {
+  char keySize[sizeof(uint64_t)];
+  llvm::support::endian::write64le(keySize, definition.key.size());
+  os.write(keySize, sizeof(keySize));
+  os << definition.key << definition.bytecode;
+}
+
+mlir::Operation *GateDefinitionCache::lookup(llvm::StringRef key,
+                                             mlir::OpBuilder &builder,
+                                             llvm::StringRef directory) {
+  uint64_t const hash = computeHash(key);
+  std::shared_ptr<const Definition> definition;
+  {
+    // NOLINTNEXTLINE(clang-diagnostic-ctad-maybe-unsupported)
+    std::lock_guard const lock(mutex);
+    auto pos = definitions.find(hash);
+    if (pos != definitions.end())
+      definition = pos->second;
+  }
+
+  if ((!definition || definition->key != key) && !directory.empty()) {
+    auto file = llvm::MemoryBuffer::getFile(getPath(directory, hash),
+                                            /*IsText=*/false,
+                                            /*RequiresNullTerminator=*/false);
+    if (!file)
+      return nullptr;
+    definition = deserialize(file.get()->getBuffer());
+    // definitions of colliding keys are not cached in memory
+    if (definition && definition->key == key) {
+      // NOLINTNEXTLINE(clang-diagnostic-ctad-maybe-unsupported)
+      std::lock_guard const lock(mutex);
+      definitions.try_emplace(hash, definition);
+    }
+  }
+  if (!definition || definition->key != key)
+    return nullptr;
+
+  // Definitions that cannot be read, e.g., those persisted by another
+  // version of the compiler, are misses rather than errors.
+  mlir::ScopedDiagnosticHandler const ignoreDiagnostics(
+      builder.getContext(),
+      [](mlir::Diagnostic &) { return mlir::success(); });
+
+  mlir::Block block;
+  mlir::ParserConfig const config(builder.getContext());
+  if (mlir::failed(mlir::readBytecodeFile(
+          llvm::MemoryBufferRef(definition->bytecode, "gate-definition"),
+          &block, config)) ||
+      !llvm::hasSingleElement(block))
+    return nullptr;
+
+  mlir::Operation *op = &block.front();
+  op->remove();
+  builder.insert(op);
+  return op;
+}
+
+void GateDefinitionCache::insert(llvm::StringRef key,
+                                 mlir::Operation *definition,
+                                 llvm::StringRef directory) {
+  auto entry = std::make_shared<Definition>();
+  entry->key = key.str();
+  llvm::raw_string_ostream stream(entry->bytecode);
+  if (mlir::failed(mlir::writeBytecodeToFile(definition, stream)))
+    return;
+  stream.flush();
+
+  uint64_t const hash = computeHash(key);
+  if (!directory.empty() && !llvm::sys::fs::create_directories(directory)) {
+    // written to a temporary file first, so that concurrent compilations
+    // never read a partially written definition
+    llvm::consumeError(llvm::writeToOutput(
+        getPath(directory, hash), [&](llvm::raw_ostream &os) {
+          serialize(os, *entry);
+          return llvm::Error::success();
+        }));
+  }
+
+  // NOLINTNEXTLINE(clang-diagnostic-ctad-maybe-unsupported)
+  std::lock_guard const lock(mutex);
+  definitions[hash] = std::move(entry);
+}
+
+void GateDefinitionCache::clear() {
+  // NOLINTNEXTLINE(clang-diagnostic-ctad-maybe-unsupported)
+  std::lock_guard const lock(mutex);
+  definitions.clear();
+}
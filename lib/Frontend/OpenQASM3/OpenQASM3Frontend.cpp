@@ -31,13 +31,14 @@
 #include "mlir/IR/Builders.h"
 #include "mlir/IR/BuiltinOps.h"
 #include "mlir/IR/Verifier.h"
-#include "mlir/Support/FileUtilities.h"
 #include "mlir/Support/LogicalResult.h"
 #include "mlir/Support/Timing.h"
 
+#include "llvm/ADT/StringSet.h"
 #include "llvm/ADT/Twine.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Error.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/SMLoc.h"
 #include "llvm/Support/SourceMgr.h"
@@ -83,11 +84,132 @@ llvm::cl::list<std::string>
     includeDirs("I", llvm::cl::desc("Add <dir> to the include path"),
                 llvm::cl::value_desc("dir"), llvm::cl::cat(openqasm3Cat));
 
-qssc::DiagnosticCallback *diagnosticCallback_;
-llvm::SourceMgr *sourceMgr_;
-
+/// State of a single parse that the diagnostic handler of qss-qasm, which
+/// cannot capture it, needs to forward diagnostics
+struct ParseDiagnostics {
+  qssc::DiagnosticCallback *callback;
+  llvm::SourceMgr sourceMgr;
+  /// Input file that is loaded into sourceMgr on the first diagnostic. Only
+  /// diagnostics need the source, so large inputs are not held in memory
+  /// next to the AST while parsing succeeds.
+  std::optional<std::string> sourceFile;
+
+  llvm::SourceMgr &getSourceMgr() {
+    if (sourceFile) {
+      if (auto file = llvm::MemoryBuffer::getFile(*sourceFile))
+        sourceMgr.AddNewSourceBuffer(std::move(*file), llvm::SMLoc());
+      sourceFile.reset();
+    }
+    return sourceMgr;
+  }
+};
+
+/// The parse in progress on this thread, if any
+thread_local ParseDiagnostics *currentParse = nullptr;
+
+/// Make diagnostics available to the diagnostic handler for the lifetime of
+/// this object
+class ScopedParseDiagnostics {
+public:
+  explicit ScopedParseDiagnostics(ParseDiagnostics &diagnostics)
+      : previous(currentParse) {
+    currentParse = &diagnostics;
+  }
+  ScopedParseDiagnostics(const ScopedParseDiagnostics &) = delete;
+  ScopedParseDiagnostics &operator=(const ScopedParseDiagnostics &) = delete;
+  ~ScopedParseDiagnostics() { currentParse = previous; }
+
+private:
+  ParseDiagnostics *previous;
+};
+
+/// qss-qasm keeps the preprocessor, the statement builder, the symbol tables
+/// and the diagnostic handler in process-wide singletons, so parsing and
+/// walking the resulting AST must be serialized. Everything else a parse
+/// does, i.e., reading the input and verifying the generated IR, runs
+/// outside of this lock.
 std::mutex qasmParserLock;
 
+/// Include paths registered with the qss-qasm preprocessor so far, which
+/// keeps its include path list from growing with each parse. Guarded by
+/// qasmParserLock.
+llvm::StringSet<> registeredIncludeDirs;
+
+void handleDiagnostic(const std::string &File, QASM::ASTLocation Loc, // NOLINT
+                      const std::string &Msg,
+                      QASM::QasmDiagnosticEmitter::DiagLevel DL) {
+  std::string level = "unknown";
+  qssc::Severity diagLevel = qssc::Severity::Error;
+  llvm::SourceMgr::DiagKind sourceMgrDiagKind =
+      llvm::SourceMgr::DiagKind::DK_Error;
+
+  switch (DL) {
+  case QASM::QasmDiagnosticEmitter::DiagLevel::Error:
+    level = "Error";
+    diagLevel = qssc::Severity::Error;
+    sourceMgrDiagKind = llvm::SourceMgr::DiagKind::DK_Error;
+    break;
+
+  case QASM::QasmDiagnosticEmitter::DiagLevel::ICE:
+    level = "ICE";
+    diagLevel = qssc::Severity::Fatal;
+    sourceMgrDiagKind = llvm::SourceMgr::DiagKind::DK_Error;
+    break;
+
+  case QASM::QasmDiagnosticEmitter::DiagLevel::Warning:
+    level = "Warning";
+    diagLevel = qssc::Severity::Warning;
+    sourceMgrDiagKind = llvm::SourceMgr::DiagKind::DK_Warning;
+    break;
+
+  case QASM::QasmDiagnosticEmitter::DiagLevel::Info:
+    level = "Info";
+    diagLevel = qssc::Severity::Info;
+    sourceMgrDiagKind = llvm::SourceMgr::DiagKind::DK_Remark;
+    break;
+
+  case QASM::QasmDiagnosticEmitter::DiagLevel::Status:
+    level = "Status";
+    diagLevel = qssc::Severity::Info;
+    sourceMgrDiagKind = llvm::SourceMgr::DiagKind::DK_Note;
+    break;
+  }
+
+  // Capture source context for including it in error messages
+  assert(currentParse);
+  auto &sourceMgr = currentParse->getSourceMgr();
+  std::string sourceString;
+  llvm::raw_string_ostream stringStream(sourceString);
+
+  if (sourceMgr.getNumBuffers() != 0) {
+    auto loc = sourceMgr.FindLocForLineAndColumn(1, Loc.LineNo, Loc.ColNo);
+    sourceMgr.PrintMessage(stringStream, loc, sourceMgrDiagKind, "");
+  }
+
+  std::stringstream fileLoc;
+  fileLoc << "File: " << File << ", Line: " << Loc.LineNo
+          << ", Col: " << Loc.ColNo;
+
+  llvm::errs() << level << " while parsing OpenQASM 3 input\n"
+               << fileLoc.str() << " " << Msg << "\n"
+               << sourceString << "\n";
+
+  if (currentParse->callback) {
+    qssc::Diagnostic const diag{diagLevel,
+                                qssc::ErrorCategory::OpenQASM3ParseFailure,
+                                fileLoc.str() + "\n" + Msg + "\n" +
+                                    sourceString};
+    (*currentParse->callback)(diag);
+  }
+
+  if (DL == QASM::QasmDiagnosticEmitter::DiagLevel::Error ||
+      DL == QASM::QasmDiagnosticEmitter::DiagLevel::ICE) {
+    // give up parsing after errors right away
+    // TODO: update to recent qss-qasm to support continuing
+    throw std::runtime_error("Failure parsing");
+  }
+}
+
 std::regex durationRe("^([0-9]*[.]?[0-9]+)([a-zA-Z]*)");
 
 llvm::Expected<std::pair<double, mlir::quir::TimeUnits>>
@@ -123,150 +245,97 @@ llvm::Error qssc::frontend::openqasm3::parse(
     std::optional<qssc::DiagnosticCallback> diagnosticCallback,
     mlir::TimingScope &timing) {
 
-  mlir::TimingScope qasm3ParseTiming = timing.nest("parse-qasm3");
-
-  // The QASM parser can only be called from a single thread.
-  std::lock_guard<std::mutex> const qasmParserLockGuard(qasmParserLock);
+  // Check the input and prepare the module before taking the parser lock.
+  ParseDiagnostics diagnostics{
+      diagnosticCallback.has_value() ? &diagnosticCallback.value() : nullptr,
+      llvm::SourceMgr(), std::nullopt};
+  if (sourceIsFilename) {
+    // The parser reads the input file itself, so it is loaded for
+    // diagnostics only once needed.
+    if (auto ec = llvm::sys::fs::access(source,
+                                        llvm::sys::fs::AccessMode::Exist))
+      return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                     "Failed to open input file: " + source +
+                                         ": " + ec.message());
+    diagnostics.sourceFile = source;
+  } else {
+    auto sourceBuffer = llvm::MemoryBuffer::getMemBuffer(source, "", false);
+
+    diagnostics.sourceMgr.AddNewSourceBuffer(std::move(sourceBuffer),
+                                             llvm::SMLoc());
+  }
 
-  for (const auto &dirStr : includeDirs)
-    QASM::QasmPreprocessor::Instance().AddIncludePath(dirStr);
+  std::pair<double, mlir::quir::TimeUnits> shotDelayDuration;
+  if (emitMLIR) {
+    auto result = parseDurationStr(shotDelay);
+    if (auto err = result.takeError())
+      return err;
+    shotDelayDuration = *result;
 
-  QASM::ASTParser parser;
-  auto root = std::unique_ptr<QASM::ASTRoot>(nullptr);
-  llvm::SourceMgr sourceMgr;
+    auto *context = newModule.getContext();
 
-  // Add a callback for diagnostics to the parser. Since the callback needs
-  // access to diagnosticCallback to forward diagnostics, make it available in a
-  // global variable.
-  diagnosticCallback_ =
-      diagnosticCallback.has_value() ? &diagnosticCallback.value() : nullptr;
-  sourceMgr_ = &sourceMgr;
-
-  QASM::QasmDiagnosticEmitter::SetHandler(
-      [](const std::string &File, QASM::ASTLocation Loc, // NOLINT
-         const std::string &Msg, QASM::QasmDiagnosticEmitter::DiagLevel DL) {
-        std::string level = "unknown";
-        qssc::Severity diagLevel = qssc::Severity::Error;
-        llvm::SourceMgr::DiagKind sourceMgrDiagKind =
-            llvm::SourceMgr::DiagKind::DK_Error;
-
-        switch (DL) {
-        case QASM::QasmDiagnosticEmitter::DiagLevel::Error:
-          level = "Error";
-          diagLevel = qssc::Severity::Error;
-          sourceMgrDiagKind = llvm::SourceMgr::DiagKind::DK_Error;
-          break;
-
-        case QASM::QasmDiagnosticEmitter::DiagLevel::ICE:
-          level = "ICE";
-          diagLevel = qssc::Severity::Fatal;
-          sourceMgrDiagKind = llvm::SourceMgr::DiagKind::DK_Error;
-          break;
-
-        case QASM::QasmDiagnosticEmitter::DiagLevel::Warning:
-          level = "Warning";
-          diagLevel = qssc::Severity::Warning;
-          sourceMgrDiagKind = llvm::SourceMgr::DiagKind::DK_Warning;
-          break;
-
-        case QASM::QasmDiagnosticEmitter::DiagLevel::Info:
-          level = "Info";
-          diagLevel = qssc::Severity::Info;
-          sourceMgrDiagKind = llvm::SourceMgr::DiagKind::DK_Remark;
-          break;
-
-        case QASM::QasmDiagnosticEmitter::DiagLevel::Status:
-          level = "Status";
-          diagLevel = qssc::Severity::Info;
-          sourceMgrDiagKind = llvm::SourceMgr::DiagKind::DK_Note;
-          break;
-        }
-
-        // Capture source context for including it in error messages
-        assert(sourceMgr_);
-        auto &sourceMgr = *sourceMgr_;
-        auto loc = sourceMgr.FindLocForLineAndColumn(1, Loc.LineNo, Loc.ColNo);
-        std::string sourceString;
-        llvm::raw_string_ostream stringStream(sourceString);
-
-        sourceMgr.PrintMessage(stringStream, loc, sourceMgrDiagKind, "");
-
-        std::stringstream fileLoc;
-        fileLoc << "File: " << File << ", Line: " << Loc.LineNo
-                << ", Col: " << Loc.ColNo;
-
-        llvm::errs() << level << " while parsing OpenQASM 3 input\n"
-                     << fileLoc.str() << " " << Msg << "\n"
-                     << sourceString << "\n";
-
-        if (diagnosticCallback_) {
-          qssc::Diagnostic const diag{
-              diagLevel, qssc::ErrorCategory::OpenQASM3ParseFailure,
-              fileLoc.str() + "\n" + Msg + "\n" + sourceString};
-          (*diagnosticCallback_)(diag);
-        }
-
-        if (DL == QASM::QasmDiagnosticEmitter::DiagLevel::Error ||
-            DL == QASM::QasmDiagnosticEmitter::DiagLevel::ICE) {
-          // give up parsing after errors right away
-          // TODO: update to recent qss-qasm to support continuing
-          throw std::runtime_error("Failure parsing");
-        }
-      });
-
-  try {
-    if (sourceIsFilename) {
-      QASM::QasmPreprocessor::Instance().SetTranslationUnit(source);
-
-      std::string errorMessage;
-      auto file = mlir::openInputFile(source, &errorMessage);
-
-      if (!file)
-        return llvm::createStringError(llvm::inconvertibleErrorCode(),
-                                       "Failed to open input file: " +
-                                           errorMessage);
-
-      sourceMgr.AddNewSourceBuffer(std::move(file), llvm::SMLoc());
-
-      root.reset(parser.ParseAST());
-
-    } else {
-      auto sourceBuffer = llvm::MemoryBuffer::getMemBuffer(source, "", false);
-
-      sourceMgr.AddNewSourceBuffer(std::move(sourceBuffer), llvm::SMLoc());
-      root.reset(parser.ParseAST(source));
-    }
-  } catch (std::exception &e) {
-    return llvm::createStringError(
-        llvm::inconvertibleErrorCode(),
-        llvm::Twine{"Exception while parsing OpenQASM 3 input: "} + e.what());
+    context->loadDialect<mlir::quir::QUIRDialect>();
+    context->loadDialect<mlir::complex::ComplexDialect>();
+    context->loadDialect<mlir::func::FuncDialect>();
   }
 
-  qasm3ParseTiming.stop();
+  {
+    mlir::TimingScope waitTiming = timing.nest("wait-for-qasm3-parser");
+    // NOLINTNEXTLINE(clang-diagnostic-ctad-maybe-unsupported)
+    std::lock_guard const qasmParserLockGuard(qasmParserLock);
+    waitTiming.stop();
+
+    mlir::TimingScope qasm3ParseTiming = timing.nest("parse-qasm3");
+
+    for (const auto &dirStr : includeDirs)
+      if (registeredIncludeDirs.insert(dirStr).second)
+        QASM::QasmPreprocessor::Instance().AddIncludePath(dirStr);
+
+    // Add a callback for diagnostics to the parser, which forwards them to
+    // the diagnostic callback of the parse in progress on this thread.
+    ScopedParseDiagnostics const scopedDiagnostics(diagnostics);
+    QASM::QasmDiagnosticEmitter::SetHandler(handleDiagnostic);
+
+    QASM::ASTParser parser;
+    auto root = std::unique_ptr<QASM::ASTRoot>(nullptr);
+
+    try {
+      if (sourceIsFilename) {
+        QASM::QasmPreprocessor::Instance().SetTranslationUnit(source);
+        root.reset(parser.ParseAST());
+      } else {
+        root.reset(parser.ParseAST(source));
+      }
+    } catch (std::exception &e) {
+      return llvm::createStringError(
+          llvm::inconvertibleErrorCode(),
+          llvm::Twine{"Exception while parsing OpenQASM 3 input: "} +
+              e.what());
+    }
 
-  if (!root)
-    return llvm::createStringError(llvm::inconvertibleErrorCode(),
-                                   "Failed to parse OpenQASM 3 input");
+    qasm3ParseTiming.stop();
 
-  if (emitRawAST)
-    root->print();
+    if (!root)
+      return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                     "Failed to parse OpenQASM 3 input");
 
-  if (emitPrettyAST) {
-    auto *statementList = QASM::ASTStatementBuilder::Instance().List();
-    qssc::frontend::openqasm3::PrintQASM3Visitor visitor(std::cout);
+    if (emitRawAST)
+      root->print();
 
-    visitor.setStatementList(statementList);
-    visitor.walkAST();
-  }
+    if (emitPrettyAST) {
+      auto *statementList = QASM::ASTStatementBuilder::Instance().List();
+      qssc::frontend::openqasm3::PrintQASM3Visitor visitor(std::cout);
 
-  if (emitMLIR) {
-    mlir::TimingScope qasm3ToMlirTiming = timing.nest("convert-qasm3-to-mlir");
+      visitor.setStatementList(statementList);
+      visitor.walkAST();
+    }
 
-    auto *context = newModule.getContext();
+    if (!emitMLIR)
+      return llvm::Error::success();
 
-    context->loadDialect<mlir::quir::QUIRDialect>();
-    context->loadDialect<mlir::complex::ComplexDialect>();
-    context->loadDialect<mlir::func::FuncDialect>();
+    // The AST is owned by qss-qasm, so it is walked under the lock, too.
+    mlir::TimingScope qasm3ToMlirTiming =
+        timing.nest("convert-qasm3-to-mlir");
 
     mlir::OpBuilder const builder(newModule.getBodyRegion());
 
@@ -276,11 +345,7 @@ llvm::Error qssc::frontend::openqasm3::parse(
     qssc::frontend::openqasm3::QUIRGenQASM3Visitor visitor(builder, newModule,
                                                            /*filename=*/"");
 
-    auto result = parseDurationStr(shotDelay);
-    if (auto err = result.takeError())
-      return err;
-
-    const auto [shotDelayValue, shotDelayUnits] = *result;
+    const auto [shotDelayValue, shotDelayUnits] = shotDelayDuration;
     visitor.initialize(numShots, shotDelayValue, shotDelayUnits);
     visitor.setStatementList(statementList);
     visitor.setInputFile(sourceIsFilename ? source : "-");
@@ -290,13 +355,14 @@ llvm::Error qssc::frontend::openqasm3::parse(
                                      "Failed to emit QUIR");
     // make sure to finish the in progress quir.circuit
     visitor.finishCircuit();
-    if (mlir::failed(mlir::verify(newModule))) {
-      newModule.dump();
+  }
 
-      return llvm::createStringError(llvm::inconvertibleErrorCode(),
-                                     "Failed to verify generated QUIR");
-    }
-    qasm3ToMlirTiming.stop();
+  mlir::TimingScope verifyTiming = timing.nest("verify-qasm3-to-mlir");
+  if (mlir::failed(mlir::verify(newModule))) {
+    newModule.dump();
+
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "Failed to verify generated QUIR");
   }
 
   return llvm::Error::success();
@@ -47,7 +47,11 @@
 #include "Dialect/QUIR/IR/QUIROps.h"
 #include "Dialect/QUIR/IR/QUIRTypes.h"
 #include "Frontend/OpenQASM3/BaseQASM3Visitor.h"
+#include "Frontend/OpenQASM3/GateDefinitionCache.h"
+#include "Frontend/OpenQASM3/PrintQASM3Visitor.h"
 #include "Frontend/OpenQASM3/QUIRVariableBuilder.h"
+#include "Frontend/OpenQASM3/ScopedSSAValues.h"
+#include "QSSC.h"
 
 #include "mlir/Dialect/Arith/IR/Arith.h"
 #include "mlir/Dialect/Complex/IR/Complex.h"
@@ -55,6 +59,7 @@
 #include "mlir/Dialect/MemRef/IR/MemRef.h"
 #include "mlir/Dialect/SCF/IR/SCF.h"
 #include "mlir/IR/Attributes.h"
+#include "mlir/IR/Block.h"
 #include "mlir/IR/Builders.h"
 #include "mlir/IR/BuiltinOps.h"
 #include "mlir/IR/BuiltinTypes.h"
@@ -83,6 +88,7 @@
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
+#include <optional>
 #include <qasm/AST/ASTBarrier.h>
 #include <qasm/AST/ASTBase.h>
 #include <qasm/AST/ASTCBit.h>
@@ -144,6 +150,19 @@ llvm::cl::opt<bool> debugCircuits("debug-circuits",
                                   llvm::cl::desc("debug quir circuits"),
                                   llvm::cl::init(false));
 
+llvm::cl::opt<bool> enableGateCache(
+    "qasm3-gate-cache",
+    llvm::cl::desc("reuse the definitions generated for identical gate "
+                   "declarations by earlier compilations in this process"),
+    llvm::cl::init(false));
+
+llvm::cl::opt<std::string> gateCacheDir(
+    "qasm3-gate-cache-dir",
+    llvm::cl::desc("persist cached gate definitions as MLIR bytecode in "
+                   "<dir> to reuse them across processes, implies "
+                   "--qasm3-gate-cache"),
+    llvm::cl::value_desc("dir"), llvm::cl::init(""));
+
 } // anonymous namespace
 
 auto QUIRGenQASM3Visitor::getLocation(const ASTBase *node) -> Location {
@@ -153,8 +172,8 @@ auto QUIRGenQASM3Visitor::getLocation(const ASTBase *node) -> Location {
 
 auto QUIRGenQASM3Visitor::assign(Value &val, const std::string &valName)
     -> bool {
-  if (ssaValues.find(valName) != ssaValues.end()) {
-    val = ssaValues[valName];
+  if (auto value = ssaValues.lookup(valName)) {
+    val = *value;
     return true;
   }
   return false;
@@ -162,13 +181,13 @@ auto QUIRGenQASM3Visitor::assign(Value &val, const std::string &valName)
 
 mlir::Value QUIRGenQASM3Visitor::getCurrentValue(const std::string &valueName) {
 
-  auto pos = ssaValues.find(valueName);
-  if (pos == ssaValues.end()) {
+  auto value = ssaValues.lookup(valueName);
+  if (!value) {
     llvm::errs() << "Missing SSA assignment for " << valueName << "\n";
     newModule.dump();
     llvm::report_fatal_error("Missing SSA assignment");
   }
-  return pos->second;
+  return *value;
 }
 
 llvm::Expected<std::string>
@@ -393,15 +412,13 @@ void QUIRGenQASM3Visitor::visit(const ASTForStatementNode *node) {
 
   auto forOp = builder.create<scf::ForOp>(loc, startOp, endOp, stepOp);
 
+  // SSA values set inside "for" are restored outside the for scope
+  ScopedSSAValues::Scope const forScope(ssaValues);
+
   // Adding induction variable to SSA values map
   const ASTIntNode *indVar = loop->GetIndVar();
   Value const forOpIndVar = forOp.getInductionVar();
-  ssaValues[indVar->GetName()] = forOpIndVar;
-
-  // Dictionary of SSA values used inside "for"
-  std::unordered_map<std::string, mlir::Value> forSsaValues = ssaValues;
-  // Save previous SSA values so we can restore them outside the for scope
-  std::swap(ssaValues, forSsaValues);
+  ssaValues.set(indVar->GetName(), forOpIndVar);
 
   // set up the builders to point to the proper places
   OpBuilder const b(&forOp.getRegion());
@@ -419,7 +436,6 @@ void QUIRGenQASM3Visitor::visit(const ASTForStatementNode *node) {
   // Set the builder to add the next operations after the for loop.
   builder.setInsertionPointAfter(forOp);
   circuitParentBuilder.setInsertionPointAfter(forOp);
-  std::swap(ssaValues, forSsaValues);
 }
 
 void QUIRGenQASM3Visitor::visit(const ASTForLoopNode *node) {
@@ -457,10 +473,8 @@ void QUIRGenQASM3Visitor::visit(const ASTIfStatementNode *node) {
   // Save current level OpBuilder
   OpBuilder const prevBuilder = builder;
 
-  // Dictionary of SSA values used inside "if"
-  std::unordered_map<std::string, mlir::Value> ifSsaValues = ssaValues;
-  // Save previous SSA values so we can restore them outside the if scope
-  std::swap(ssaValues, ifSsaValues);
+  // SSA values set inside "if" are restored outside the if scope
+  std::optional<ScopedSSAValues::Scope> ifScope(std::in_place, ssaValues);
 
   // New OpBuilder for the if statement Region
   OpBuilder const ifRegionBuilder(ifOp.getThenRegion());
@@ -482,14 +496,12 @@ void QUIRGenQASM3Visitor::visit(const ASTIfStatementNode *node) {
 
   builder = prevBuilder;
   circuitParentBuilder = builder;
-  std::swap(ssaValues, ifSsaValues);
+  ifScope.reset();
 
   // Else
   if (hasElse) {
-    // Dictionary of SSA values used inside "else"
-    std::unordered_map<std::string, mlir::Value> elseSsaValues = ssaValues;
-    // Save previous SSA values so we can restore them outside the else scope
-    std::swap(ssaValues, elseSsaValues);
+    // SSA values set inside "else" are restored outside the else scope
+    ScopedSSAValues::Scope const elseScope(ssaValues);
 
     // Save current level OpBuilder
     OpBuilder const elseBuilder = builder;
@@ -512,7 +524,6 @@ void QUIRGenQASM3Visitor::visit(const ASTIfStatementNode *node) {
 
     builder = elseBuilder;
     circuitParentBuilder = builder;
-    std::swap(ssaValues, elseSsaValues);
   }
 }
 
@@ -718,6 +729,27 @@ void QUIRGenQASM3Visitor::visit(const ASTFunctionCallNode *node) {
 void QUIRGenQASM3Visitor::visit(const ASTGateDeclarationNode *node) {
   switchCircuit(false, getLocation(node));
 
+  // Gates generate a single definition only when circuits are disabled
+  std::optional<std::string> cacheKey;
+  if ((enableGateCache || !gateCacheDir.empty()) && !enableCircuits) {
+    cacheKey = getGateCacheKey(node);
+    if (auto *definition = GateDefinitionCache::instance().lookup(
+            *cacheKey, topLevelBuilder, gateCacheDir)) {
+      // The definition may have been generated for a declaration in another
+      // file or at another position, so it is located at this declaration
+      Location const loc = getLocation(node);
+      definition->walk([&](Operation *op) {
+        op->setLoc(loc);
+        for (Region &region : op->getRegions())
+          for (Block &block : region)
+            for (BlockArgument arg : block.getArguments())
+              arg.setLoc(loc);
+      });
+      return;
+    }
+  }
+  bool const failedBefore = hasFailed;
+
   const ASTGateNode *gateNode = node->GetGateNode();
 
   const size_t numQubits = gateNode->QubitsSize();
@@ -738,25 +770,26 @@ void QUIRGenQASM3Visitor::visit(const ASTGateDeclarationNode *node) {
           /*results=*/ArrayRef<Type>()));
   func.addEntryBlock();
 
-  // TODO this wants to be a symbol table that now enters a new scope
+  // The gate body only sees its arguments, so the SSA values outside of it
+  // are hidden until the end of the declaration
+  ScopedSSAValues::IsolatedScope const gateScope(ssaValues);
+
   // Store argument Values so we can reference them within this gate
-  std::unordered_map<std::string, mlir::Value> gateSsaValues;
   unsigned i = 0;
   MutableArrayRef<BlockArgument> const arguments =
       func.getBody().getArguments();
   for (BlockArgument *arg = arguments.begin(); arg < arguments.end(); arg++) {
     if (i < numQubits) {
-      gateSsaValues[gateNode->GetQubit(i)->GetGateQubitName()] = *arg;
+      ssaValues.set(gateNode->GetQubit(i)->GetGateQubitName(), *arg);
     } else {
-      gateSsaValues[gateNode->GetParam(i - numQubits)->GetGateParamName()] =
-          *arg;
+      ssaValues.set(gateNode->GetParam(i - numQubits)->GetGateParamName(),
+                    *arg);
     }
     i++;
   }
 
-  // Save the current builder, temporarily swap the available Values
+  // Save the current builder
   OpBuilder const prevBuilder = builder;
-  std::swap(ssaValues, gateSsaValues);
 
   // New OpBuilder for the gate declaration Region
   OpBuilder const gateDeclarationBuilder(func.getBody());
@@ -772,10 +805,28 @@ void QUIRGenQASM3Visitor::visit(const ASTGateDeclarationNode *node) {
 
   builder.create<mlir::func::ReturnOp>(getLocation(node));
 
-  // Restore SSA Values and OpBuilder as we exit the function
+  // Restore the OpBuilder as we exit the function, SSA Values are restored
+  // with the end of gateScope
   builder = prevBuilder;
   circuitParentBuilder = builder;
-  std::swap(ssaValues, gateSsaValues);
+
+  if (cacheKey && !hasFailed && !failedBefore)
+    GateDefinitionCache::instance().insert(*cacheKey, func, gateCacheDir);
+}
+
+std::string
+QUIRGenQASM3Visitor::getGateCacheKey(const ASTGateDeclarationNode *node) {
+  // The printed declaration covers the parameters, qubits and operations of
+  // the gate, and the flags the operations generated. The position of the
+  // declaration is left out, so that declarations included by many programs
+  // share their definition, which is located when it is reused. The
+  // compiler version invalidates definitions persisted by other builds.
+  std::ostringstream content;
+  content << "v1:" << qssc::getQSSCVersion().str() << ':' << enableParameters
+          << '\n';
+  PrintQASM3Visitor printer(content);
+  printer.visit(node);
+  return content.str();
 }
 
 void QUIRGenQASM3Visitor::visit(const ASTGenericGateOpNode *node) {
@@ -1272,7 +1323,7 @@ QUIRGenQASM3Visitor::visit_(const ASTQubitContainerNode *node) {
                            getLocation(node), builder.getType<QubitType>(size),
                            builder.getIntegerAttr(builder.getI32Type(), id))
                        .getRes();
-  ssaValues[qId] = qubitRef;
+  ssaValues.set(qId, qubitRef);
   return qubitRef;
 }
 
@@ -1343,7 +1394,7 @@ ExpressionValueType QUIRGenQASM3Visitor::visit_(const ASTDurationNode *node) {
   switchCircuit(true, getLocation(node));
   // TODO this node may refer to an identifier, not just the encoded value. Fix
   // when replacing the use of ssaValues.
-  if (ssaValues.find(node->GetName()) != ssaValues.end()) {
+  if (ssaValues.contains(node->GetName())) {
     reportError(node, mlir::DiagnosticSeverity::Error)
         << "ASTDurationNode referring to a previously declared duration is not "
         << "supported yet.";
@@ -1352,7 +1403,7 @@ ExpressionValueType QUIRGenQASM3Visitor::visit_(const ASTDurationNode *node) {
   const auto durationRef = createDurationRef(
       getLocation(node), node->GetDuration(), node->GetLengthUnit());
 
-  ssaValues[node->GetName()] = durationRef;
+  ssaValues.set(node->GetName(), durationRef);
   return durationRef;
 }
 
@@ -1370,7 +1421,7 @@ ExpressionValueType QUIRGenQASM3Visitor::visit_(const ASTStretchNode *node) {
 
   const Value stretchRef = builder.create<DeclareStretchOp>(
       getLocation(node), builder.getType<StretchType>());
-  ssaValues[node->GetName()] = stretchRef;
+  ssaValues.set(node->GetName(), stretchRef);
   return stretchRef;
 }
 
@@ -1407,7 +1458,7 @@ QUIRGenQASM3Visitor::visit_(const ASTIdentifierRefNode *node) {
 
   Value loadOpRef =
       builder.create<mlir::memref::LoadOp>(getLocation(node), memRef, indexRef);
-  ssaValues[node->GetName()] = loadOpRef;
+  ssaValues.set(node->GetName(), loadOpRef);
   return loadOpRef;
 }
 
@@ -1485,7 +1536,7 @@ QUIRGenQASM3Visitor::handleAssign(const ASTBinaryOpNode *node) {
       opRef = builder.create<CastOp>(getLocation(left), leftRef.getType(),
                                      rightRef);
     }
-    ssaValues[left->GetIdentifier()->GetName()] = opRef;
+    ssaValues.set(left->GetIdentifier()->GetName(), opRef);
     return opRef;
   }
 
@@ -1976,7 +2027,7 @@ ExpressionValueType QUIRGenQASM3Visitor::visit_(const ASTMPDecimalNode *node) {
   switchCircuit(false, getLocation(node));
   // TODO this node may refer to an identifier, not just the encoded value. Fix
   // when replacing the use of ssaValues.
-  if (ssaValues.find(node->GetName()) != ssaValues.end()) {
+  if (ssaValues.contains(node->GetName())) {
     reportError(node, mlir::DiagnosticSeverity::Error)
         << "ASTMPDecimalNode referring to a previously declared duration is "
         << "not supported yet.";
@@ -1998,7 +2049,7 @@ ExpressionValueType QUIRGenQASM3Visitor::visit_(const ASTMPComplexNode *node) {
   }
   std::string const name = nameOrError.get();
 
-  if (ssaValues.find(name) != ssaValues.end()) {
+  if (ssaValues.contains(name)) {
     reportError(node, mlir::DiagnosticSeverity::Error)
         << "ASTMPComplexNode referring to a previously declared duration is "
         << "not supported yet.";
@@ -2112,7 +2163,7 @@ QUIRGenQASM3Visitor::visit_(const ASTCastExpressionNode *node) {
 
   Value opRef = builder.create<CastOp>(
       getLocation(node), getCastDestinationType(node, builder), operandRef);
-  ssaValues[node->GetIdentifier()->GetName()] = opRef;
+  ssaValues.set(node->GetIdentifier()->GetName(), opRef);
   return opRef;
 }
 
@@ -29,6 +29,7 @@
 #include "llvm/Support/raw_ostream.h"
 
 #include "HAL/Compile/TargetCompilationManager.h"
+#include "HAL/Compile/ThreadedCompilationManager.h"
 #include "HAL/TargetSystem.h"
 
 using namespace qssc::hal::compile;
@@ -55,6 +56,36 @@ struct TargetCompilationManagerOptions {
       "print-ir-after-target-compile-failure",
       llvm::cl::desc("Print IR after failure of applying target compilation"),
       llvm::cl::init(false)};
+
+  //===--------------------------------------------------------------------===//
+  // Scheduling
+  //===--------------------------------------------------------------------===//
+  llvm::cl::opt<bool> reuseTargetPassManagers{
+      "reuse-target-pass-managers",
+      llvm::cl::desc("Reuse the pass managers built for each target between "
+                     "compilations of a session"),
+      llvm::cl::init(true)};
+  llvm::cl::opt<bool> scheduleTargetDependencies{
+      "schedule-target-dependencies",
+      llvm::cl::desc("Start compiling each target as soon as its parent is "
+                     "done rather than walking the targets level by level"),
+      llvm::cl::init(true)};
+  llvm::cl::opt<ThreadedCompilationManager::ChildOrderingPolicy>
+      targetChildOrdering{
+          "target-child-ordering",
+          llvm::cl::desc("Order in which the children of a target are "
+                         "submitted for compilation"),
+          llvm::cl::values(
+              clEnumValN(
+                  ThreadedCompilationManager::ChildOrderingPolicy::Cost,
+                  "cost",
+                  "most expensive first, by the durations recorded by a "
+                  "previous compilation or else by estimate"),
+              clEnumValN(
+                  ThreadedCompilationManager::ChildOrderingPolicy::Declaration,
+                  "declaration", "in the order declared by the parent")),
+          llvm::cl::init(
+              ThreadedCompilationManager::ChildOrderingPolicy::Cost)};
 };
 
 llvm::ManagedStatic<TargetCompilationManagerOptions> options;
@@ -77,6 +108,12 @@ mlir::LogicalResult qssc::hal::compile::applyTargetCompilationManagerCLOptions(
                              options->printBeforeAllTargetPayload,
                              options->printAfterTargetCompileFailure);
 
+  if (auto *threaded = dynamic_cast<ThreadedCompilationManager *>(&scheduler)) {
+    threaded->enablePassManagerCache(options->reuseTargetPassManagers);
+    threaded->enableDependencyScheduling(options->scheduleTargetDependencies);
+    threaded->setChildOrderingPolicy(options->targetChildOrdering);
+  }
+
   return mlir::success();
 }
 
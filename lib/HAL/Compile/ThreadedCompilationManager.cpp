@@ -29,16 +29,28 @@
 #include "mlir/Support/LogicalResult.h"
 #include "mlir/Support/Timing.h"
 
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/Twine.h"
 #include "llvm/Support/Error.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/raw_ostream.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
 #include <mutex>
+#include <numeric>
+#include <optional>
 #include <shared_mutex>
 #include <string>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 using namespace qssc;
 using namespace qssc::hal::compile;
@@ -73,13 +85,20 @@ llvm::Error ThreadedCompilationManager::walkTargetModulesThreaded(
     auto childrenTiming = parentTiming.nest("children");
 
     std::unordered_map<Target *, mlir::ModuleOp> childrenModules;
+    std::vector<std::pair<Target *, mlir::ModuleOp>> orderedChildren;
     for (auto *childTarget : children) {
       auto childModuleOp = childTarget->getModule(targetModuleOp);
       if (auto err = childModuleOp.takeError())
         return err;
       childrenModules[childTarget] = *childModuleOp;
+      orderedChildren.emplace_back(childTarget, *childModuleOp);
     }
 
+    // Children are picked up by the threadpool in order.
+    orderChildren_(orderedChildren);
+    for (size_t i = 0; i < orderedChildren.size(); i++)
+      children[i] = orderedChildren[i].first;
+
     auto parallelWalkFunc = [&](Target *childTarget) {
       // Recurse on this target's children in a depth first fashion.
 
@@ -148,28 +167,264 @@ llvm::Error ThreadedCompilationManager::walkTargetThreaded(
   return llvm::Error::success();
 }
 
+namespace {
+uint64_t elapsedNanoseconds(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+/// A target of the dependency graph walked by
+/// ThreadedCompilationManager::scheduleTargetModules.
+struct ScheduledTarget {
+  hal::Target *target;
+  mlir::ModuleOp moduleOp;
+  ScheduledTarget *parent;
+  std::vector<std::unique_ptr<ScheduledTarget>> children;
+  /// Number of children whose subtree has not yet completed.
+  std::atomic<size_t> pendingChildren{0};
+  mlir::TimingScope timing;
+  mlir::TimingScope childrenTiming;
+};
+} // anonymous namespace
+
+llvm::Error ThreadedCompilationManager::scheduleTargetModules(
+    Target *target, mlir::ModuleOp targetModuleOp, mlir::TimingScope &timing,
+    llvm::ArrayRef<WalkTargetModulesFunction> stages,
+    const WalkTargetModulesFunction &postChildrenCallbackFunc) {
+
+  if (!dependencySchedulingEnabled_ || !isMultithreadingEnabled()) {
+    auto walkFunc = [&](hal::Target *target, mlir::ModuleOp targetModuleOp,
+                        mlir::TimingScope &timing) -> llvm::Error {
+      for (const auto &stage : stages)
+        if (auto err = stage(target, targetModuleOp, timing))
+          return err;
+      return llvm::Error::success();
+    };
+    return walkTargetModulesThreaded(target, targetModuleOp, timing, walkFunc,
+                                     postChildrenCallbackFunc);
+  }
+
+  llvm::ThreadPoolTaskGroup tasks(getThreadPool());
+
+  std::atomic<bool> failed{false};
+  std::mutex errorMutex;
+  llvm::Error error = llvm::Error::success();
+  auto recordError = [&](llvm::Error err) {
+    failed = true;
+    // NOLINTNEXTLINE(clang-diagnostic-ctad-maybe-unsupported)
+    std::lock_guard const lock(errorMutex);
+    error = llvm::joinErrors(std::move(error), std::move(err));
+  };
+
+  std::function<void(ScheduledTarget *, size_t)> runStage;
+  std::function<void(ScheduledTarget *)> runPostChildren;
+
+  // Completes a target once its own stages and all of its children's
+  // subtrees have completed, which in turn may complete its parent.
+  runPostChildren = [&](ScheduledTarget *scheduled) {
+    if (failed)
+      return;
+
+    scheduled->childrenTiming.stop();
+    auto start = std::chrono::steady_clock::now();
+    if (auto err = postChildrenCallbackFunc(
+            scheduled->target, scheduled->moduleOp, scheduled->timing)) {
+      recordError(std::move(err));
+      return;
+    }
+    recordCost_(scheduled->target, elapsedNanoseconds(start),
+                /*firstStage=*/false);
+    scheduled->timing.stop();
+
+    auto *parent = scheduled->parent;
+    if (parent && parent->pendingChildren.fetch_sub(1) == 1)
+      tasks.async([&, parent]() { runPostChildren(parent); });
+  };
+
+  // Runs a single stage of a target and submits whatever became ready.
+  runStage = [&](ScheduledTarget *scheduled, size_t stage) {
+    if (failed)
+      return;
+
+    if (stage < stages.size()) {
+      auto start = std::chrono::steady_clock::now();
+      if (auto err = stages[stage](scheduled->target, scheduled->moduleOp,
+                                   scheduled->timing)) {
+        recordError(std::move(err));
+        return;
+      }
+      recordCost_(scheduled->target, elapsedNanoseconds(start),
+                  /*firstStage=*/stage == 0);
+      tasks.async([&, scheduled, stage]() { runStage(scheduled, stage + 1); });
+      return;
+    }
+
+    // All stages of this target are done so its children may start. Child
+    // modules are looked up sequentially to preserve MLIR parallelization
+    // rules.
+    auto children = scheduled->target->getChildren();
+    if (children.empty()) {
+      runPostChildren(scheduled);
+      return;
+    }
+
+    std::vector<std::pair<Target *, mlir::ModuleOp>> orderedChildren;
+    for (auto *childTarget : children) {
+      auto childModuleOp = childTarget->getModule(scheduled->moduleOp);
+      if (auto err = childModuleOp.takeError()) {
+        recordError(std::move(err));
+        return;
+      }
+      orderedChildren.emplace_back(childTarget, *childModuleOp);
+    }
+    orderChildren_(orderedChildren);
+
+    scheduled->childrenTiming = scheduled->timing.nest("children");
+    for (auto [childTarget, childModuleOp] : orderedChildren) {
+      auto child = std::make_unique<ScheduledTarget>();
+      child->target = childTarget;
+      child->moduleOp = childModuleOp;
+      child->parent = scheduled;
+      child->timing = scheduled->childrenTiming.nest(childTarget->getName());
+      scheduled->children.push_back(std::move(child));
+    }
+
+    // Children are submitted in order of decreasing priority.
+    scheduled->pendingChildren = scheduled->children.size();
+    for (auto &child : scheduled->children)
+      tasks.async([&, child = child.get()]() { runStage(child, 0); });
+  };
+
+  ScheduledTarget root;
+  root.target = target;
+  root.moduleOp = targetModuleOp;
+  root.parent = nullptr;
+  root.timing = timing.nest(target->getName());
+
+  tasks.async([&]() { runStage(&root, 0); });
+  tasks.wait();
+
+  return error;
+}
+
+void ThreadedCompilationManager::enableDependencyScheduling(bool enable) {
+  dependencySchedulingEnabled_ = enable;
+}
+
+void ThreadedCompilationManager::setChildOrderingPolicy(
+    ChildOrderingPolicy policy) {
+  childOrderingPolicy_ = policy;
+}
+
+void ThreadedCompilationManager::clearRecordedCosts() {
+  // NOLINTNEXTLINE(clang-diagnostic-ctad-maybe-unsupported)
+  std::lock_guard const lock(recordedCostsMutex_);
+  recordedCosts_.clear();
+}
+
+void ThreadedCompilationManager::recordCost_(Target *target,
+                                             uint64_t nanoseconds,
+                                             bool firstStage) {
+  // NOLINTNEXTLINE(clang-diagnostic-ctad-maybe-unsupported)
+  std::lock_guard const lock(recordedCostsMutex_);
+  auto &cost = recordedCosts_[target];
+  cost = firstStage ? nanoseconds : cost + nanoseconds;
+}
+
+std::optional<uint64_t>
+ThreadedCompilationManager::getRecordedSubtreeCost_(Target *target) {
+  auto it = recordedCosts_.find(target);
+  if (it == recordedCosts_.end())
+    return std::nullopt;
+
+  uint64_t cost = it->second;
+  for (auto *child : target->getChildren()) {
+    auto childCost = getRecordedSubtreeCost_(child);
+    if (!childCost.has_value())
+      return std::nullopt;
+    cost += *childCost;
+  }
+  return cost;
+}
+
+void ThreadedCompilationManager::orderChildren_(
+    std::vector<std::pair<Target *, mlir::ModuleOp>> &children) {
+  if (childOrderingPolicy_ == ChildOrderingPolicy::Declaration ||
+      children.size() < 2)
+    return;
+
+  // Prefer the durations measured by a previous compilation as these account
+  // for the subtrees of the children. Estimates are only comparable with
+  // each other, so they are used for all siblings if any is missing.
+  std::vector<uint64_t> costs;
+  {
+    // NOLINTNEXTLINE(clang-diagnostic-ctad-maybe-unsupported)
+    std::lock_guard const lock(recordedCostsMutex_);
+    for (auto &child : children) {
+      auto cost = getRecordedSubtreeCost_(child.first);
+      if (!cost.has_value()) {
+        costs.clear();
+        break;
+      }
+      costs.push_back(*cost);
+    }
+  }
+  if (costs.empty())
+    for (auto &[childTarget, childModuleOp] : children)
+      costs.push_back(childTarget->estimateCompilationCost(childModuleOp));
+
+  std::vector<size_t> order(children.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+                   [&](size_t a, size_t b) { return costs[a] > costs[b]; });
+
+  std::vector<std::pair<Target *, mlir::ModuleOp>> ordered;
+  ordered.reserve(children.size());
+  for (auto index : order)
+    ordered.push_back(children[index]);
+  children = std::move(ordered);
+}
+
 llvm::Error ThreadedCompilationManager::buildTargetPassManagers_(
     Target &target, mlir::TimingScope &timing) {
 
   auto buildPMTiming = timing.nest("build-target-pass-managers");
 
+  // Timing instrumentation is added to a pass manager each time it is run
+  // with an active timer. Such pass managers may not be reused by a later
+  // compilation whose timers have been destroyed.
+  bool const useCache = passManagerCacheEnabled_ && !timing;
+
+  // Discard pass managers selected by a previous compilation.
+  {
+    // NOLINTNEXTLINE(clang-diagnostic-ctad-maybe-unsupported)
+    std::unique_lock const lock(targetPassManagersMutex_);
+    targetPassManagers_.clear();
+  }
+
   // Create dummy timing scope for pass manager building
   // as this is not significant enough to report for each individual target.
   auto targetsTiming = mlir::TimingScope();
 
   auto threadedBuildTargetPassManager =
       [&](hal::Target *target, mlir::TimingScope &timing) -> llvm::Error {
-    auto &pm = createTargetPassManager_(target);
+    if (useCache && lookupCachedPassManager_(target))
+      return llvm::Error::success();
 
-    if (auto err = pmBuilder(pm))
+    auto pm = std::make_shared<mlir::PassManager>(getContext());
+
+    if (auto err = pmBuilder(*pm))
       return err;
 
     target->enableTiming(timing);
-    if (auto err = target->addPasses(pm))
+    if (auto err = target->addPasses(*pm))
       return err;
     target->disableTiming();
 
-    registerPassManagerWithContext_(pm);
+    registerPassManagerWithContext_(*pm);
+
+    setTargetPassManager_(target, std::move(pm), /*cache=*/useCache);
 
     return llvm::Error::success();
   };
@@ -179,6 +434,26 @@ llvm::Error ThreadedCompilationManager::buildTargetPassManagers_(
   return err;
 }
 
+void ThreadedCompilationManager::enablePassManagerCache(bool enable) {
+  // NOLINTNEXTLINE(clang-diagnostic-ctad-maybe-unsupported)
+  std::unique_lock const lock(targetPassManagersMutex_);
+  passManagerCacheEnabled_ = enable;
+  if (!enable)
+    passManagerCache_.clear();
+}
+
+void ThreadedCompilationManager::setPipelineOptionsKey(std::string key) {
+  // NOLINTNEXTLINE(clang-diagnostic-ctad-maybe-unsupported)
+  std::unique_lock const lock(targetPassManagersMutex_);
+  pipelineOptionsKey_ = std::move(key);
+}
+
+void ThreadedCompilationManager::invalidatePassManagerCache() {
+  // NOLINTNEXTLINE(clang-diagnostic-ctad-maybe-unsupported)
+  std::unique_lock const lock(targetPassManagersMutex_);
+  passManagerCache_.clear();
+}
+
 // Mirroring mlir::PassManager::run() we register all of the pass's dependent
 // dialects with the context in a thread-safe way to prevent issues with the
 // default non-threadsafe modification of the dialect registry performed by the
@@ -201,14 +476,26 @@ mlir::PassManager &
 ThreadedCompilationManager::getTargetPassManager_(Target *target) {
   // NOLINTNEXTLINE(clang-diagnostic-ctad-maybe-unsupported)
   std::shared_lock const lock(targetPassManagersMutex_);
-  return targetPassManagers_.at(target);
+  return *targetPassManagers_.at(target);
 }
 
-mlir::PassManager &
-ThreadedCompilationManager::createTargetPassManager_(Target *target) {
+void ThreadedCompilationManager::setTargetPassManager_(
+    Target *target, std::shared_ptr<mlir::PassManager> pm, bool cache) {
   // NOLINTNEXTLINE(clang-diagnostic-ctad-maybe-unsupported)
   std::unique_lock const lock(targetPassManagersMutex_);
-  return targetPassManagers_.emplace(target, getContext()).first->second;
+  if (cache)
+    passManagerCache_[{target, pipelineOptionsKey_}] = pm;
+  targetPassManagers_[target] = std::move(pm);
+}
+
+bool ThreadedCompilationManager::lookupCachedPassManager_(Target *target) {
+  // NOLINTNEXTLINE(clang-diagnostic-ctad-maybe-unsupported)
+  std::unique_lock const lock(targetPassManagersMutex_);
+  auto it = passManagerCache_.find({target, pipelineOptionsKey_});
+  if (it == passManagerCache_.end())
+    return false;
+  targetPassManagers_[target] = it->second;
+  return true;
 }
 
 llvm::Error ThreadedCompilationManager::compileMLIR(mlir::ModuleOp moduleOp) {
@@ -239,9 +526,9 @@ llvm::Error ThreadedCompilationManager::compileMLIR(mlir::ModuleOp moduleOp) {
 
   auto targetsTiming = compileMLIRTiming.nest("compile-system");
 
-  auto err = walkTargetModulesThreaded(&target, moduleOp, targetsTiming,
-                                       threadedCompileMLIRTarget,
-                                       postChildrenEmitToPayload);
+  auto err = scheduleTargetModules(&target, moduleOp, targetsTiming,
+                                   {threadedCompileMLIRTarget},
+                                   postChildrenEmitToPayload);
   return err;
 }
 
@@ -286,11 +573,21 @@ ThreadedCompilationManager::compilePayload(mlir::ModuleOp moduleOp,
   if (auto err = buildTargetPassManagers_(target, compilePayloadTiming))
     return err;
 
-  auto threadedCompilePayloadTarget =
+  auto threadedCompileMLIRTarget =
       [&](hal::Target *target, mlir::ModuleOp targetModuleOp,
           mlir::TimingScope &timing) -> llvm::Error {
-    if (auto err = compilePayloadTarget_(*target, targetModuleOp, payload,
-                                         timing, doCompileMLIR))
+    if (!doCompileMLIR)
+      return llvm::Error::success();
+    if (auto err = compileMLIRTarget_(*target, targetModuleOp, timing))
+      return err;
+    return llvm::Error::success();
+  };
+
+  auto threadedEmitToPayloadTarget =
+      [&](hal::Target *target, mlir::ModuleOp targetModuleOp,
+          mlir::TimingScope &timing) -> llvm::Error {
+    if (auto err =
+            emitToPayloadTarget_(*target, targetModuleOp, payload, timing))
       return err;
     return llvm::Error::success();
   };
@@ -300,28 +597,25 @@ ThreadedCompilationManager::compilePayload(mlir::ModuleOp moduleOp,
           mlir::TimingScope &timing) -> llvm::Error {
     auto emitToPayloadTiming = timing.nest("emit-to-payload-post-children");
     target->enableTiming(emitToPayloadTiming);
+    qssc::payload::Payload::EmissionScope emission(payload);
     if (auto err = target->emitToPayloadPostChildren(targetModuleOp, payload))
       return err;
     target->disableTiming();
 
-    return llvm::Error::success();
+    return emission.commit();
   };
 
   auto targetsTiming = compilePayloadTiming.nest("compile-system");
-  auto err = walkTargetModulesThreaded(&target, moduleOp, targetsTiming,
-                                       threadedCompilePayloadTarget,
-                                       postChildrenEmitToPayload);
+  auto err = scheduleTargetModules(
+      &target, moduleOp, targetsTiming,
+      {threadedCompileMLIRTarget, threadedEmitToPayloadTarget},
+      postChildrenEmitToPayload);
   return err;
 }
 
-llvm::Error ThreadedCompilationManager::compilePayloadTarget_(
+llvm::Error ThreadedCompilationManager::emitToPayloadTarget_(
     Target &target, mlir::ModuleOp targetModuleOp,
-    qssc::payload::Payload &payload, mlir::TimingScope &timing,
-    bool doCompileMLIR) {
-
-  if (doCompileMLIR)
-    if (auto err = compileMLIRTarget_(target, targetModuleOp, timing))
-      return err;
+    qssc::payload::Payload &payload, mlir::TimingScope &timing) {
 
   if (getPrintBeforeAllTargetPayload())
     printIR("IR dump before emitting payload for target " + target.getName(),
@@ -329,6 +623,9 @@ llvm::Error ThreadedCompilationManager::compilePayloadTarget_(
 
   auto emitToPayloadTiming = timing.nest("emit-to-payload");
   target.enableTiming(emitToPayloadTiming);
+  // When the payload is streaming, the files of this target are written out
+  // as soon as it finishes emitting rather than after all targets complete.
+  qssc::payload::Payload::EmissionScope emission(payload);
   if (auto err = target.emitToPayload(targetModuleOp, payload)) {
     if (getPrintAfterTargetCompileFailure())
       printIR("IR dump after failure emitting payload for target " +
@@ -338,7 +635,7 @@ llvm::Error ThreadedCompilationManager::compilePayloadTarget_(
   }
   target.disableTiming();
 
-  return llvm::Error::success();
+  return emission.commit();
 }
 
 void ThreadedCompilationManager::printIR(llvm::Twine msg, mlir::Operation *op,
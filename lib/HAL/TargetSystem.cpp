@@ -20,11 +20,13 @@
 
 #include "mlir/IR/BuiltinAttributes.h"
 #include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/Operation.h"
 #include "mlir/Support/Timing.h"
 
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Error.h"
 
+#include <cstdint>
 #include <string>
 #include <sys/types.h>
 #include <utility>
@@ -40,6 +42,12 @@ llvm::Error Target::emitToPayloadPostChildren(mlir::ModuleOp targetModuleOp,
   return llvm::Error::success();
 }
 
+uint64_t Target::estimateCompilationCost(mlir::ModuleOp targetModuleOp) {
+  uint64_t numOps = 0;
+  targetModuleOp->walk([&](mlir::Operation *) { numOps++; });
+  return numOps;
+}
+
 void Target::enableTiming(mlir::TimingScope &timingScope) {
   rootTimer = timingScope.nest(getName());
   rootTimer.hide();
@@ -23,6 +23,7 @@
 #include "llvm/Support/Error.h"
 
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <utility>
 
@@ -40,6 +41,9 @@ using namespace qssc::hal::registry;
 struct TargetSystemInfo::Impl {
   llvm::DenseMap<mlir::MLIRContext *, std::unique_ptr<TargetSystem>>
       managedTargets{};
+  /// Guards managedTargets as targets may be created for several contexts
+  /// concurrently.
+  mutable std::mutex managedTargetsMutex;
 };
 
 TargetSystemInfo::TargetSystemInfo(
@@ -58,12 +62,17 @@ llvm::Expected<qssc::hal::TargetSystem *> TargetSystemInfo::createTarget(
   auto target = PluginInfo::createPluginInstance(configuration);
   if (!target)
     return target.takeError();
-  impl->managedTargets[context] = std::move(target.get());
-  return impl->managedTargets[context].get();
+  // NOLINTNEXTLINE(clang-diagnostic-ctad-maybe-unsupported)
+  std::lock_guard const lock(impl->managedTargetsMutex);
+  auto &managedTarget = impl->managedTargets[context];
+  managedTarget = std::move(target.get());
+  return managedTarget.get();
 }
 
 llvm::Expected<qssc::hal::TargetSystem *>
 TargetSystemInfo::getTarget(mlir::MLIRContext *context) const {
+  // NOLINTNEXTLINE(clang-diagnostic-ctad-maybe-unsupported)
+  std::lock_guard const lock(impl->managedTargetsMutex);
   auto it = impl->managedTargets.find(context);
   if (it != impl->managedTargets.end())
     return it->getSecond().get();
@@ -78,6 +87,20 @@ TargetSystemInfo::getTarget(mlir::MLIRContext *context) const {
                                      "' registered for the given context.\n");
 }
 
+void TargetSystemInfo::releaseTarget(mlir::MLIRContext *context) {
+  std::unique_ptr<TargetSystem> released;
+  {
+    // NOLINTNEXTLINE(clang-diagnostic-ctad-maybe-unsupported)
+    std::lock_guard const lock(impl->managedTargetsMutex);
+    auto it = impl->managedTargets.find(context);
+    if (it == impl->managedTargets.end())
+      return;
+    released = std::move(it->getSecond());
+    impl->managedTargets.erase(it);
+  }
+  // The target is destroyed outside of the lock.
+}
+
 llvm::Error TargetSystemInfo::registerTargetPasses() const {
   return passRegistrar();
 }
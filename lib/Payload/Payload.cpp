@@ -20,10 +20,24 @@
 
 #include "Payload/Payload.h"
 
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/Twine.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+
 #include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <filesystem>
+#include <memory>
 #include <mutex>
+#include <optional>
 #include <string>
+#include <utility>
+#include <variant>
 #include <vector>
 
 // Inject static initialization headers from payloads. We need to include them
@@ -34,26 +48,220 @@
 using namespace qssc::payload;
 namespace fs = std::filesystem;
 
+llvm::StringRef PayloadFile::getBuffer() const {
+  return std::visit(
+      llvm::makeVisitor(
+          [](const std::string &str) { return llvm::StringRef(str); },
+          [](const std::unique_ptr<llvm::MemoryBuffer> &buffer) {
+            return buffer ? buffer->getBuffer() : llvm::StringRef();
+          },
+          [](const std::vector<char> &bytes) {
+            return llvm::StringRef(bytes.data(), bytes.size());
+          }),
+      storage);
+}
+
+std::string &PayloadFile::getString() {
+  if (!std::holds_alternative<std::string>(storage))
+    storage = getBuffer().str();
+  return std::get<std::string>(storage);
+}
+
+auto PayloadFileStore::getShard(const fs::path &fName) -> Shard & {
+  return shards[PathHash()(fName) % numShards];
+}
+
+PayloadFile &PayloadFileStore::getOrCreate(const fs::path &fName) {
+  auto &shard = getShard(fName);
+  const std::lock_guard<std::mutex> lock(shard.mutex);
+  // unordered_map nodes are not relocated by a rehash so the reference
+  // remains valid after the lock is released
+  return shard.files[fName];
+}
+
+PayloadFile *PayloadFileStore::lookup(const fs::path &fName) {
+  auto &shard = getShard(fName);
+  const std::lock_guard<std::mutex> lock(shard.mutex);
+  auto pos = shard.files.find(fName);
+  return pos == shard.files.end() ? nullptr : &pos->second;
+}
+
+void PayloadFileStore::set(const fs::path &fName, PayloadFile contents) {
+  auto &shard = getShard(fName);
+  const std::lock_guard<std::mutex> lock(shard.mutex);
+  shard.files[fName] = std::move(contents);
+}
+
+std::optional<PayloadFile> PayloadFileStore::take(const fs::path &fName) {
+  auto &shard = getShard(fName);
+  const std::lock_guard<std::mutex> lock(shard.mutex);
+  auto node = shard.files.extract(fName);
+  if (node.empty())
+    return std::nullopt;
+  return std::move(node.mapped());
+}
+
+std::vector<fs::path> PayloadFileStore::orderedNames() const {
+  std::vector<fs::path> ret;
+  for (const auto &shard : shards) {
+    const std::lock_guard<std::mutex> lock(shard.mutex);
+    for (const auto &filePair : shard.files)
+      ret.emplace_back(filePair.first);
+  }
+  std::sort(ret.begin(), ret.end());
+  return ret;
+}
+
+size_t PayloadFileStore::size() const {
+  size_t ret = 0;
+  for (const auto &shard : shards) {
+    const std::lock_guard<std::mutex> lock(shard.mutex);
+    ret += shard.files.size();
+  }
+  return ret;
+}
+
+namespace {
+/// Files created by a thread within one emission scope of a payload.
+struct PendingEmission {
+  const Payload *payload;
+  std::vector<fs::path> fileNames;
+};
+
+/// Emission scopes opened on the current thread, innermost last. Targets may
+/// wait on the thread pool while emitting, which can run another target's
+/// emission on the same thread, hence a stack rather than a single entry.
+thread_local std::vector<PendingEmission> pendingEmissions;
+} // anonymous namespace
+
+Payload::EmissionScope::EmissionScope(Payload &payload) : payload(payload) {
+  if (!payload.isStreaming())
+    return;
+  pendingEmissions.push_back({&payload, {}});
+  active = true;
+}
+
+Payload::EmissionScope::~EmissionScope() {
+  // Files of an uncommitted scope stay in the payload and are written by
+  // finishStreaming.
+  if (active)
+    pendingEmissions.pop_back();
+}
+
+llvm::Error Payload::EmissionScope::commit() {
+  if (!active)
+    return llvm::Error::success();
+  active = false;
+
+  std::vector<fs::path> fileNames =
+      std::move(pendingEmissions.back().fileNames);
+  pendingEmissions.pop_back();
+  std::sort(fileNames.begin(), fileNames.end());
+  fileNames.erase(std::unique(fileNames.begin(), fileNames.end()),
+                  fileNames.end());
+  return payload.streamFiles(fileNames);
+}
+
 auto Payload::getFile(const std::string &fName) -> std::string * {
-  const std::lock_guard<std::mutex> lock(_mtx);
   const std::string key = prefix + fName;
-  files.try_emplace(key);
-  return &files[key];
+  noteFileCreated(key);
+  return &files.getOrCreate(key).getString();
 }
 
 auto Payload::getFile(const char *fName) -> std::string * {
-  const std::lock_guard<std::mutex> lock(_mtx);
   const std::string key = prefix + fName;
-  files.try_emplace(key);
-  return &files[key];
+  noteFileCreated(key);
+  return &files.getOrCreate(key).getString();
+}
+
+void Payload::addFile(llvm::StringRef filename, std::string &&contents) {
+  setFile(filename.str(), PayloadFile(std::move(contents)));
+}
+
+void Payload::addFile(llvm::StringRef filename,
+                      std::unique_ptr<llvm::MemoryBuffer> contents) {
+  setFile(filename.str(), PayloadFile(std::move(contents)));
+}
+
+void Payload::addFile(llvm::StringRef filename, std::vector<char> &&contents) {
+  setFile(filename.str(), PayloadFile(std::move(contents)));
+}
+
+void Payload::setFile(const fs::path &fName, PayloadFile contents) {
+  noteFileCreated(fName);
+  files.set(fName, std::move(contents));
+}
+
+void Payload::noteFileCreated(const fs::path &fName) {
+  if (!streaming || pendingEmissions.empty() ||
+      pendingEmissions.back().payload != this)
+    return;
+  pendingEmissions.back().fileNames.push_back(fName);
+}
+
+llvm::Error Payload::streamFiles(llvm::ArrayRef<fs::path> fNames) {
+  llvm::Error errs = llvm::Error::success();
+  for (const auto &fName : fNames) {
+    std::optional<PayloadFile> contents = files.take(fName);
+    if (!contents)
+      continue;
+    errs = llvm::joinErrors(std::move(errs), streamFile(fName, *contents));
+  }
+  return errs;
+}
+
+llvm::Error Payload::beginStreaming(llvm::raw_ostream &stream) {
+  return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                 "Payload " + name +
+                                     " does not support streaming output");
+}
+
+llvm::Error Payload::finishStreaming() {
+  return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                 "Payload " + name +
+                                     " does not support streaming output");
+}
+
+llvm::Error Payload::setCompression(llvm::StringRef spec) {
+  if (spec.empty())
+    return llvm::Error::success();
+  return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                 "Payload " + name +
+                                     " does not support compression");
+}
+
+llvm::Error Payload::streamFile(const fs::path &fName,
+                                const PayloadFile &contents) {
+  return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                 "Payload " + name +
+                                     " does not support streaming output");
 }
 
 auto Payload::orderedFileNames() -> std::vector<fs::path> {
-  const std::lock_guard<std::mutex> lock(_mtx);
-  std::vector<fs::path> ret;
-  ret.reserve(files.size());
-  for (auto &filePair : files)
-    ret.emplace_back(filePair.first);
-  std::sort(ret.begin(), ret.end());
-  return ret;
+  return files.orderedNames();
+}
+
+llvm::Error PatchablePayload::patchMember(llvm::StringRef path,
+                                          uint64_t offset,
+                                          llvm::ArrayRef<char> bytes) {
+  auto member = readMember(path);
+  if (!member)
+    return member.takeError();
+
+  auto &buf = member.get();
+  if (offset + bytes.size() > buf.size())
+    return llvm::createStringError(
+        llvm::inconvertibleErrorCode(),
+        "Patch at offset " + llvm::Twine(offset) + " of " +
+            llvm::Twine(bytes.size()) + " bytes exceeds the size of " + path);
+  std::copy(bytes.begin(), bytes.end(), buf.begin() + offset);
+  return llvm::Error::success();
+}
+
+llvm::Expected<llvm::StringRef>
+PatchablePayload::viewMember(llvm::StringRef path) {
+  auto member = readMember(path, /*markForWriteBack=*/false);
+  if (!member)
+    return member.takeError();
+  return llvm::StringRef(member->data(), member->size());
 }
@@ -0,0 +1,156 @@
+//===- PayloadBuffer.cpp ----------------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+//
+// Implements the PayloadBuffer class
+//
+//===----------------------------------------------------------------------===//
+
+#include "Payload/PayloadBuffer.h"
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Process.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <variant>
+
+using namespace qssc::payload;
+
+namespace {
+std::atomic<uint64_t> bytesCopied{0};
+} // anonymous namespace
+
+PayloadBuffer PayloadBuffer::borrow(llvm::StringRef data) {
+  return PayloadBuffer(data);
+}
+
+PayloadBuffer PayloadBuffer::adopt(std::string data) {
+  return PayloadBuffer(std::move(data));
+}
+
+PayloadBuffer PayloadBuffer::copy(llvm::StringRef data) {
+  noteBytesCopied(data.size());
+  return PayloadBuffer(data.str());
+}
+
+llvm::Expected<PayloadBuffer> PayloadBuffer::mapFile(llvm::StringRef path,
+                                                     bool writable) {
+  uint64_t size;
+  if (auto ec = llvm::sys::fs::file_size(path, size))
+    return llvm::createFileError(path, ec);
+  // a file cannot be mapped with a size of zero
+  if (size == 0)
+    return PayloadBuffer(std::string());
+
+  int fd;
+  std::error_code ec =
+      writable ? llvm::sys::fs::openFileForReadWrite(
+                     path, fd, llvm::sys::fs::CD_OpenExisting,
+                     llvm::sys::fs::OF_None)
+               : llvm::sys::fs::openFileForRead(path, fd);
+  if (ec)
+    return llvm::createFileError(path, ec);
+
+  // the mapping remains valid after the descriptor is closed
+  auto mapping = std::make_unique<Mapping>(Mapping{
+      llvm::sys::fs::mapped_file_region(
+          llvm::sys::fs::convertFDToNativeFile(fd),
+          writable ? llvm::sys::fs::mapped_file_region::readwrite
+                   : llvm::sys::fs::mapped_file_region::readonly,
+          size, 0, ec),
+      writable});
+  llvm::sys::Process::SafelyCloseFileDescriptor(fd);
+  if (ec)
+    return llvm::createFileError(path, ec);
+  return PayloadBuffer(std::move(mapping));
+}
+
+llvm::Error PayloadBuffer::copyFile(llvm::StringRef from,
+                                    llvm::StringRef to) {
+  uint64_t size = 0;
+  if (auto ec = llvm::sys::fs::file_size(from, size))
+    return llvm::createFileError(from, ec);
+  if (auto ec = llvm::sys::fs::copy_file(from, to))
+    return llvm::createFileError(to, ec);
+  noteBytesCopied(size);
+  return llvm::Error::success();
+}
+
+llvm::StringRef PayloadBuffer::getData() const {
+  return std::visit(
+      llvm::makeVisitor(
+          [](llvm::StringRef data) { return data; },
+          [](const std::string &data) { return llvm::StringRef(data); },
+          [](const std::unique_ptr<Mapping> &mapping) {
+            return llvm::StringRef(mapping->region.const_data(),
+                                   mapping->region.size());
+          }),
+      storage);
+}
+
+llvm::MutableArrayRef<char> PayloadBuffer::getMutableData() {
+  if (auto *mapping = std::get_if<std::unique_ptr<Mapping>>(&storage))
+    if ((*mapping)->writable)
+      return {(*mapping)->region.data(), (*mapping)->region.size()};
+
+  if (!std::holds_alternative<std::string>(storage)) {
+    // copy on write
+    auto data = getData();
+    noteBytesCopied(data.size());
+    storage = data.str();
+  }
+  auto &data = std::get<std::string>(storage);
+  return {data.data(), data.size()};
+}
+
+std::string PayloadBuffer::takeString() {
+  if (auto *data = std::get_if<std::string>(&storage))
+    return std::move(*data);
+  auto data = getData();
+  noteBytesCopied(data.size());
+  return data.str();
+}
+
+llvm::Error PayloadBuffer::writeToFile(llvm::StringRef path) const {
+  std::error_code ec;
+  llvm::raw_fd_ostream out(path, ec);
+  if (ec)
+    return llvm::createFileError(path, ec);
+  auto data = getData();
+  out << data;
+  out.close();
+  if (out.has_error())
+    return llvm::createFileError(path, out.error());
+  noteBytesCopied(data.size());
+  return llvm::Error::success();
+}
+
+uint64_t PayloadBuffer::getBytesCopied() { return bytesCopied.load(); }
+
+void PayloadBuffer::resetBytesCopied() { bytesCopied.store(0); }
+
+void PayloadBuffer::noteBytesCopied(uint64_t numBytes) {
+  bytesCopied.fetch_add(numBytes, std::memory_order_relaxed);
+}
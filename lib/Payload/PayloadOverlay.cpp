@@ -0,0 +1,298 @@
+//===- PayloadOverlay.cpp ---------------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+//
+// Implements payload overlays
+//
+//===----------------------------------------------------------------------===//
+
+#include "Payload/PayloadOverlay.h"
+
+#include "Payload/Payload.h"
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/STLFunctionalExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/Twine.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/EndianStream.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Support/xxhash.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace qssc::payload;
+using llvm::support::endian::read32le;
+using llvm::support::endian::read64le;
+
+namespace {
+constexpr llvm::StringLiteral overlayMagic = "QSSC_OVL";
+constexpr size_t headerSize = 24;
+constexpr size_t patchHeaderSize = 16;
+/// Changed bytes separated by fewer unchanged bytes than a patch header are
+/// recorded as one patch
+constexpr size_t minPatchGap = patchHeaderSize;
+
+llvm::Error malformed(const llvm::Twine &what) {
+  return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                 "Malformed payload overlay: " + what);
+}
+
+llvm::Error outOfBounds(llvm::StringRef member, uint64_t offset,
+                        size_t numBytes) {
+  return llvm::createStringError(
+      llvm::inconvertibleErrorCode(),
+      "Patch at offset " + llvm::Twine(offset) + " of " +
+          llvm::Twine(numBytes) + " bytes exceeds the size of " + member);
+}
+
+/// Record the runs of bytes that differ between original and changed
+void addChangedRuns(PayloadOverlay &overlay, llvm::StringRef member,
+                    llvm::ArrayRef<char> original,
+                    llvm::ArrayRef<char> changed) {
+  size_t const size = changed.size();
+  size_t pos = 0;
+  while (pos < size) {
+    if (original[pos] == changed[pos]) {
+      ++pos;
+      continue;
+    }
+    size_t const begin = pos;
+    size_t end = pos + 1;
+    for (pos = end; pos < size && pos - end < minPatchGap; ++pos)
+      if (original[pos] != changed[pos])
+        end = pos + 1;
+    overlay.addPatch(member, begin, changed.slice(begin, end - begin));
+  }
+}
+} // anonymous namespace
+
+uint64_t PayloadOverlay::hashBase(llvm::StringRef base) {
+  return llvm::xxh3_64bits(llvm::arrayRefFromStringRef(base));
+}
+
+llvm::Error PayloadOverlay::verifyBase(llvm::StringRef base) const {
+  if (hashBase(base) != baseHash)
+    return llvm::createStringError(
+        llvm::inconvertibleErrorCode(),
+        "Payload overlay does not apply to the given base payload");
+  return llvm::Error::success();
+}
+
+void PayloadOverlay::addPatch(llvm::StringRef member, uint64_t offset,
+                              llvm::ArrayRef<char> bytes) {
+  patches.push_back(Patch{member.str(), offset, bytes.vec()});
+}
+
+llvm::Error PayloadOverlay::apply(PatchablePayload &payload) const {
+  for (auto const &patch : patches)
+    if (auto err = payload.patchMember(patch.member, patch.offset, patch.bytes))
+      return err;
+  return llvm::Error::success();
+}
+
+std::string PayloadOverlay::serialize() const {
+  std::string out;
+  llvm::raw_string_ostream stream(out);
+  llvm::support::endian::Writer writer(stream, llvm::support::little);
+
+  stream << overlayMagic;
+  writer.write<uint32_t>(version);
+  writer.write<uint32_t>(patches.size());
+  writer.write<uint64_t>(baseHash);
+  for (auto const &patch : patches) {
+    writer.write<uint32_t>(patch.member.size());
+    writer.write<uint32_t>(patch.bytes.size());
+    writer.write<uint64_t>(patch.offset);
+    stream << patch.member;
+    stream.write(patch.bytes.data(), patch.bytes.size());
+  }
+
+  stream.flush();
+  return out;
+}
+
+bool PayloadOverlay::isOverlay(llvm::StringRef buffer) {
+  return buffer.startswith(overlayMagic);
+}
+
+llvm::Expected<PayloadOverlay>
+PayloadOverlay::deserialize(llvm::StringRef buffer) {
+  if (buffer.size() < headerSize || !isOverlay(buffer))
+    return malformed("missing header");
+  const char *data = buffer.data();
+  if (read32le(data + 8) != version)
+    return malformed("unsupported version " + llvm::Twine(read32le(data + 8)));
+  uint32_t const numPatches = read32le(data + 12);
+
+  PayloadOverlay overlay(read64le(data + 16));
+  uint64_t pos = headerSize;
+  for (uint32_t i = 0; i < numPatches; ++i) {
+    if (pos + patchHeaderSize > buffer.size())
+      return malformed("truncated patch " + llvm::Twine(i));
+    uint64_t const memberSize = read32le(data + pos);
+    uint64_t const numBytes = read32le(data + pos + 4);
+    uint64_t const offset = read64le(data + pos + 8);
+    pos += patchHeaderSize;
+    if (pos + memberSize + numBytes > buffer.size())
+      return malformed("truncated patch " + llvm::Twine(i));
+    overlay.addPatch(buffer.substr(pos, memberSize), offset,
+                     llvm::ArrayRef<char>(data + pos + memberSize, numBytes));
+    pos += memberSize + numBytes;
+  }
+  if (pos != buffer.size())
+    return malformed("trailing data");
+  return overlay;
+}
+
+OverlayPayload::OverlayPayload(PatchablePayload &base, PayloadOverlay overlay)
+    : base(base), overlay(std::move(overlay)) {
+  auto patches = this->overlay.getPatches();
+  for (size_t i = 0; i < patches.size(); ++i)
+    patchesByMember[patches[i].member].push_back(i);
+}
+
+llvm::Expected<PatchablePayload::ContentBuffer &>
+OverlayPayload::readMember(llvm::StringRef path, bool markForWriteBack) {
+  auto patchIndices = patchesByMember.find(path);
+  if (patchIndices == patchesByMember.end())
+    return base.readMember(path, /*markForWriteBack=*/false);
+
+  auto cached = patchedMembers.find(path);
+  if (cached != patchedMembers.end())
+    return cached->second;
+
+  auto member = base.readMember(path, /*markForWriteBack=*/false);
+  if (!member)
+    return member.takeError();
+  ContentBuffer patched = *member;
+  for (size_t const index : patchIndices->second) {
+    auto const &patch = overlay.getPatches()[index];
+    if (patch.offset + patch.bytes.size() > patched.size())
+      return outOfBounds(path, patch.offset, patch.bytes.size());
+    llvm::copy(patch.bytes, patched.begin() + patch.offset);
+  }
+  return patchedMembers[path] = std::move(patched);
+}
+
+llvm::Error OverlayPayload::writeBack() {
+  return llvm::createStringError(
+      llvm::inconvertibleErrorCode(),
+      "Overlay payloads are read only, apply the overlay to a copy of the "
+      "base payload instead");
+}
+
+llvm::Error OverlayPayload::writeString(std::string *outputString) {
+  return writeBack();
+}
+
+OverlayRecordingPayload::OverlayRecordingPayload(PatchablePayload &base,
+                                                 uint64_t baseHash,
+                                                 std::mutex *baseMutex)
+    : base(base), baseMutex(baseMutex), overlay(baseHash) {}
+
+llvm::Error OverlayRecordingPayload::withBaseMember(
+    llvm::StringRef path,
+    llvm::function_ref<void(const ContentBuffer &)> fn) {
+  std::unique_lock<std::mutex> lock;
+  if (baseMutex)
+    lock = std::unique_lock<std::mutex>(*baseMutex);
+  auto member = base.readMember(path, /*markForWriteBack=*/false);
+  if (!member)
+    return member.takeError();
+  fn(*member);
+  return llvm::Error::success();
+}
+
+llvm::Expected<PatchablePayload::ContentBuffer &>
+OverlayRecordingPayload::readMember(llvm::StringRef path,
+                                    bool markForWriteBack) {
+  auto pos = members.find(path);
+  if (pos == members.end()) {
+    ContentBuffer copy;
+    if (auto err = withBaseMember(
+            path, [&](const ContentBuffer &member) { copy = member; }))
+      return std::move(err);
+    pos = members.try_emplace(path, TrackedMember{std::move(copy), false})
+              .first;
+  }
+  pos->second.writeBack |= markForWriteBack;
+  return pos->second.buf;
+}
+
+llvm::Error OverlayRecordingPayload::patchMember(llvm::StringRef path,
+                                                 uint64_t offset,
+                                                 llvm::ArrayRef<char> bytes) {
+  auto pos = members.find(path);
+  if (pos == members.end()) {
+    overlay.addPatch(path, offset, bytes);
+    return llvm::Error::success();
+  }
+
+  // the member has been read, so the patch is recorded with its other
+  // changes on writeBack
+  auto &tracked = pos->second;
+  if (offset + bytes.size() > tracked.buf.size())
+    return outOfBounds(path, offset, bytes.size());
+  llvm::copy(bytes, tracked.buf.begin() + offset);
+  tracked.writeBack = true;
+  return llvm::Error::success();
+}
+
+llvm::Error OverlayRecordingPayload::writeBack() {
+  // record members in order of their names so that overlays are
+  // reproducible
+  llvm::SmallVector<llvm::StringRef> names;
+  for (auto const &entry : members)
+    if (entry.second.writeBack)
+      names.push_back(entry.first());
+  llvm::sort(names);
+
+  for (auto name : names) {
+    auto &tracked = members.find(name)->second;
+    bool sizeChanged = false;
+    if (auto err = withBaseMember(name, [&](const ContentBuffer &original) {
+          sizeChanged = original.size() != tracked.buf.size();
+          if (!sizeChanged)
+            addChangedRuns(overlay, name, original, tracked.buf);
+        }))
+      return err;
+    if (sizeChanged)
+      return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                     "Payload overlays cannot change the "
+                                     "size of " +
+                                         name);
+    tracked.writeBack = false;
+  }
+  return llvm::Error::success();
+}
+
+llvm::Error OverlayRecordingPayload::writeString(std::string *outputString) {
+  if (outputString == nullptr) // no output buffer
+    return llvm::make_error<llvm::StringError>("outputString buffer is null",
+                                               llvm::inconvertibleErrorCode());
+  outputString->append(overlay.serialize());
+  return llvm::Error::success();
+}
@@ -21,19 +21,22 @@
 
 #include "Payload/PatchableZipPayload.h"
 
+#include "ZipArchiveIndex.h"
 #include "ZipUtil.h"
 
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/raw_ostream.h"
 
 #include <cassert>
 #include <cerrno>
+#include <cstdint>
 #include <cstdlib>
-#include <fstream>
 #include <memory>
 #include <optional>
-#include <sstream>
 #include <string>
 #include <system_error>
 #include <utility>
@@ -42,6 +45,37 @@
 
 namespace qssc::payload {
 
+struct PatchableZipPayload::InPlaceArchive {
+  PayloadBuffer buffer;
+  std::optional<ZipArchiveIndex> index;
+  bool indexUnavailable = false;
+  /// Whether any member has been patched in place
+  bool modified = false;
+};
+
+PatchableZipPayload::PatchableZipPayload(std::string path,
+                                         bool enableInMemory)
+    : path(enableInMemory ? std::string() : std::move(path)), zip(nullptr),
+      inMemoryZipSource(nullptr), enableInMemory(enableInMemory) {
+  if (enableInMemory)
+    inPlace = std::make_unique<InPlaceArchive>(
+        InPlaceArchive{PayloadBuffer::adopt(std::move(path))});
+}
+
+PatchableZipPayload::PatchableZipPayload(llvm::StringRef path,
+                                         bool enableInMemory)
+    : path(enableInMemory ? llvm::StringRef() : path), zip(nullptr),
+      inMemoryZipSource(nullptr), enableInMemory(enableInMemory) {
+  if (enableInMemory)
+    inPlace = std::make_unique<InPlaceArchive>(
+        InPlaceArchive{PayloadBuffer::copy(path)});
+}
+
+PatchableZipPayload::PatchableZipPayload(PayloadBuffer buffer)
+    : zip(nullptr), inMemoryZipSource(nullptr), enableInMemory(true),
+      inPlace(std::make_unique<InPlaceArchive>(
+          InPlaceArchive{std::move(buffer)})) {}
+
 llvm::Expected<std::string> readFileFromZip(zip_t *zip, zip_stat_t &zs) {
   auto *zipFile = zip_fopen_index(zip, zs.index, 0);
 
@@ -97,8 +131,9 @@ llvm::Error PatchableZipPayload::ensureOpen() {
   zip_error_init(&zipError);
 
   if (enableInMemory) {
+    auto data = inPlace->buffer.getData();
     zip_source_t *zs =
-        zip_source_buffer_create(path.data(), path.length(), 0, &zipError);
+        zip_source_buffer_create(data.data(), data.size(), 0, &zipError);
     if (zs == nullptr) {
       zip_error_set(&zipError, errorCode, errno);
       retVal = extractLibZipError(
@@ -157,9 +192,30 @@ llvm::Error PatchableZipPayload::addFileToZip(zip_t *zip,
 }
 
 llvm::Error PatchableZipPayload::writeBack() {
+  // in place patches are already part of the payload; unmap payload files
+  // so that the patches are visible to libzip
+  bool const patchedInPlace = inPlace && inPlace->modified;
+  if (!enableInMemory)
+    inPlace.reset();
+
   if (zip == nullptr) // no changes pending, thus no operation
     return llvm::Error::success();
 
+  bool const hasWriteBack = llvm::any_of(
+      files, [](const auto &item) { return item.second.writeBack; });
+  if (!hasWriteBack) {
+    discardChanges();
+    return llvm::Error::success();
+  }
+
+  if (patchedInPlace) {
+    // libzip copies unchanged members using the checksums it read when the
+    // archive was opened, so reopen it to pick up the patched checksums
+    discardChanges();
+    if (auto err = ensureOpen())
+      return err;
+  }
+
   zip_error_t err;
 
   zip_error_init(&err);
@@ -186,6 +242,21 @@ llvm::Error PatchableZipPayload::writeBack() {
   }
 
   zip = nullptr;
+
+  if (inMemoryZipSource) {
+    // libzip wrote the rewritten payload to the source, which replaces the
+    // in memory payload
+    zip_int64_t size;
+    char *data = qssc::payload::read_zip_src_to_buffer(inMemoryZipSource, size);
+    zip_source_free(inMemoryZipSource);
+    inMemoryZipSource = nullptr;
+    if (!data)
+      return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                     "Failed to read rewritten payload");
+    inPlace = std::make_unique<InPlaceArchive>(
+        InPlaceArchive{PayloadBuffer::copy(llvm::StringRef(data, size))});
+    free(data);
+  }
   return llvm::Error::success();
 }
 
@@ -194,30 +265,21 @@ llvm::Error PatchableZipPayload::writeString(std::string *outputString) {
     return llvm::make_error<llvm::StringError>("outputString buffer is null",
                                                llvm::inconvertibleErrorCode());
 
-  std::optional<llvm::raw_string_ostream> outStringStream;
-  outStringStream.emplace(*outputString);
-  llvm::raw_ostream *ostream = std::addressof(outStringStream.value());
-  ;
-
-  if (inMemoryZipSource) {
-    // read from in memory source
-    zip_int64_t sz;
-    char *outbuffer =
-        qssc::payload::read_zip_src_to_buffer(inMemoryZipSource, sz);
-    if (outbuffer) {
-      ostream->write(outbuffer, sz);
-      free(outbuffer);
-    }
-    zip_source_free(inMemoryZipSource);
-    inMemoryZipSource = nullptr;
+  std::string payload;
+  if (enableInMemory) {
+    payload = inPlace->buffer.takeString();
   } else {
     // re-read file from disk
-    std::ostringstream buf;
-    std::ifstream const input(path.c_str());
-    buf << input.rdbuf();
-    ostream->write(buf.str().c_str(), buf.str().length());
+    auto buffer = PayloadBuffer::mapFile(path, /*writable=*/false);
+    if (!buffer)
+      return buffer.takeError();
+    payload = buffer->takeString();
   }
-  ostream->flush();
+
+  if (outputString->empty())
+    *outputString = std::move(payload);
+  else
+    outputString->append(payload);
   return llvm::Error::success();
 }
 
@@ -281,6 +343,85 @@ PatchableZipPayload::readMember(llvm::StringRef path, bool markForWriteBack) {
   return ins.first->second.buf;
 }
 
+auto PatchableZipPayload::getInPlaceArchive() -> InPlaceArchive * {
+  if (!inPlace) {
+    if (enableInMemory || mappingUnavailable)
+      return nullptr;
+    auto buffer = PayloadBuffer::mapFile(path, /*writable=*/true);
+    if (!buffer) {
+      // fall back to patching through libzip, which reports any real
+      // problem with the file
+      llvm::consumeError(buffer.takeError());
+      mappingUnavailable = true;
+      return nullptr;
+    }
+    inPlace = std::make_unique<InPlaceArchive>(
+        InPlaceArchive{std::move(buffer.get())});
+  }
+
+  if (!inPlace->index && !inPlace->indexUnavailable) {
+    auto index = ZipArchiveIndex::create(
+        llvm::arrayRefFromStringRef<char>(inPlace->buffer.getData()));
+    if (index) {
+      inPlace->index = std::move(index.get());
+    } else {
+      llvm::consumeError(index.takeError());
+      inPlace->indexUnavailable = true;
+    }
+  }
+  return inPlace->index ? inPlace.get() : nullptr;
+}
+
+llvm::Error PatchableZipPayload::patchMember(llvm::StringRef path,
+                                             uint64_t offset,
+                                             llvm::ArrayRef<char> bytes) {
+  // members read for write back must be patched in their buffer, which
+  // replaces the member on writeBack
+  auto tracked = files.find(path.str());
+  if (tracked == files.end() || !tracked->second.writeBack) {
+    if (auto *archive = getInPlaceArchive()) {
+      llvm::StringRef memberName = path;
+      if (enableInMemory && !archive->index->lookup(memberName))
+        // in memory payload does not have leading directory so attempt to
+        // remove
+        memberName = memberName.substr(memberName.find('/') + 1);
+      const auto *member = archive->index->lookup(memberName);
+      if (member && member->isPatchableInPlace()) {
+        archive->modified = true;
+        return archive->index->patch(archive->buffer.getMutableData(),
+                                     memberName, offset, bytes);
+      }
+    }
+  }
+
+  if (auto err = ensureOpen())
+    return err;
+  return PatchablePayload::patchMember(path, offset, bytes);
+}
+
+llvm::Expected<llvm::StringRef>
+PatchableZipPayload::viewMember(llvm::StringRef path) {
+  // members read for write back may have been changed in their buffer
+  auto tracked = files.find(path.str());
+  if (tracked == files.end() || !tracked->second.writeBack) {
+    if (auto *archive = getInPlaceArchive()) {
+      llvm::StringRef memberName = path;
+      if (enableInMemory && !archive->index->lookup(memberName))
+        // in memory payload does not have leading directory so attempt to
+        // remove
+        memberName = memberName.substr(memberName.find('/') + 1);
+      const auto *member = archive->index->lookup(memberName);
+      if (member && member->isPatchableInPlace())
+        return archive->buffer.getData().substr(member->dataOffset,
+                                                member->uncompressedSize);
+    }
+  }
+
+  if (auto err = ensureOpen())
+    return std::move(err);
+  return PatchablePayload::viewMember(path);
+}
+
 PatchableZipPayload::~PatchableZipPayload() {
   // discard any leftover changes that have not been written back
   if (zip)
@@ -0,0 +1,221 @@
+//===- ZipArchiveIndex.cpp --------------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// Implements the ZipArchiveIndex class
+///
+//===----------------------------------------------------------------------===//
+
+#include "ZipArchiveIndex.h"
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/Twine.h"
+#include "llvm/Support/CRC.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/Error.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+
+using namespace qssc::payload;
+using llvm::support::endian::read16le;
+using llvm::support::endian::read32le;
+using llvm::support::endian::write32le;
+
+namespace {
+constexpr uint32_t localFileHeaderSignature = 0x04034b50;
+constexpr uint32_t centralDirectorySignature = 0x02014b50;
+constexpr uint32_t endOfCentralDirectorySignature = 0x06054b50;
+constexpr uint64_t localFileHeaderSize = 30;
+constexpr uint64_t centralDirectoryEntrySize = 46;
+constexpr uint64_t endOfCentralDirectorySize = 22;
+constexpr uint64_t maxCommentSize = std::numeric_limits<uint16_t>::max();
+/// Offset of the CRC-32 in the local and central headers respectively
+constexpr uint64_t localCrcOffset = 14;
+constexpr uint64_t centralCrcOffset = 16;
+/// General purpose flag indicating sizes and CRC follow the data
+constexpr uint16_t dataDescriptorFlag = 1 << 3;
+constexpr uint16_t compressionStore = 0;
+/// Reversed CRC-32 polynomial used by zip
+constexpr uint32_t crc32Polynomial = 0xedb88320;
+
+llvm::Error malformed(const llvm::Twine &what) {
+  return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                 "Malformed zip archive: " + what);
+}
+
+/// Multiply a and b modulo the CRC-32 polynomial in the bit reversed
+/// representation used by the checksum, where x^0 is the top bit.
+uint32_t multiplyModP(uint32_t a, uint32_t b) {
+  uint32_t product = 0;
+  for (uint32_t mask = 1U << 31; mask != 0; mask >>= 1) {
+    if (a & mask)
+      product ^= b;
+    b = (b & 1) ? (b >> 1) ^ crc32Polynomial : b >> 1;
+  }
+  return product;
+}
+
+/// Compute x^(8 * numBytes) modulo the CRC-32 polynomial, i.e. the factor
+/// that appending numBytes zero bytes applies to a raw CRC remainder.
+uint32_t zeroBytesFactor(uint64_t numBytes) {
+  uint32_t factor = 1U << 31;     // x^0
+  uint32_t power = 1U << (31 - 8); // x^8
+  for (; numBytes != 0; numBytes >>= 1) {
+    if (numBytes & 1)
+      factor = multiplyModP(power, factor);
+    power = multiplyModP(power, power);
+  }
+  return factor;
+}
+} // anonymous namespace
+
+uint32_t qssc::payload::updateCrc32(uint32_t crc, uint64_t size,
+                                    uint64_t offset,
+                                    llvm::ArrayRef<char> oldBytes,
+                                    llvm::ArrayRef<char> newBytes) {
+  assert(oldBytes.size() == newBytes.size() && "patch must keep the size");
+  assert(offset + newBytes.size() <= size && "patch must be in bounds");
+
+  // The checksum is affine in the data: for equally sized buffers the
+  // checksums of a and b differ by the raw remainder of a ^ b, which is zero
+  // outside of the patch. Leading zeros do not change a raw remainder and
+  // trailing zeros multiply it by a power of x.
+  llvm::SmallVector<uint8_t> delta(newBytes.size());
+  for (size_t i = 0; i < delta.size(); ++i)
+    delta[i] = static_cast<uint8_t>(oldBytes[i] ^ newBytes[i]);
+  llvm::SmallVector<uint8_t> const zeros(newBytes.size(), 0);
+  uint32_t const deltaRemainder = llvm::crc32(delta) ^ llvm::crc32(zeros);
+
+  uint64_t const trailingBytes = size - offset - newBytes.size();
+  return crc ^ multiplyModP(zeroBytesFactor(trailingBytes), deltaRemainder);
+}
+
+bool ZipArchiveIndex::Member::isPatchableInPlace() const {
+  return method == compressionStore && !(flags & dataDescriptorFlag) &&
+         compressedSize == uncompressedSize;
+}
+
+llvm::Expected<ZipArchiveIndex>
+ZipArchiveIndex::create(llvm::ArrayRef<char> archive) {
+  uint64_t const size = archive.size();
+  if (size < endOfCentralDirectorySize)
+    return malformed("too small");
+
+  // The end of central directory record is followed by a variable length
+  // comment, so search backwards for its signature.
+  const char *data = archive.data();
+  uint64_t const searchEnd =
+      size - endOfCentralDirectorySize -
+      std::min(size - endOfCentralDirectorySize, maxCommentSize);
+  std::optional<uint64_t> eocdOffset;
+  for (uint64_t pos = size - endOfCentralDirectorySize + 1; pos-- > searchEnd;)
+    if (read32le(data + pos) == endOfCentralDirectorySignature &&
+        pos + endOfCentralDirectorySize + read16le(data + pos + 20) == size) {
+      eocdOffset = pos;
+      break;
+    }
+  if (!eocdOffset)
+    return malformed("no end of central directory record");
+
+  const char *eocd = data + *eocdOffset;
+  uint64_t const numEntries = read16le(eocd + 10);
+  uint64_t const centralDirectorySize = read32le(eocd + 12);
+  uint64_t const centralDirectoryOffset = read32le(eocd + 16);
+  if (numEntries == std::numeric_limits<uint16_t>::max() ||
+      centralDirectoryOffset == std::numeric_limits<uint32_t>::max())
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "zip64 archives are not supported");
+  if (centralDirectoryOffset + centralDirectorySize > *eocdOffset)
+    return malformed("central directory out of bounds");
+
+  ZipArchiveIndex index;
+  uint64_t pos = centralDirectoryOffset;
+  for (uint64_t entry = 0; entry < numEntries; ++entry) {
+    if (pos + centralDirectoryEntrySize > *eocdOffset ||
+        read32le(data + pos) != centralDirectorySignature)
+      return malformed("bad central directory entry");
+    const char *header = data + pos;
+    uint64_t const nameSize = read16le(header + 28);
+    uint64_t const entrySize = centralDirectoryEntrySize + nameSize +
+                               read16le(header + 30) + read16le(header + 32);
+    if (pos + entrySize > *eocdOffset)
+      return malformed("central directory entry out of bounds");
+
+    Member member;
+    member.centralHeaderOffset = pos;
+    member.flags = read16le(header + 8);
+    member.method = read16le(header + 10);
+    member.crc = read32le(header + centralCrcOffset);
+    member.compressedSize = read32le(header + 20);
+    member.uncompressedSize = read32le(header + 24);
+    member.localHeaderOffset = read32le(header + 42);
+    llvm::StringRef const name(header + centralDirectoryEntrySize, nameSize);
+
+    uint64_t const localOffset = member.localHeaderOffset;
+    if (localOffset + localFileHeaderSize > centralDirectoryOffset ||
+        read32le(data + localOffset) != localFileHeaderSignature)
+      return malformed("bad local header for " + name);
+    member.dataOffset = localOffset + localFileHeaderSize +
+                        read16le(data + localOffset + 26) +
+                        read16le(data + localOffset + 28);
+    if (member.dataOffset + member.compressedSize > centralDirectoryOffset)
+      return malformed("data out of bounds for " + name);
+
+    index.members[name] = member;
+    pos += entrySize;
+  }
+  return index;
+}
+
+auto ZipArchiveIndex::lookup(llvm::StringRef name) const -> const Member * {
+  auto pos = members.find(name);
+  return pos == members.end() ? nullptr : &pos->second;
+}
+
+llvm::Error ZipArchiveIndex::patch(llvm::MutableArrayRef<char> archive,
+                                   llvm::StringRef name, uint64_t offset,
+                                   llvm::ArrayRef<char> bytes) {
+  auto pos = members.find(name);
+  if (pos == members.end())
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "No member " + name + " in zip archive");
+  auto &member = pos->second;
+  if (!member.isPatchableInPlace())
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "Member " + name +
+                                       " is not stored uncompressed");
+  if (offset + bytes.size() > member.uncompressedSize)
+    return llvm::createStringError(
+        llvm::inconvertibleErrorCode(),
+        "Patch at offset " + llvm::Twine(offset) + " of " +
+            llvm::Twine(bytes.size()) + " bytes exceeds the size of " + name);
+
+  auto target = archive.slice(member.dataOffset + offset, bytes.size());
+  member.crc = updateCrc32(member.crc, member.uncompressedSize, offset,
+                           target, bytes);
+  std::copy(bytes.begin(), bytes.end(), target.begin());
+  write32le(archive.data() + member.localHeaderOffset + localCrcOffset,
+            member.crc);
+  write32le(archive.data() + member.centralHeaderOffset + centralCrcOffset,
+            member.crc);
+  return llvm::Error::success();
+}
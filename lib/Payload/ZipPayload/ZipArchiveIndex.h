@@ -0,0 +1,82 @@
+//===- ZipArchiveIndex.h ----------------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// Declares an index over the members of a zip archive held in memory, used
+/// to patch stored members in place.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef PAYLOAD_ZIPARCHIVEINDEX_H
+#define PAYLOAD_ZIPARCHIVEINDEX_H
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+
+#include <cstdint>
+
+namespace qssc::payload {
+
+/// @brief Index of the members of a zip archive, built from its central
+/// directory. The index does not own the archive; it records offsets into
+/// the archive it was created from.
+class ZipArchiveIndex {
+public:
+  struct Member {
+    uint64_t localHeaderOffset;
+    uint64_t centralHeaderOffset;
+    uint64_t dataOffset;
+    uint32_t compressedSize;
+    uint32_t uncompressedSize;
+    uint32_t crc;
+    uint16_t method;
+    uint16_t flags;
+
+    /// @brief Whether the member is stored uncompressed without a trailing
+    /// data descriptor, so that its data and checksums can be patched in
+    /// place.
+    bool isPatchableInPlace() const;
+  };
+
+  /// @brief Index archive. Fails for malformed archives and for archives
+  /// that use zip64 extensions.
+  static llvm::Expected<ZipArchiveIndex> create(llvm::ArrayRef<char> archive);
+
+  /// @brief Get the member named name or nullptr if there is none
+  const Member *lookup(llvm::StringRef name) const;
+
+  /// @brief Overwrite bytes of a stored member of archive starting at offset
+  /// within the member and update the member checksum in its local and
+  /// central headers. The cost is independent of the size of the member.
+  /// @param archive The archive this index was created from
+  llvm::Error patch(llvm::MutableArrayRef<char> archive, llvm::StringRef name,
+                    uint64_t offset, llvm::ArrayRef<char> bytes);
+
+private:
+  llvm::StringMap<Member> members;
+}; // class ZipArchiveIndex
+
+/// @brief Compute the CRC-32 of a buffer of size bytes with checksum crc
+/// after the bytes at offset are changed from oldBytes to newBytes, without
+/// reading the rest of the buffer.
+uint32_t updateCrc32(uint32_t crc, uint64_t size, uint64_t offset,
+                     llvm::ArrayRef<char> oldBytes,
+                     llvm::ArrayRef<char> newBytes);
+
+} // namespace qssc::payload
+
+#endif // PAYLOAD_ZIPARCHIVEINDEX_H
@@ -0,0 +1,148 @@
+//===- ZipCompression.cpp ---------------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// Implements the per-file compression policy of zip payloads
+///
+//===----------------------------------------------------------------------===//
+
+#include "ZipCompression.h"
+
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/StringSwitch.h"
+#include "llvm/Support/CRC.h"
+#include "llvm/Support/Compression.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/GlobPattern.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <utility>
+
+using namespace qssc::payload;
+
+namespace {
+/// Size of the zlib stream header preceding the raw deflate data
+constexpr size_t zlibHeaderSize = 2;
+/// Size of the adler32 checksum following the raw deflate data
+constexpr size_t zlibTrailerSize = 4;
+} // anonymous namespace
+
+llvm::Expected<ZipCompressionPolicy>
+ZipCompressionPolicy::parse(llvm::StringRef spec) {
+  ZipCompressionPolicy policy;
+  llvm::SmallVector<llvm::StringRef> ruleSpecs;
+  spec.split(ruleSpecs, ',', /*MaxSplit=*/-1, /*KeepEmpty=*/false);
+  for (auto ruleSpec : ruleSpecs) {
+    auto [glob, methodName] = ruleSpec.trim().rsplit('=');
+    auto method =
+        llvm::StringSwitch<std::optional<ZipCompression>>(methodName.trim())
+            .Case("store", ZipCompression::Store)
+            .Case("deflate", ZipCompression::Deflate)
+            .Case("zstd", ZipCompression::Zstd)
+            .Default(std::nullopt);
+    if (glob.empty() || !method.has_value())
+      return llvm::createStringError(
+          llvm::inconvertibleErrorCode(),
+          "Invalid payload compression rule '" + ruleSpec +
+              "', expected <glob>=<store|deflate|zstd>");
+    if (auto err = policy.addRule(glob.trim(), method.value()))
+      return std::move(err);
+  }
+  return policy;
+}
+
+llvm::Error ZipCompressionPolicy::addRule(llvm::StringRef glob,
+                                          ZipCompression method) {
+  if (method == ZipCompression::Deflate &&
+      !llvm::compression::zlib::isAvailable())
+    return llvm::createStringError(
+        llvm::inconvertibleErrorCode(),
+        "Deflate payload compression requires LLVM built with zlib");
+  if (method == ZipCompression::Zstd &&
+      !llvm::compression::zstd::isAvailable())
+    return llvm::createStringError(
+        llvm::inconvertibleErrorCode(),
+        "Zstd payload compression requires LLVM built with zstd");
+
+  auto pattern = llvm::GlobPattern::create(glob);
+  if (!pattern)
+    return pattern.takeError();
+  rules.emplace_back(std::move(pattern.get()), method);
+  return llvm::Error::success();
+}
+
+ZipCompression
+ZipCompressionPolicy::getCompression(llvm::StringRef path) const {
+  for (const auto &[pattern, method] : rules)
+    if (pattern.match(path))
+      return method;
+  return ZipCompression::Store;
+}
+
+bool ZipCompressionPolicy::compresses() const {
+  return llvm::any_of(rules, [](const auto &rule) {
+    return rule.second != ZipCompression::Store;
+  });
+}
+
+llvm::StringRef ZipMember::getData() const {
+  if (method == ZipCompression::Store)
+    return storedData;
+  return llvm::toStringRef(compressedData);
+}
+
+llvm::Expected<ZipMember>
+qssc::payload::prepareZipMember(llvm::StringRef data, ZipCompression method) {
+  ZipMember member;
+  member.uncompressedSize = data.size();
+  member.storedData = data;
+  member.crc = llvm::crc32(llvm::arrayRefFromStringRef(data));
+
+  switch (method) {
+  case ZipCompression::Store:
+    return member;
+  case ZipCompression::Deflate:
+    // zlib wraps raw deflate data, which is what zip members contain, in a
+    // fixed size header and trailer
+    llvm::compression::zlib::compress(llvm::arrayRefFromStringRef(data),
+                                      member.compressedData);
+    if (member.compressedData.size() < zlibHeaderSize + zlibTrailerSize)
+      return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                     "Unexpected zlib stream size");
+    member.compressedData.truncate(member.compressedData.size() -
+                                   zlibTrailerSize);
+    member.compressedData.erase(member.compressedData.begin(),
+                                member.compressedData.begin() +
+                                    zlibHeaderSize);
+    break;
+  case ZipCompression::Zstd:
+    llvm::compression::zstd::compress(llvm::arrayRefFromStringRef(data),
+                                      member.compressedData);
+    break;
+  }
+
+  if (member.compressedData.size() >= data.size()) {
+    // incompressible, store instead
+    member.compressedData.clear();
+    return member;
+  }
+  member.method = method;
+  return member;
+}
@@ -0,0 +1,85 @@
+//===- ZipCompression.h -----------------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// Declares the per-file compression policy of zip payloads
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef PAYLOAD_ZIPCOMPRESSION_H
+#define PAYLOAD_ZIPCOMPRESSION_H
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/GlobPattern.h"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace qssc::payload {
+
+/// @brief Compression methods supported for zip payload members. The values
+/// are the method identifiers of the zip specification.
+enum class ZipCompression : uint16_t { Store = 0, Deflate = 8, Zstd = 93 };
+
+/// @brief Maps payload file paths to the compression method to use for
+/// them. Rules are matched in order and the first matching glob wins. Files
+/// matching no rule are stored, which keeps them patchable in place.
+class ZipCompressionPolicy {
+public:
+  /// @brief Parse a policy specification of the form
+  /// "<glob>=<method>[,<glob>=<method>...]" where method is one of store,
+  /// deflate or zstd. An empty specification stores every file.
+  static llvm::Expected<ZipCompressionPolicy> parse(llvm::StringRef spec);
+
+  /// @brief Append a rule. Fails if the method is not available in this
+  /// build.
+  llvm::Error addRule(llvm::StringRef glob, ZipCompression method);
+
+  ZipCompression getCompression(llvm::StringRef path) const;
+
+  /// @brief Whether any file may be compressed under this policy
+  bool compresses() const;
+
+private:
+  std::vector<std::pair<llvm::GlobPattern, ZipCompression>> rules;
+}; // class ZipCompressionPolicy
+
+/// @brief A zip member whose checksum and compressed contents have been
+/// computed and which is ready to be written to an archive.
+struct ZipMember {
+  ZipCompression method = ZipCompression::Store;
+  uint32_t crc = 0;
+  uint64_t uncompressedSize = 0;
+  /// The contents of a stored member. References the caller's buffer.
+  llvm::StringRef storedData;
+  /// The contents of a compressed member
+  llvm::SmallVector<uint8_t, 0> compressedData;
+
+  /// @brief The bytes written to the archive for this member
+  llvm::StringRef getData() const;
+};
+
+/// @brief Checksum and compress data with method. Falls back to storing the
+/// data if compression does not make it smaller. The returned member
+/// references data when it is stored.
+llvm::Expected<ZipMember> prepareZipMember(llvm::StringRef data,
+                                           ZipCompression method);
+
+} // namespace qssc::payload
+
+#endif // PAYLOAD_ZIPCOMPRESSION_H
@@ -21,6 +21,8 @@
 #include "ZipPayload.h"
 
 #include "Payload/Payload.h"
+#include "ZipCompression.h"
+#include "ZipStreamWriter.h"
 #include "ZipUtil.h"
 
 #include "Config.h"
@@ -28,9 +30,12 @@
 #include <Config/QSSConfig.h>
 
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/raw_os_ostream.h"
 #include "llvm/Support/raw_ostream.h"
 
+#include <cstddef>
 #include <cstdint>
 #include <cstdlib>
 #include <filesystem>
@@ -44,6 +49,7 @@
 #include <string>
 // NOLINTNEXTLINE(misc-include-cleaner)
 #include <sys/stat.h>
+#include <utility>
 #include <vector>
 #include <zip.h>
 #include <zipconf.h>
@@ -66,24 +72,21 @@ int qssc::payload::init() {
 
 // creates a manifest json file and adds it to the file map
 void ZipPayload::addManifest() {
-  std::lock_guard<std::mutex> const lock(_mtx);
   std::string const manifest_fname = "manifest/manifest.json";
   nlohmann::json manifest;
   manifest["version"] = QSSC_VERSION;
   manifest["contents_path"] = prefix;
-  files[manifest_fname] = manifest.dump() + "\n";
+  files.set(manifest_fname, PayloadFile(manifest.dump() + "\n"));
 }
 
 void ZipPayload::addFile(llvm::StringRef filename, llvm::StringRef str) {
-  std::lock_guard<std::mutex> const lock(_mtx);
-  files[filename.str()] = str;
+  setFile(filename.str(), PayloadFile(str.str()));
 }
 
 void ZipPayload::writePlain(const std::string &dirName) {
-  std::lock_guard<std::mutex> const lock(_mtx);
-  for (const auto &filePair : files) {
+  for (const auto &fileName : orderedFileNames()) {
     fs::path fName(dirName);
-    fName /= filePair.first;
+    fName /= fileName;
 
     fs::create_directories(fName.parent_path());
     std::ofstream fStream(fName, std::ofstream::out);
@@ -91,7 +94,9 @@ void ZipPayload::writePlain(const std::string &dirName) {
       llvm::errs() << "Unable to open output file " << fName << "\n";
       continue;
     }
-    fStream << filePair.second;
+    llvm::StringRef const contents = files.getOrCreate(fileName).getBuffer();
+    fStream.write(contents.data(),
+                  static_cast<std::streamsize>(contents.size()));
     fStream.close();
   }
 }
@@ -107,8 +112,9 @@ void ZipPayload::writePlain(llvm::raw_ostream &stream) {
   stream << "------------------------------------------\n";
   for (auto &fName : orderedNames) {
     stream << "File: " << fName << "\n";
-    stream << files[fName];
-    if (*(files[fName].rbegin()) != '\n')
+    llvm::StringRef const contents = files.getOrCreate(fName).getBuffer();
+    stream << contents;
+    if (!contents.endswith("\n"))
       stream << "\n";
     stream << "------------------------------------------\n";
   }
@@ -146,9 +152,34 @@ void setFilePermissions(zip_int64_t fileIndex, fs::path &fName,
                                      attributes);
   }
 }
+
+// Unix mode matching the attributes setFilePermissions applies to libzip's
+// defaults: no group or other write, and user execute for scripts.
+uint32_t zipFileMode(const fs::path &fName) {
+  // NOLINTNEXTLINE(misc-include-cleaner)
+  uint32_t mode = S_IFREG | S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH;
+  if (fName.has_extension() && fName.extension() == ".sh")
+    // NOLINTNEXTLINE(misc-include-cleaner)
+    mode |= S_IXUSR;
+  return mode;
+}
 } // end anonymous namespace
 
 void ZipPayload::writeZip(llvm::raw_ostream &stream) {
+  if (streaming) {
+    if (auto err = finishStreaming())
+      llvm::errs() << "Problem finishing zip stream: "
+                   << llvm::toString(std::move(err)) << "\n";
+    return;
+  }
+
+  if (compressionPolicy.compresses()) {
+    if (auto err = writeCompressedZip(stream))
+      llvm::errs() << "Problem writing compressed zip: "
+                   << llvm::toString(std::move(err)) << "\n";
+    return;
+  }
+
   if (verbosity >= qssc::config::QSSVerbosity::Info)
     llvm::outs() << "Writing zip to stream\n";
   // first add the manifest
@@ -193,15 +224,16 @@ void ZipPayload::writeZip(llvm::raw_ostream &stream) {
   for (auto &fName : orderedNames) {
     if (verbosity >= qssc::config::QSSVerbosity::Info)
       llvm::outs() << "Adding file " << fName << " to archive buffer ("
-                   << files[fName].size() << " bytes)\n";
+                   << files.getOrCreate(fName).size() << " bytes)\n";
 
     //===---- Add file ----===//
     // init the error object
     zip_error_init(&error);
 
-    // first create a zip source from the file data
-    file_src = zip_source_buffer_create(files[fName].c_str(),
-                                        files[fName].size(), 0, &error);
+    // first create a zip source referencing the file data without copying
+    llvm::StringRef const contents = files.getOrCreate(fName).getBuffer();
+    file_src = zip_source_buffer_create(contents.data(), contents.size(), 0,
+                                        &error);
     if (file_src == nullptr) {
       llvm::errs() << "Can't create zip source for " << fName << " : "
                    << zip_error_strerror(&error) << "\n";
@@ -232,16 +264,13 @@ void ZipPayload::writeZip(llvm::raw_ostream &stream) {
   }
 
   //===---- Reopen for copying ----===//
-  zip_int64_t sz;
-  char *outbuffer = read_zip_src_to_buffer(new_archive_src, sz);
+  // output the new archive to the stream in chunks rather than through a
+  // second copy of the whole archive
+  zip_int64_t const sz = write_zip_src_to_stream(new_archive_src, stream);
   if (verbosity >= qssc::config::QSSVerbosity::Info)
     llvm::outs() << "Zip buffer is of size " << sz << " bytes\n";
-  if (outbuffer) {
-    // output the new archive to the stream
-    stream.write(outbuffer, sz);
-    stream.flush();
-    free(outbuffer);
-  }
+  stream.flush();
+  zip_source_free(new_archive_src);
 }
 
 void ZipPayload::writeZip(std::ostream &stream) {
@@ -252,3 +281,95 @@ void ZipPayload::writeZip(std::ostream &stream) {
 void ZipPayload::write(llvm::raw_ostream &stream) { writeZip(stream); }
 
 void ZipPayload::write(std::ostream &stream) { writeZip(stream); }
+
+llvm::Error ZipPayload::setCompression(llvm::StringRef spec) {
+  auto policy = ZipCompressionPolicy::parse(spec);
+  if (!policy)
+    return policy.takeError();
+  compressionPolicy = std::move(policy.get());
+  return llvm::Error::success();
+}
+
+llvm::Error ZipPayload::writeCompressedZip(llvm::raw_ostream &stream) {
+  if (verbosity >= qssc::config::QSSVerbosity::Info)
+    llvm::outs() << "Writing compressed zip to stream\n";
+  // first add the manifest
+  addManifest();
+
+  // checksum and compress every member, in parallel if a pool is available
+  std::vector<fs::path> const orderedNames = orderedFileNames();
+  std::vector<ZipMember> members(orderedNames.size());
+  std::mutex errorsMutex;
+  llvm::Error errors = llvm::Error::success();
+  auto prepareMember = [&](size_t index) {
+    const auto &fName = orderedNames[index];
+    auto member =
+        prepareZipMember(files.getOrCreate(fName).getBuffer(),
+                         compressionPolicy.getCompression(fName.native()));
+    if (!member) {
+      const std::lock_guard<std::mutex> lock(errorsMutex);
+      errors = llvm::joinErrors(std::move(errors), member.takeError());
+      return;
+    }
+    members[index] = std::move(member.get());
+  };
+
+  if (threadPool) {
+    llvm::ThreadPoolTaskGroup tasks(*threadPool);
+    for (size_t index = 0; index < orderedNames.size(); ++index)
+      tasks.async(prepareMember, index);
+    tasks.wait();
+  } else {
+    for (size_t index = 0; index < orderedNames.size(); ++index)
+      prepareMember(index);
+  }
+  if (errors)
+    return errors;
+
+  // then assemble the archive in order
+  ZipStreamWriter writer(stream);
+  for (size_t index = 0; index < orderedNames.size(); ++index) {
+    const auto &fName = orderedNames[index];
+    if (verbosity >= qssc::config::QSSVerbosity::Info)
+      llvm::outs() << "Adding file " << fName << " to archive ("
+                   << members[index].uncompressedSize << " bytes, "
+                   << members[index].getData().size() << " compressed)\n";
+    if (auto err = writer.addPreparedMember(fName.native(), members[index],
+                                            zipFileMode(fName)))
+      return err;
+  }
+  return writer.finish();
+}
+
+llvm::Error ZipPayload::beginStreaming(llvm::raw_ostream &stream) {
+  if (verbosity >= qssc::config::QSSVerbosity::Info)
+    llvm::outs() << "Streaming zip to stream\n";
+  streamWriter = std::make_unique<ZipStreamWriter>(stream);
+  streaming = true;
+  return llvm::Error::success();
+}
+
+llvm::Error ZipPayload::streamFile(const fs::path &fName,
+                                   const PayloadFile &contents) {
+  if (verbosity >= qssc::config::QSSVerbosity::Info)
+    llvm::outs() << "Streaming file " << fName << " to archive ("
+                 << contents.size() << " bytes)\n";
+  return streamWriter->addMember(
+      fName.native(), contents.getBuffer(), zipFileMode(fName),
+      compressionPolicy.getCompression(fName.native()));
+}
+
+llvm::Error ZipPayload::finishStreaming() {
+  if (!streaming)
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "Zip payload is not streaming");
+
+  // write the files that were not committed by a target emission, such as
+  // the input source, followed by the manifest and the central directory
+  addManifest();
+  llvm::Error err = streamFiles(orderedFileNames());
+  err = llvm::joinErrors(std::move(err), streamWriter->finish());
+  streaming = false;
+  streamWriter.reset();
+  return err;
+}
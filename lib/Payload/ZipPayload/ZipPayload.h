@@ -22,6 +22,10 @@
 #define PAYLOAD_ZIPPAYLOAD_H
 
 #include "Payload/Payload.h"
+#include "ZipCompression.h"
+#include "ZipStreamWriter.h"
+
+#include <memory>
 
 namespace qssc::payload {
 
@@ -50,10 +54,28 @@ public:
   // write all files in plaintext to the dir named dirName
   void writePlain(const std::string &dirName = ".");
   void addFile(llvm::StringRef filename, llvm::StringRef str) override;
+  using Payload::addFile;
+
+  // spec is a comma separated list of <glob>=<store|deflate|zstd> rules
+  llvm::Error setCompression(llvm::StringRef spec) override;
+
+  bool supportsStreaming() const override { return true; }
+  // files are appended to the archive in the order their emission completes
+  llvm::Error beginStreaming(llvm::raw_ostream &stream) override;
+  llvm::Error finishStreaming() override;
+
+protected:
+  llvm::Error streamFile(const std::filesystem::path &fName,
+                         const PayloadFile &contents) override;
 
 private:
   // creates a manifest json file
   void addManifest();
+  // writes the archive without libzip, compressing members in parallel
+  llvm::Error writeCompressedZip(llvm::raw_ostream &stream);
+
+  std::unique_ptr<ZipStreamWriter> streamWriter;
+  ZipCompressionPolicy compressionPolicy;
 
 }; // class ZipPayload
 
@@ -0,0 +1,187 @@
+//===- ZipStreamWriter.cpp --------------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// Implements the ZipStreamWriter class
+///
+//===----------------------------------------------------------------------===//
+
+#include "ZipStreamWriter.h"
+
+#include "ZipCompression.h"
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/Twine.h"
+#include "llvm/Support/EndianStream.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <cstdint>
+#include <ctime>
+#include <limits>
+#include <mutex>
+
+using namespace qssc::payload;
+
+namespace {
+constexpr uint32_t localFileHeaderSignature = 0x04034b50;
+constexpr uint32_t centralDirectorySignature = 0x02014b50;
+constexpr uint32_t endOfCentralDirectorySignature = 0x06054b50;
+constexpr uint32_t localFileHeaderSize = 30;
+constexpr uint32_t centralDirectoryEntrySize = 46;
+/// Version 2.0, the minimum for stored and deflated members
+constexpr uint16_t versionNeededDefault = 20;
+/// Version 6.3, which introduced zstd compressed members
+constexpr uint16_t versionNeededZstd = 63;
+/// Created on unix (upper byte) by a version 6.3 compatible writer
+constexpr uint16_t versionMadeBy = (3 << 8) | versionNeededZstd;
+constexpr uint64_t maxZip32 = std::numeric_limits<uint32_t>::max();
+
+uint16_t versionNeeded(ZipCompression method) {
+  return method == ZipCompression::Zstd ? versionNeededZstd
+                                        : versionNeededDefault;
+}
+
+llvm::Error zip64Error(const llvm::Twine &what) {
+  return llvm::createStringError(
+      llvm::inconvertibleErrorCode(),
+      "Streaming zip payload exceeds zip32 limits: " + what);
+}
+} // anonymous namespace
+
+ZipStreamWriter::ZipStreamWriter(llvm::raw_ostream &stream) : stream(stream) {
+  std::time_t const now = std::time(nullptr);
+  std::tm local{};
+  localtime_r(&now, &local);
+  // MS-DOS dates start in 1980 and times have a two second resolution
+  int const year = local.tm_year < 80 ? 0 : local.tm_year - 80;
+  dosTime = static_cast<uint16_t>((local.tm_hour << 11) |
+                                  (local.tm_min << 5) | (local.tm_sec / 2));
+  dosDate = static_cast<uint16_t>((year << 9) | ((local.tm_mon + 1) << 5) |
+                                  local.tm_mday);
+}
+
+llvm::Error ZipStreamWriter::addMember(llvm::StringRef name,
+                                       llvm::StringRef data,
+                                       uint32_t unixMode,
+                                       ZipCompression method) {
+  // Prepare outside of the lock so that members are compressed in parallel
+  auto member = prepareZipMember(data, method);
+  if (!member)
+    return member.takeError();
+  return addPreparedMember(name, member.get(), unixMode);
+}
+
+llvm::Error ZipStreamWriter::addPreparedMember(llvm::StringRef name,
+                                               const ZipMember &member,
+                                               uint32_t unixMode) {
+  llvm::StringRef const data = member.getData();
+  // incompressible data may grow beyond the limit when compressed
+  if (member.uncompressedSize > maxZip32 || data.size() > maxZip32)
+    return zip64Error("member " + name + " is too large");
+  if (name.size() > std::numeric_limits<uint16_t>::max())
+    return zip64Error("member name " + name + " is too long");
+
+  const std::lock_guard<std::mutex> lock(mutex);
+  if (finished)
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "Cannot add " + name +
+                                       " to a finished zip stream");
+  if (!memberNames.insert(name).second)
+    return llvm::createStringError(
+        llvm::inconvertibleErrorCode(),
+        "Payload file " + name +
+            " was written to the zip stream more than once");
+  if (offset > maxZip32)
+    return zip64Error("member " + name + " starts beyond 4 GiB");
+
+  llvm::support::endian::Writer writer(stream, llvm::support::little);
+  writer.write<uint32_t>(localFileHeaderSignature);
+  writer.write<uint16_t>(versionNeeded(member.method));
+  writer.write<uint16_t>(0); // general purpose flags
+  writer.write<uint16_t>(static_cast<uint16_t>(member.method));
+  writer.write<uint16_t>(dosTime);
+  writer.write<uint16_t>(dosDate);
+  writer.write<uint32_t>(member.crc);
+  writer.write<uint32_t>(data.size());
+  writer.write<uint32_t>(member.uncompressedSize);
+  writer.write<uint16_t>(name.size());
+  writer.write<uint16_t>(0); // extra field length
+  stream << name;
+  stream << data;
+  stream.flush();
+
+  entries.push_back({name.str(), member.method, member.crc,
+                     static_cast<uint32_t>(data.size()),
+                     static_cast<uint32_t>(member.uncompressedSize),
+                     static_cast<uint32_t>(offset), unixMode});
+  offset += localFileHeaderSize + name.size() + data.size();
+  return llvm::Error::success();
+}
+
+llvm::Error ZipStreamWriter::finish() {
+  const std::lock_guard<std::mutex> lock(mutex);
+  if (finished)
+    return llvm::Error::success();
+  finished = true;
+
+  if (entries.size() > std::numeric_limits<uint16_t>::max())
+    return zip64Error("too many members");
+
+  // Check the size of the central directory before writing any of it, so
+  // that a failure does not leave a partial directory on the stream
+  uint64_t const centralDirectoryOffset = offset;
+  uint64_t centralDirectorySize = 0;
+  for (const auto &entry : entries)
+    centralDirectorySize += centralDirectoryEntrySize + entry.name.size();
+  if (centralDirectoryOffset > maxZip32 || centralDirectorySize > maxZip32)
+    return zip64Error("central directory is beyond 4 GiB");
+
+  llvm::support::endian::Writer writer(stream, llvm::support::little);
+  for (const auto &entry : entries) {
+    writer.write<uint32_t>(centralDirectorySignature);
+    writer.write<uint16_t>(versionMadeBy);
+    writer.write<uint16_t>(versionNeeded(entry.method));
+    writer.write<uint16_t>(0); // general purpose flags
+    writer.write<uint16_t>(static_cast<uint16_t>(entry.method));
+    writer.write<uint16_t>(dosTime);
+    writer.write<uint16_t>(dosDate);
+    writer.write<uint32_t>(entry.crc);
+    writer.write<uint32_t>(entry.compressedSize);
+    writer.write<uint32_t>(entry.uncompressedSize);
+    writer.write<uint16_t>(entry.name.size());
+    writer.write<uint16_t>(0); // extra field length
+    writer.write<uint16_t>(0); // comment length
+    writer.write<uint16_t>(0); // disk number start
+    writer.write<uint16_t>(0); // internal attributes
+    writer.write<uint32_t>(entry.unixMode << 16);
+    writer.write<uint32_t>(entry.localHeaderOffset);
+    stream << entry.name;
+  }
+  offset += centralDirectorySize;
+
+  writer.write<uint32_t>(endOfCentralDirectorySignature);
+  writer.write<uint16_t>(0); // number of this disk
+  writer.write<uint16_t>(0); // disk with the central directory
+  writer.write<uint16_t>(entries.size());
+  writer.write<uint16_t>(entries.size());
+  writer.write<uint32_t>(centralDirectorySize);
+  writer.write<uint32_t>(centralDirectoryOffset);
+  writer.write<uint16_t>(0); // comment length
+  stream.flush();
+
+  entries.clear();
+  return llvm::Error::success();
+}
@@ -0,0 +1,91 @@
+//===- ZipStreamWriter.h ----------------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// Declares a zip archive writer that appends members directly to an output
+/// stream.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef PAYLOAD_ZIPSTREAMWRITER_H
+#define PAYLOAD_ZIPSTREAMWRITER_H
+
+#include "ZipCompression.h"
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/StringSet.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace qssc::payload {
+
+/// @brief Writes a zip archive to a forward-only stream. Each member is
+/// written as soon as it is added, so its contents may be released by the
+/// caller immediately afterwards. Only the central directory entries are
+/// retained until finish() is called. Archives that would require zip64
+/// extensions are rejected.
+class ZipStreamWriter {
+public:
+  explicit ZipStreamWriter(llvm::raw_ostream &stream);
+
+  /// @brief Append a member to the archive. Thread safe; the member is
+  /// checksummed and compressed before the writer is locked.
+  /// @param name The path of the member within the archive
+  /// @param data The contents of the member
+  /// @param unixMode The unix file mode recorded for the member
+  /// @param method The compression method to apply
+  llvm::Error addMember(llvm::StringRef name, llvm::StringRef data,
+                        uint32_t unixMode,
+                        ZipCompression method = ZipCompression::Store);
+
+  /// @brief Append a member prepared with prepareZipMember. Thread safe.
+  llvm::Error addPreparedMember(llvm::StringRef name, const ZipMember &member,
+                                uint32_t unixMode);
+
+  /// @brief Write the central directory and end of central directory record.
+  /// No members may be added afterwards.
+  llvm::Error finish();
+
+private:
+  struct CentralDirectoryEntry {
+    std::string name;
+    ZipCompression method;
+    uint32_t crc;
+    uint32_t compressedSize;
+    uint32_t uncompressedSize;
+    uint32_t localHeaderOffset;
+    uint32_t unixMode;
+  };
+
+  llvm::raw_ostream &stream;
+  std::mutex mutex;
+  std::vector<CentralDirectoryEntry> entries;
+  llvm::StringSet<> memberNames;
+  /// Number of archive bytes written so far
+  uint64_t offset = 0;
+  /// Modification time and date of all members in MS-DOS format
+  uint16_t dosTime;
+  uint16_t dosDate;
+  bool finished = false;
+}; // class ZipStreamWriter
+
+} // namespace qssc::payload
+
+#endif // PAYLOAD_ZIPSTREAMWRITER_H
@@ -22,6 +22,7 @@
 
 #include "llvm/Support/raw_ostream.h"
 
+#include <array>
 #include <cstdio>
 #include <cstdlib>
 #include <zip.h>
@@ -54,3 +55,27 @@ char *qssc::payload::read_zip_src_to_buffer(zip_source_t *zip_src,
   zip_source_close(zip_src);
   return outbuffer;
 }
+
+zip_int64_t qssc::payload::write_zip_src_to_stream(zip_source_t *zip_src,
+                                                   llvm::raw_ostream &stream) {
+  if (zip_source_open(zip_src) < 0) {
+    llvm::errs() << "Unable to open zip source for writing to stream: "
+                 << zip_error_strerror(zip_source_error(zip_src)) << "\n";
+    return -1;
+  }
+
+  std::array<char, 64 * 1024> chunk;
+  zip_int64_t total = 0;
+  zip_int64_t read;
+  while ((read = zip_source_read(zip_src, chunk.data(), chunk.size())) > 0) {
+    stream.write(chunk.data(), read);
+    total += read;
+  }
+  if (read < 0) {
+    llvm::errs() << "Problem reading zip source: "
+                 << zip_error_strerror(zip_source_error(zip_src)) << "\n";
+    total = -1;
+  }
+  zip_source_close(zip_src);
+  return total;
+}
@@ -21,6 +21,8 @@
 #ifndef PAYLOAD_ZIPUTIL_H
 #define PAYLOAD_ZIPUTIL_H
 
+#include "llvm/Support/raw_ostream.h"
+
 #include <zip.h>
 
 namespace qssc::payload {
@@ -28,6 +30,11 @@ namespace qssc::payload {
 // read zip into buffer - buffer allocated in function
 char *read_zip_src_to_buffer(zip_source_t *zip_src, zip_int64_t &sz);
 
+// write zip to stream in fixed size chunks - returns the number of bytes
+// written or -1 on failure
+zip_int64_t write_zip_src_to_stream(zip_source_t *zip_src,
+                                    llvm::raw_ostream &stream);
+
 } // namespace qssc::payload
 
 #endif // PAYLOAD_ZIPUTIL_H
@@ -34,6 +34,7 @@ from .py_qssc import (  # noqa: F401
 )
 
 from .link import (  # noqa: F401
+    link_buffer,
     link_file,
     LinkOptions,
 )
@@ -56,13 +56,18 @@
 
 #include "API/api.h"
 
+#include <cstdint>
 #include <iostream>
+#include <memory>
 #include <optional>
+#include <pybind11/buffer_info.h>
 #include <pybind11/cast.h>
 #include <pybind11/detail/common.h>
+#include <pybind11/gil.h>
 #include <pybind11/pybind11.h>
 #include <pybind11/pytypes.h>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -122,6 +127,49 @@ py::tuple py_link_file(const std::string &input, const bool enableInMemoryInput,
   return py::make_tuple(success, py::bytes(inMemoryOutput));
 }
 
+namespace {
+/// Payload produced by the linker. It is exposed to python through the
+/// buffer protocol so that it is not copied into a bytes object.
+struct LinkedPayload {
+  std::string data;
+};
+} // anonymous namespace
+
+/// Link the payload held by a python object supporting the buffer protocol,
+/// e.g., bytes or memoryview, without copying it into a string, and return
+/// the linked payload as a memoryview that owns it unless outputPath is
+/// given. The GIL is released while linking, so the input must not be
+/// modified concurrently.
+py::tuple
+py_link_buffer(const py::buffer &input, const std::string &outputPath,
+               const std::string &target, const std::string &configPath,
+               const std::unordered_map<std::string, double> &arguments,
+               bool treatWarningsAsErrors,
+               qssc::DiagnosticCallback onDiagnostic) {
+  py::buffer_info const info = input.request();
+  if (info.ndim > 1 || (info.ndim == 1 && info.strides[0] != info.itemsize))
+    throw py::value_error("input must be a contiguous buffer");
+  std::string_view const moduleInput(static_cast<const char *>(info.ptr),
+                                     info.size * info.itemsize);
+
+  auto payload = std::make_unique<LinkedPayload>();
+  int status = 0;
+  {
+    // input keeps the buffer alive, and diagnostics acquire the GIL
+    py::gil_scoped_release const release;
+    status = qssc::bindArguments(target, configPath, moduleInput, outputPath,
+                                 arguments, treatWarningsAsErrors,
+                                 /*enableInMemoryInput=*/true, &payload->data,
+                                 onDiagnostic);
+  }
+
+  bool const success = status == 0;
+#ifndef NDEBUG
+  std::cerr << "Link " << (success ? "successful" : "failed") << '\n';
+#endif
+  return py::make_tuple(success, py::memoryview(py::cast(std::move(payload))));
+}
+
 // Pybind module
 PYBIND11_MODULE(py_qssc, m) {
   m.doc() = "Python bindings for the QSS Compiler.";
@@ -129,6 +177,17 @@ PYBIND11_MODULE(py_qssc, m) {
   m.def("_compile_with_args", &py_compile_by_args,
         "Call compiler via cli qss-compile");
   m.def("_link_file", &py_link_file, "Call the linker tool");
+  m.def("_link_buffer", &py_link_buffer,
+        "Call the linker tool on a buffer without copying it");
+
+  py::class_<LinkedPayload>(m, "_LinkedPayload", py::buffer_protocol())
+      .def_buffer([](LinkedPayload &payload) -> py::buffer_info {
+        return py::buffer_info(
+            payload.data.data(), sizeof(uint8_t),
+            py::format_descriptor<uint8_t>::format(), 1,
+            {static_cast<py::ssize_t>(payload.data.size())},
+            {static_cast<py::ssize_t>(sizeof(uint8_t))}, /*readonly=*/true);
+      });
 
   addErrorCategory(m);
   addSeverity(m);
@@ -25,7 +25,7 @@ from os import environ as os_environ
 from typing import Mapping, Any, Optional, Callable, Union
 import warnings
 
-from .py_qssc import _link_file, Diagnostic, ErrorCategory
+from .py_qssc import _link_buffer, _link_file, Diagnostic, ErrorCategory
 from .compile import _stringify_path
 
 from . import exceptions
@@ -37,8 +37,10 @@ class LinkOptions:
 
     input_file: str = None
     """Path to input module."""
-    input_bytes: Union[str, None] = None
-    """Input payload as raw bytes"""
+    input_bytes: Union[str, bytes, bytearray, memoryview, None] = None
+    """Input payload as raw bytes. ``link_buffer`` accepts any contiguous
+        object supporting the buffer protocol.
+    """
     output_file: Union[str, None] = None
     """Output file, if not supplied raw bytes will be returned."""
     target: str = None
@@ -61,30 +63,9 @@ def _prepare_link_options(link_options: Optional[LinkOptions] = None, **kwargs)
     return link_options
 
 
-def link_file(
-    link_options: Optional[LinkOptions] = None,
-    **kwargs,
-) -> Optional[bytes]:
-    """Link a module and bind arguments to create a payload.
-
-    Consume a circuit module in a file and binds the provided circuit
-    arguments, delivering a payload as output in a file.
-
-    Args:
-        input_file: Path to the circuit module to link.
-        output_file: Path to write the output payload to.
-        target: Compiler target to invoke for binding arguments (must match
-            with the target that created the module).
-        arguments: Circuit arguments as name/value map.
-
-    Returns: Produces a payload in a file.
-    """
-    link_options = _prepare_link_options(link_options, **kwargs)
-
-    input_file = _stringify_path(link_options.input_file)
-    output_file = _stringify_path(link_options.output_file)
-    config_path = _stringify_path(link_options.config_path)
-
+def _prepare_link_arguments(link_options: LinkOptions) -> list:
+    """Convert arguments to floats and collect diagnostics unless handled by
+    the caller. Returns the list the diagnostics are collected in."""
     diagnostics = []
 
     def on_diagnostic(diag):
@@ -102,16 +83,12 @@ def link_file(
                     f"Only int & double arguments are supported, not {type(value)}"
                 )
 
-    if link_options.input_file is not None and link_options.input_bytes is not None:
-        raise ValueError("only one of input_file or input_bytes should have a value")
+    return diagnostics
 
-    enable_in_memory = link_options.input_bytes is not None
-    if enable_in_memory:
-        input_file = link_options.input_bytes
-
-    if output_file is None:
-        output_file = ""
 
+def _run_linker(link: Callable[[], Any], diagnostics: list) -> Any:
+    """Run the linker and raise exceptions or warnings for its diagnostics.
+    Returns the output of the linker."""
     # keep in mind that most of the infrastructure in the compile paths is for
     # taking care of the execution in a separate process. For the linker tool,
     # we aim at avoiding that right from the start!
@@ -124,16 +101,7 @@ def link_file(
     with importlib_resources.path("qss_compiler", "_version.py") as version_py_path:
         resources_path = version_py_path.parent / "resources"
         os_environ["QSSC_RESOURCES"] = str(resources_path)
-        success, output = _link_file(
-            input_file,
-            enable_in_memory,
-            output_file,
-            link_options.target,
-            config_path,
-            link_options.arguments,
-            link_options.treat_warnings_as_errors,
-            link_options.on_diagnostic,
-        )
+        success, output = link()
         if not success:
 
             exception_mapping = {
@@ -165,6 +133,116 @@ def link_file(
                     if diagnostic.category in warning_mapping.keys():
                         warnings.warn(diagnostic.message, warning_mapping[diagnostic.category])
 
-        # return in-memory raw bytes if output file is not specified
-        if link_options.output_file is None:
-            return output
+        return output
+
+
+def link_file(
+    link_options: Optional[LinkOptions] = None,
+    **kwargs,
+) -> Optional[bytes]:
+    """Link a module and bind arguments to create a payload.
+
+    Consume a circuit module in a file and binds the provided circuit
+    arguments, delivering a payload as output in a file.
+
+    Args:
+        input_file: Path to the circuit module to link.
+        output_file: Path to write the output payload to.
+        target: Compiler target to invoke for binding arguments (must match
+            with the target that created the module).
+        arguments: Circuit arguments as name/value map.
+
+    Returns: Produces a payload in a file.
+    """
+    link_options = _prepare_link_options(link_options, **kwargs)
+
+    input_file = _stringify_path(link_options.input_file)
+    output_file = _stringify_path(link_options.output_file)
+    config_path = _stringify_path(link_options.config_path)
+
+    diagnostics = _prepare_link_arguments(link_options)
+
+    if link_options.input_file is not None and link_options.input_bytes is not None:
+        raise ValueError("only one of input_file or input_bytes should have a value")
+
+    enable_in_memory = link_options.input_bytes is not None
+    if enable_in_memory:
+        input_file = link_options.input_bytes
+
+    if output_file is None:
+        output_file = ""
+
+    output = _run_linker(
+        lambda: _link_file(
+            input_file,
+            enable_in_memory,
+            output_file,
+            link_options.target,
+            config_path,
+            link_options.arguments,
+            link_options.treat_warnings_as_errors,
+            link_options.on_diagnostic,
+        ),
+        diagnostics,
+    )
+
+    # return in-memory raw bytes if output file is not specified
+    if link_options.output_file is None:
+        return output
+
+
+def link_buffer(
+    link_options: Optional[LinkOptions] = None,
+    **kwargs,
+) -> Optional[memoryview]:
+    """Link a module held in memory and bind arguments without copying the
+    module or the payload between python and the compiler.
+
+    Consume a circuit module in any contiguous object supporting the buffer
+    protocol, such as bytes or memoryview, and bind the provided circuit
+    arguments. The module is only copied once, to hold the payload. The
+    module must not be modified while linking.
+
+    Args:
+        input_bytes: The circuit module to link.
+        output_file: Path to write the output payload to.
+        target: Compiler target to invoke for binding arguments (must match
+            with the target that created the module).
+        arguments: Circuit arguments as name/value map.
+
+    Returns: A read only memoryview of the payload, which owns the payload,
+        if output_file is not specified.
+    """
+    link_options = _prepare_link_options(link_options, **kwargs)
+
+    if link_options.input_file is not None:
+        raise ValueError("link_buffer links input_bytes, not input_file")
+    if link_options.input_bytes is None:
+        raise ValueError("input_bytes must have a value")
+
+    input_buffer = link_options.input_bytes
+    if isinstance(input_buffer, str):
+        input_buffer = input_buffer.encode()
+    output_file = _stringify_path(link_options.output_file)
+    config_path = _stringify_path(link_options.config_path)
+
+    diagnostics = _prepare_link_arguments(link_options)
+
+    if output_file is None:
+        output_file = ""
+
+    output = _run_linker(
+        lambda: _link_buffer(
+            input_buffer,
+            output_file,
+            link_options.target,
+            config_path,
+            link_options.arguments,
+            link_options.treat_warnings_as_errors,
+            link_options.on_diagnostic,
+        ),
+        diagnostics,
+    )
+
+    if link_options.output_file is None:
+        return output
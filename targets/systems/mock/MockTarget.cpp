@@ -17,6 +17,7 @@
 #include "MockTarget.h"
 
 #include "Conversion/QUIRToLLVM/QUIRToLLVM.h"
+#include "Config/QSSConfig.h"
 #include "Conversion/QUIRToStandard/QUIRToStandard.h"
 #include "Dialect/QUIR/Transforms/BreakReset.h"
 #include "Dialect/QUIR/Transforms/FunctionArgumentSpecialization.h"
@@ -29,6 +30,7 @@
 #include "Payload/Payload.h"
 #include "Transforms/QubitLocalization.h"
 
+#include "mlir/Bytecode/BytecodeWriter.h"
 #include "mlir/Dialect/LLVMIR/Transforms/LegalizeForExport.h"
 #include "mlir/ExecutionEngine/OptUtils.h"
 #include "mlir/IR/BuiltinOps.h"
@@ -50,6 +52,7 @@
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/TargetSelect.h"
 #include "llvm/Support/ToolOutputFile.h"
@@ -60,8 +63,6 @@
 
 #include <cstdint>
 #include <fstream>
-#include <ios>
-#include <iterator>
 #include <memory>
 #include <optional>
 #include <string>
@@ -82,6 +83,39 @@ llvm::cl::OptionCategory
     mockCat(" QSS Compiler Options for the Mock target",
             "Options that control Mock-specific behavior of the Mock QSS "
             "Compiler target");
+
+/// Add moduleOp to the payload as name.mlir, or as bytecode in name.mlirbc if
+/// the compilation emits bytecode, under the payload prefix
+llvm::Error addMLIRToPayload(mlir::ModuleOp moduleOp, const std::string &name,
+                             qssc::payload::Payload &payload) {
+  auto config = qssc::config::getContextConfig(moduleOp.getContext());
+  if (!config) {
+    // modules compiled without a configuration are printed as text
+    llvm::consumeError(config.takeError());
+  } else if (config->shouldEmitBytecode()) {
+    std::string bytecode;
+    llvm::raw_string_ostream bytecodeOStream(bytecode);
+    mlir::BytecodeWriterConfig writerConfig;
+    if (auto version = config->bytecodeVersionToEmit())
+      writerConfig.setDesiredBytecodeVersion(*version);
+    if (mlir::failed(
+            mlir::writeBytecodeToFile(moduleOp, bytecodeOStream, writerConfig)))
+      return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                     "Failed to emit MLIR bytecode for " +
+                                         name);
+    bytecodeOStream.flush();
+    payload.addFile(payload.getPrefix() + name + ".mlirbc",
+                    std::move(bytecode));
+    return llvm::Error::success();
+  }
+
+  std::string mlirStr;
+  llvm::raw_string_ostream mlirOStream(mlirStr);
+  mlirOStream << moduleOp;
+  mlirOStream.flush();
+  payload.addFile(payload.getPrefix() + name + ".mlir", std::move(mlirStr));
+  return llvm::Error::success();
+}
 } // anonymous namespace
 
 int qssc::targets::systems::mock::init() {
@@ -251,9 +285,8 @@ llvm::Error MockController::addPasses(mlir::PassManager &pm) {
 llvm::Error MockController::emitToPayload(mlir::ModuleOp moduleOp,
                                           qssc::payload::Payload &payload) {
 
-  auto *mlirStr = payload.getFile(name + ".mlir");
-  llvm::raw_string_ostream mlirOStream(*mlirStr);
-  mlirOStream << moduleOp;
+  if (auto err = addMLIRToPayload(moduleOp, name, payload))
+    return err;
 
   if (auto err = buildLLVMPayload(moduleOp, payload))
     return err;
@@ -358,20 +391,18 @@ llvm::Error MockController::buildLLVMPayload(mlir::ModuleOp controllerModule,
   // generate a binary, and possibly do more postprocessing steps to create a
   // binary that can be executed on the controller
   // include resulting file in payload
-  std::ifstream binary{objPath.c_str(), std::ios_base::binary};
-
+  // the object file is mapped rather than read into a string where possible
+  // and the buffer is handed over to the payload without copying
+  auto binary = llvm::MemoryBuffer::getFile(objPath, /*IsText=*/false,
+                                            /*RequiresNullTerminator=*/false);
   if (!binary) {
     return llvm::createStringError(
-        llvm::inconvertibleErrorCode(),
+        binary.getError(),
         "Failed top open generated controller object file" + objPath);
   }
 
-  /* read whole content of object file into buffer */
-  std::string binaryContents{
-      std::istreambuf_iterator<char>(binary),
-      /* eof representation */ std::istreambuf_iterator<char>()};
-
-  payload.getFile("controller.bin")->assign(std::move(binaryContents));
+  payload.addFile(payload.getPrefix() + "controller.bin",
+                  std::move(binary.get()));
   emitBinaryTimer.stop();
 
   return llvm::Error::success();
@@ -394,12 +425,7 @@ llvm::Error MockAcquire::addPasses(mlir::PassManager &pm) {
 
 llvm::Error MockAcquire::emitToPayload(mlir::ModuleOp moduleOp,
                                        qssc::payload::Payload &payload) {
-  std::string mlirStr;
-  llvm::raw_string_ostream mlirOStream(mlirStr);
-  mlirOStream << moduleOp;
-  payload.getFile(name + ".mlir")->assign(mlirOStream.str());
-
-  return llvm::Error::success();
+  return addMLIRToPayload(moduleOp, name, payload);
 } // MockAcquire::emitToPayload
 
 MockDrive::MockDrive(std::string name, MockSystem *parent,
@@ -417,11 +443,5 @@ llvm::Error MockDrive::addPasses(mlir::PassManager &pm) {
 
 llvm::Error MockDrive::emitToPayload(mlir::ModuleOp moduleOp,
                                      qssc::payload::Payload &payload) {
-
-  std::string mlirStr;
-  llvm::raw_string_ostream mlirOStream(mlirStr);
-  mlirOStream << moduleOp;
-  payload.getFile(name + ".mlir")->assign(mlirOStream.str());
-
-  return llvm::Error::success();
+  return addMLIRToPayload(moduleOp, name, payload);
 } // MockDrive::emitToPayload
@@ -0,0 +1,28 @@
+// RUN: qss-compiler -X=mlir %s -o %t.mlirbc
+// RUN: qss-compiler %t.mlirbc --target mock --config %TEST_CFG --emit=qem --include-source -o %t.qem
+// RUN: unzip -l %t.qem | FileCheck %s
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// Bytecode inputs are included in the payload as they are, under their own
+// extension.
+
+// CHECK-NOT: manifest/input.mlir{{$}}
+// CHECK: manifest/input.mlirbc
+// CHECK-NOT: manifest/input.mlir{{$}}
+func.func @main () -> i32 {
+  %q0 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+  %q1 = quir.declare_qubit {id = 1 : i32} : !quir.qubit<1>
+  quir.builtin_CX %q0, %q1 : !quir.qubit<1>, !quir.qubit<1>
+  %zero = arith.constant 0 : i32
+  return %zero : i32
+}
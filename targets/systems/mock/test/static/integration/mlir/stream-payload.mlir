@@ -0,0 +1,41 @@
+// RUN: rm -rf %t && mkdir -p %t/streamed %t/buffered
+// RUN: qss-compiler %s --target mock --config %TEST_CFG --emit=qem --include-source --stream-payload -o %t/streamed/payload.qem
+// RUN: unzip -l %t/streamed/payload.qem | FileCheck %s
+// RUN: qss-compiler %s --target mock --config %TEST_CFG --emit=qem --include-source -o %t/buffered/payload.qem
+// RUN: unzip -Z1 %t/streamed/payload.qem | sort > %t/streamed/members
+// RUN: unzip -Z1 %t/buffered/payload.qem | sort | diff %t/streamed/members -
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// A streamed payload holds the same members as a buffered one. Only the set
+// of members is checked as they are streamed in order of completion.
+
+// CHECK-DAG: payload/MockController.mlir
+// CHECK-DAG: payload/llvmModule.ll
+// CHECK-DAG: payload/controller.bin
+// CHECK-DAG: payload/MockDrive_0.mlir
+// CHECK-DAG: payload/MockDrive_1.mlir
+// CHECK-DAG: payload/MockAcquire_0.mlir
+// CHECK-DAG: manifest/input.mlir
+// CHECK-DAG: manifest/manifest.json
+// CHECK: 8 files
+func.func @main () -> i32 {
+  %q0 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+  %q1 = quir.declare_qubit {id = 1 : i32} : !quir.qubit<1>
+  %a0 = quir.constant #quir.angle<1.57079632679> : !quir.angle<20>
+  %a1 = quir.constant #quir.angle<0.0> : !quir.angle<20>
+  %a2 = quir.constant #quir.angle<3.14159265359> : !quir.angle<20>
+  quir.builtin_U %q0, %a0, %a1, %a2 : !quir.qubit<1>, !quir.angle<20>, !quir.angle<20>, !quir.angle<20>
+  quir.builtin_CX %q0, %q1 : !quir.qubit<1>, !quir.qubit<1>
+  %zero = arith.constant 0 : i32
+  return %zero : i32
+}
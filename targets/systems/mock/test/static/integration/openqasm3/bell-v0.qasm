@@ -1,5 +1,9 @@
 OPENQASM 3.0;
 // RUN: qss-compiler %s --target mock --config %TEST_CFG --emit=qem --plaintext-payload --enable-circuits=false | FileCheck %s
+// RUN: qss-compiler %s --target mock --config %TEST_CFG --emit=qem --plaintext-payload --enable-circuits=false -o %t.bell.qem
+// RUN: FileCheck %s --input-file %t.bell.qem --check-prefix PREFIXED --match-full-lines
+// RUN: qss-compiler %s --target mock --config %TEST_CFG --emit=qem --plaintext-payload --enable-circuits=false --emit-bytecode -o %t.bellbc.qem
+// RUN: FileCheck %s --input-file %t.bellbc.qem --check-prefix BYTECODE --match-full-lines
 
 // (C) Copyright IBM 2023.
 //
@@ -20,6 +24,26 @@ OPENQASM 3.0;
 // CHECK: MockDrive_1.mlir
 // CHECK: controller.bin
 // CHECK: llvmModule.ll
+
+// All target files are placed under the payload prefix, named after the
+// output file
+// PREFIXED: Manifest:
+// PREFIXED-NEXT: "{{.*}}.bell/MockAcquire_0.mlir"
+// PREFIXED-NEXT: "{{.*}}.bell/MockController.mlir"
+// PREFIXED-NEXT: "{{.*}}.bell/MockDrive_0.mlir"
+// PREFIXED-NEXT: "{{.*}}.bell/MockDrive_1.mlir"
+// PREFIXED-NEXT: "{{.*}}.bell/controller.bin"
+// PREFIXED-NEXT: "{{.*}}.bell/llvmModule.ll"
+// PREFIXED-NEXT: ------------------------------------------
+
+// BYTECODE: Manifest:
+// BYTECODE-NEXT: "{{.*}}.bellbc/MockAcquire_0.mlirbc"
+// BYTECODE-NEXT: "{{.*}}.bellbc/MockController.mlirbc"
+// BYTECODE-NEXT: "{{.*}}.bellbc/MockDrive_0.mlirbc"
+// BYTECODE-NEXT: "{{.*}}.bellbc/MockDrive_1.mlirbc"
+// BYTECODE-NEXT: "{{.*}}.bellbc/controller.bin"
+// BYTECODE-NEXT: "{{.*}}.bellbc/llvmModule.ll"
+// BYTECODE-NEXT: ------------------------------------------
 qubit $0;
 qubit $1;
 
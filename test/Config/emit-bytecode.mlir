@@ -0,0 +1,33 @@
+// RUN: qss-compiler -X=mlir %s --emit=mlir --emit-bytecode -o %t.bc
+// RUN: qss-compiler -X=mlir %t.bc | FileCheck %s
+// RUN: qss-compiler -X=mlir %s -o %t.mlirbc
+// RUN: qss-compiler %t.mlirbc | FileCheck %s
+// RUN: qss-compiler -X=mlir %s --emit-bytecode | od -An -c -N4 | FileCheck %s --check-prefix MAGIC
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// Modules emitted as bytecode, either with --emit-bytecode or to a .mlirbc
+// output file, are read back as MLIR inputs.
+
+// MAGIC: M   L 357   R
+
+// CHECK: func.func @main() -> i32 {
+func.func @main() -> i32 {
+  // CHECK: %{{.*}} = quir.constant #quir.angle<1.000000e-01> : !quir.angle<20>
+  %a0 = quir.constant #quir.angle<0.1> : !quir.angle<20>
+  // CHECK: [[ZERO:%.*]] = arith.constant 0 : i32
+  %c0 = arith.constant 0 : i32
+  // CHECK: return [[ZERO]] : i32
+  return %c0 : i32
+}
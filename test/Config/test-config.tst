@@ -17,6 +17,8 @@
 // CLI: showPayloads: 0
 // CLI: showConfig: 1
 // CLI: emitPlaintextPayload: 0
+// CLI: streamPayload: 0
+// CLI: payloadCompression:
 // CLI: includeSource: 0
 // CLI: compileTargetIR: 0
 // CLI: bypassPayloadTargetCompilation: 0
@@ -43,9 +43,9 @@ OPENQASM 3.0;
 // MLIR-CIRCUITS: quir.builtin_U %arg0, [[a0]], [[a1]], [[a2]] : !quir.qubit<1>, !quir.angle<64>, !quir.angle<64>, !quir.angle<64>
 // MLIR-CIRCUITS: quir.return
 // MLIR-CIRCUITS: quir.circuit @circuit_1(%arg0: !quir.qubit<1>, %arg1: !quir.qubit<1>) -> i1 {
-// MLIR-CIRCUITS: quir.call_gate @h(%arg1) : (!quir.qubit<1>) -> ()
-// MLIR-CIRCUITS: quir.builtin_CX %arg1, %arg0 : !quir.qubit<1>, !quir.qubit<1>
-// MLIR-CIRCUITS: %0 = quir.measure(%arg1) : (!quir.qubit<1>) -> i1
+// MLIR-CIRCUITS: quir.call_gate @h(%arg0) : (!quir.qubit<1>) -> ()
+// MLIR-CIRCUITS: quir.builtin_CX %arg0, %arg1 : !quir.qubit<1>, !quir.qubit<1>
+// MLIR-CIRCUITS: %0 = quir.measure(%arg0) : (!quir.qubit<1>) -> i1
 // MLIR-CIRCUITS: quir.return %0 : i1
 // MLIR-CIRCUITS: quir.circuit @circuit_2(%arg0: !quir.qubit<1>) -> i1 {
 // MLIR-CIRCUITS: %0 = quir.measure(%arg0) : (!quir.qubit<1>) -> i1
@@ -80,7 +80,7 @@ cx $0, $1;
 // AST-PRETTY: MeasureNode(qubits=[QubitContainerNode(QubitNode(name=$0:0, bits=1))], result=CBitNode(name=c, bits=2)[index=0])
 // AST-PRETTY: MeasureNode(qubits=[QubitContainerNode(QubitNode(name=$1:0, bits=1))], result=CBitNode(name=c, bits=2)[index=1])
 // MLIR-NO-CIRCUITS: [[MEASURE0:%.*]] = quir.measure([[QUBIT0]]) : (!quir.qubit<1>) -> i1
-// MLIR-CIRCUITS: [[MEASURE0:%.]] = quir.call_circuit @circuit_1([[QUBIT1]], [[QUBIT0]]) : (!quir.qubit<1>, !quir.qubit<1>) -> i1
+// MLIR-CIRCUITS: [[MEASURE0:%.]] = quir.call_circuit @circuit_1([[QUBIT0]], [[QUBIT1]]) : (!quir.qubit<1>, !quir.qubit<1>) -> i1
 // MLIR: oq3.cbit_assign_bit @c<2> [0] : i1 = [[MEASURE0]]
 // MLIR-NO-CIRCUITS: [[MEASURE1:%.*]] = quir.measure([[QUBIT1]]) : (!quir.qubit<1>) -> i1
 // MLIR-CIRCUITS: [[MEASURE1:%.]] = quir.call_circuit @circuit_2([[QUBIT1]]) : (!quir.qubit<1>) -> i1
@@ -23,7 +23,7 @@ OPENQASM 3.0;
 qubit $0;
 qubit $1;
 
-// MLIR-CIRCUITS: quir.circuit @circuit_0(%arg0: !quir.duration<ns>, %arg1: !quir.qubit<1>, %arg2: !quir.qubit<1>, %arg3: !quir.duration<ns>, %arg4: !quir.duration<us>, %arg5: !quir.duration<ms>, %arg6: !quir.duration<dt>, %arg7: !quir.duration<ns>) {
+// MLIR-CIRCUITS: quir.circuit @circuit_0(%arg0: !quir.qubit<1>, %arg1: !quir.qubit<1>, %arg2: !quir.duration<ns>, %arg3: !quir.duration<ns>, %arg4: !quir.duration<us>, %arg5: !quir.duration<ms>, %arg6: !quir.duration<dt>, %arg7: !quir.duration<ns>) {
 // MLIR-NO-CIRCUITS: {{.*}} = quir.constant #quir.duration<5.000000e+00> : !quir.duration<ns>
 // MLIR: quir.delay {{.*}}, ({{.*}}) : !quir.duration<ns>, (!quir.qubit<1>) -> ()
 // AST-PRETTY: DeclarationNode(type=ASTTypeDuration, DurationNode(duration=5, unit=Nanoseconds, name=t))
@@ -0,0 +1,57 @@
+OPENQASM 3.0;
+// RUN: rm -rf %t
+// RUN: qss-compiler -X=qasm --emit=mlir %s --enable-circuits=false --qasm3-gate-cache-dir=%t | FileCheck %s --match-full-lines
+// RUN: ls %t | FileCheck %s --check-prefix FILES
+// RUN: qss-compiler -X=qasm --emit=mlir %s --enable-circuits=false --qasm3-gate-cache-dir=%t | FileCheck %s --match-full-lines
+// RUN: echo "OPENQASM 3.0;" > %t.moved.qasm
+// RUN: echo "// the declarations are moved to another file and line" >> %t.moved.qasm
+// RUN: sed 1d %s >> %t.moved.qasm
+// RUN: qss-compiler -X=qasm --emit=mlir %t.moved.qasm --enable-circuits=false --qasm3-gate-cache-dir=%t --mlir-print-debuginfo --mlir-print-local-scope | FileCheck %s --check-prefix HIT
+// RUN: qss-compiler -X=qasm --emit=mlir %t.moved.qasm --enable-circuits=false --mlir-print-debuginfo --mlir-print-local-scope | FileCheck %s --check-prefix MISS
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// The second compilation reads the definitions persisted by the first one.
+// FILES-COUNT-2: {{[0-9a-f]+}}.mlirbc
+
+// Reused definitions are located at their declaration as a whole, while
+// generated ones locate the operations of the gate body at their statements,
+// so the moved declarations only hit if the definitions cached for this file
+// are reused across files and lines.
+// HIT: quir.builtin_U {{.*}} loc([[LOC:"[^"]*moved.qasm":[0-9]+:[0-9]+]])
+// HIT-NEXT: return loc([[LOC]])
+// HIT-NEXT: } loc([[LOC]])
+// MISS: quir.builtin_U {{.*}} loc([[LOC:"[^"]*moved.qasm":[0-9]+:[0-9]+]])
+// MISS-NOT: } loc([[LOC]])
+// MISS: func.func @cx
+
+// CHECK: func.func @h(%arg0: !quir.qubit<1>) {
+// CHECK: %angle = quir.constant #quir.angle<1.57079632679> : !quir.angle<64>
+// CHECK: quir.builtin_U %arg0, %angle, %angle_0, %angle_1 : !quir.qubit<1>, !quir.angle<64>, !quir.angle<64>, !quir.angle<64>
+gate h q {
+    U(1.57079632679, 0.0, 3.14159265359) q;
+}
+
+// CHECK: func.func @cx(%arg0: !quir.qubit<1>, %arg1: !quir.qubit<1>) {
+// CHECK: quir.builtin_CX %arg0, %arg1 : !quir.qubit<1>, !quir.qubit<1>
+gate cx control, target {
+    CX control, target;
+}
+
+qubit $0;
+qubit $1;
+// CHECK: quir.call_gate @h(%{{.*}}) : (!quir.qubit<1>) -> ()
+h $0;
+// CHECK: quir.call_gate @cx(%{{.*}}, %{{.*}}) : (!quir.qubit<1>, !quir.qubit<1>) -> ()
+cx $0, $1;
@@ -36,8 +36,8 @@ is_excited = measure $2;
 
 
 // CHECK: quir.circuit @circuit_0(%arg0: !quir.qubit<1>, %arg1: !quir.qubit<1>, %arg2: !quir.angle<64>) -> i1 {
-// CHECK-NEXT: quir.call_gate @x(%arg1) : (!quir.qubit<1>) -> ()
-// CHECK: %0 = quir.measure(%arg1) : (!quir.qubit<1>) -> i1
+// CHECK-NEXT: quir.call_gate @x(%arg0) : (!quir.qubit<1>) -> ()
+// CHECK: %0 = quir.measure(%arg0) : (!quir.qubit<1>) -> i1
 // CHECK-NEXT: quir.return %0 : i1
 // CHECK: }
 
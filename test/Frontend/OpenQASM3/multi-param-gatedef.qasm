@@ -16,7 +16,7 @@ OPENQASM 3.0;
 // that they have been altered from the originals.
 
 // MLIR-NO-CIRCUITS: func.func @g([[QUBIT:%.*]]: !quir.qubit<1>, [[ANGLE:%.*]]: !quir.angle<{{.*}}>) {
-// MLIR-CIRCUITS:quir.circuit @circuit_0([[ANGLE:%.*]]: !quir.angle<64>, [[QUBIT:%.*]]: !quir.qubit<1>) {
+// MLIR-CIRCUITS:quir.circuit @circuit_0([[QUBIT:%.*]]: !quir.qubit<1>, [[ANGLE:%.*]]: !quir.angle<64>) {
 // MLIR: quir.builtin_U [[QUBIT]], {{.*}}, {{.*}}, [[ANGLE]] : !quir.qubit<1>, !quir.angle<{{.*}}>, !quir.angle<{{.*}}>, !quir.angle<{{.*}}>
 gate g (theta) q {
     U(0.0, 0.0, theta) q;
@@ -35,8 +35,8 @@ gate g3 (theta, lambda, phi) qa, qb {
 }
 
 // MLIR-CIRCUITS: quir.circuit @circuit_2(%arg0: !quir.qubit<1>, %arg1: !quir.qubit<1>) {
-// MLIR-CIRCUITS: quir.call_gate @g(%arg1, %angle) : (!quir.qubit<1>, !quir.angle<64>) -> ()
-// MLIR-CIRCUITS: quir.call_gate @g3(%arg1, %arg0, %angle_0, %angle_1, %angle_2) : (!quir.qubit<1>, !quir.qubit<1>, !quir.angle<64>, !quir.angle<64>, !quir.angle<64>) -> ()
+// MLIR-CIRCUITS: quir.call_gate @g(%arg0, %angle) : (!quir.qubit<1>, !quir.angle<64>) -> ()
+// MLIR-CIRCUITS: quir.call_gate @g3(%arg0, %arg1, %angle_0, %angle_1, %angle_2) : (!quir.qubit<1>, !quir.qubit<1>, !quir.angle<64>, !quir.angle<64>, !quir.angle<64>) -> ()
 
 // MLIR: [[QUBIT2:%.*]] = quir.declare_qubit {id = 2 : i32} : !quir.qubit<1>
 // MLIR: [[QUBIT3:%.*]] = quir.declare_qubit {id = 3 : i32} : !quir.qubit<1>
@@ -46,5 +46,5 @@ qubit $3;
 // MLIR-NO-CIRCUITS: quir.call_gate @g([[QUBIT2]], {{.*}}) : (!quir.qubit<1>, !quir.angle<{{.*}}>) -> ()
 g (3.14) $2;
 // MLIR-NO-CIRCUITS: quir.call_gate @g3([[QUBIT2]], [[QUBIT3]], {{.*}}, {{.*}}, {{.*}}) : (!quir.qubit<1>, !quir.qubit<1>, !quir.angle<{{.*}}>, !quir.angle<{{.*}}>, !quir.angle<{{.*}}>) -> ()
-// MLIR-CIRCUITS: quir.call_circuit @circuit_2(%1, %0) : (!quir.qubit<1>, !quir.qubit<1>) -> ()
+// MLIR-CIRCUITS: quir.call_circuit @circuit_2(%0, %1) : (!quir.qubit<1>, !quir.qubit<1>) -> ()
 g3 (3.14, 1.2, 0.2) $2, $3;
@@ -15,7 +15,7 @@ Unit tests for the linker API.
 """
 import pytest
 
-from qss_compiler import link_file
+from qss_compiler import link_buffer, link_file
 from qss_compiler.exceptions import QSSLinkerNotImplemented
 
 
@@ -34,3 +34,23 @@ def test_linker_not_implemented(tmp_path):
         )
 
     assert str(error.value.message) == "Unable to load bind arguments implementation for target."
+
+
+def test_buffer_linker_not_implemented():
+    with pytest.raises(QSSLinkerNotImplemented) as error:
+        link_buffer(
+            input_bytes=memoryview(b"dummy"),
+            target="Mock",
+            arguments={},
+        )
+
+    assert str(error.value.message) == "Unable to load bind arguments implementation for target."
+
+
+def test_buffer_linker_rejects_input_file(tmp_path):
+    with pytest.raises(ValueError):
+        link_buffer(
+            input_file=tmp_path / "test.txt",
+            target="Mock",
+            arguments={},
+        )
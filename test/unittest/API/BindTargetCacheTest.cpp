@@ -0,0 +1,160 @@
+//===- BindTargetCacheTest.cpp ----------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file implements test cases for caching the targets created by the
+/// parameter binders.
+///
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+
+#include "API/api.h"
+#include "Arguments/Arguments.h"
+#include "HAL/TargetSystem.h"
+#include "HAL/TargetSystemRegistry.h"
+
+#include "mlir/Pass/PassManager.h"
+
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace {
+
+unsigned numTargetsCreated = 0;
+
+/// Factory of a target that never gets to bind, as the tests bind a missing
+/// module
+class UnusedFactory
+    : public qssc::arguments::BindArgumentsImplementationFactory {
+public:
+  qssc::arguments::BindArgumentsImplementation *
+  create(qssc::arguments::OptDiagnosticCallback onDiagnostic) override {
+    return nullptr;
+  }
+  qssc::arguments::BindArgumentsImplementation *
+  create(std::vector<char> &buf,
+         qssc::arguments::OptDiagnosticCallback onDiagnostic) override {
+    return nullptr;
+  }
+  qssc::arguments::BindArgumentsImplementation *
+  create(std::string &str,
+         qssc::arguments::OptDiagnosticCallback onDiagnostic) override {
+    return nullptr;
+  }
+};
+
+class CountedTarget : public qssc::hal::TargetSystem {
+public:
+  CountedTarget() : TargetSystem("CountedTarget", nullptr) {
+    ++numTargetsCreated;
+  }
+
+  static llvm::Error registerTargetPasses() { return llvm::Error::success(); }
+  static llvm::Error registerTargetPipelines() {
+    return llvm::Error::success();
+  }
+
+  llvm::Error addPasses(mlir::PassManager &pm) override {
+    return llvm::Error::success();
+  }
+  llvm::Error emitToPayload(mlir::ModuleOp moduleOp,
+                            qssc::payload::Payload &payload) override {
+    return llvm::Error::success();
+  }
+  std::optional<qssc::arguments::BindArgumentsImplementationFactory *>
+  getBindArgumentsImplementationFactory() override {
+    return &factory;
+  }
+
+private:
+  UnusedFactory factory;
+};
+
+constexpr llvm::StringLiteral targetName = "bind-target-cache-test";
+
+class BindTargetCacheTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    static bool const registered =
+        qssc::hal::registry::TargetSystemRegistry::registerPlugin<
+            CountedTarget>(
+            targetName, "Target counting its instances",
+            [](std::optional<llvm::StringRef> configurationPath)
+                -> llvm::Expected<std::unique_ptr<qssc::hal::TargetSystem>> {
+              return std::make_unique<CountedTarget>();
+            });
+    ASSERT_TRUE(registered);
+    qssc::clearBindTargetCache();
+    numTargetsCreated = 0;
+
+    ASSERT_FALSE(llvm::sys::fs::createTemporaryFile("bind-target-cache",
+                                                    "cfg", configPath));
+    writeConfig("config");
+  }
+
+  void TearDown() override {
+    qssc::clearBindTargetCache();
+    llvm::sys::fs::remove(configPath);
+  }
+
+  void writeConfig(llvm::StringRef contents) {
+    std::error_code ec;
+    llvm::raw_fd_ostream out(configPath, ec);
+    ASSERT_FALSE(ec);
+    out << contents;
+  }
+
+  /// Bind a missing module, which fails after the target has been created
+  void bind() {
+    std::string output;
+    EXPECT_NE(qssc::bindArguments(targetName, configPath.str(),
+                                  "missing-module.qem", "", {},
+                                  /*treatWarningsAsErrors=*/false,
+                                  /*enableInMemoryInput=*/false, &output,
+                                  std::nullopt),
+              0);
+  }
+
+  llvm::SmallString<128> configPath;
+};
+
+TEST_F(BindTargetCacheTest, TargetsAreReused) {
+  bind();
+  bind();
+  EXPECT_EQ(numTargetsCreated, 1U);
+}
+
+TEST_F(BindTargetCacheTest, ChangedConfigsRecreateTargets) {
+  bind();
+  writeConfig("changed config");
+  bind();
+  EXPECT_EQ(numTargetsCreated, 2U);
+  bind();
+  EXPECT_EQ(numTargetsCreated, 2U);
+}
+
+TEST_F(BindTargetCacheTest, ClearingTheCacheRecreatesTargets) {
+  bind();
+  qssc::clearBindTargetCache();
+  bind();
+  EXPECT_EQ(numTargetsCreated, 2U);
+}
+
+} // anonymous namespace
@@ -0,0 +1,78 @@
+//===- CompileConfigTest.cpp ------------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file implements test cases for the typed configuration compile API.
+///
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+
+#include "API/api.h"
+#include "Config/QSSConfig.h"
+
+#include <array>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using qssc::config::EmitAction;
+using qssc::config::InputType;
+using qssc::config::QSSConfig;
+
+TEST(CompileConfig, CompileMLIR) {
+  QSSConfig config;
+  config.setInputType(InputType::MLIR).setEmitAction(EmitAction::MLIR);
+
+  std::string output;
+  EXPECT_EQ(qssc::compile(config, "func.func @typed() {\n  return\n}\n",
+                          &output),
+            0);
+  EXPECT_NE(output.find("@typed"), std::string::npos);
+}
+
+TEST(CompileConfig, MissingInputType) {
+  QSSConfig const config;
+
+  std::string output;
+  EXPECT_NE(qssc::compile(config, "module {\n}\n", &output), 0);
+}
+
+TEST(CompileConfig, ConcurrentCompilations) {
+  // As a service developer, I want to run many compilations concurrently
+  // within a single process.
+
+  constexpr size_t numThreads = 4;
+
+  QSSConfig config;
+  config.setInputType(InputType::MLIR).setEmitAction(EmitAction::MLIR);
+
+  std::array<std::string, numThreads> outputs;
+  std::array<int, numThreads> results{};
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < numThreads; i++)
+    threads.emplace_back([&, i]() {
+      std::string const input = "func.func @thread" + std::to_string(i) +
+                                "() {\n  return\n}\n";
+      results[i] = qssc::compile(config, input, &outputs[i]);
+    });
+  for (auto &thread : threads)
+    thread.join();
+
+  for (size_t i = 0; i < numThreads; i++) {
+    EXPECT_EQ(results[i], 0);
+    EXPECT_NE(outputs[i].find("@thread" + std::to_string(i)),
+              std::string::npos);
+  }
+}
+
+} // anonymous namespace
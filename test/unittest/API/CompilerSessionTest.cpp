@@ -0,0 +1,55 @@
+//===- CompilerSessionTest.cpp ----------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file implements test cases for CompilerSession.
+///
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+
+#include "API/api.h"
+
+#include <string>
+
+namespace {
+
+TEST(CompilerSession, CompileRepeatedJobs) {
+  // As a service developer, I want to compile many inputs without paying the
+  // compiler's startup cost for each of them.
+
+  char const *argv[] = {"qss-compiler", "--direct", "-X=mlir", "--emit=mlir"};
+  auto session = qssc::CompilerSession::create(4, argv);
+  ASSERT_NE(session, nullptr);
+
+  for (int job = 0; job < 3; job++) {
+    std::string const input = "func.func @job" + std::to_string(job) + "() {\n"
+                              "  return\n"
+                              "}\n";
+    std::string output;
+    EXPECT_EQ(session->compile(input, &output), 0);
+    EXPECT_NE(output.find("@job" + std::to_string(job)), std::string::npos);
+  }
+}
+
+TEST(CompilerSession, FailedJobDoesNotPoisonSession) {
+  char const *argv[] = {"qss-compiler", "--direct", "-X=mlir", "--emit=mlir"};
+  auto session = qssc::CompilerSession::create(4, argv);
+  ASSERT_NE(session, nullptr);
+
+  std::string output;
+  EXPECT_NE(session->compile("this is not mlir", &output), 0);
+
+  output.clear();
+  EXPECT_EQ(session->compile("module {\n}\n", &output), 0);
+  EXPECT_NE(output.find("module"), std::string::npos);
+}
+
+} // anonymous namespace
@@ -0,0 +1,533 @@
+//===- BindArgumentsTest.cpp ------------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file implements test cases for binding arguments to zip payloads.
+///
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+
+#include "Arguments/Arguments.h"
+#include "Arguments/ColumnarArguments.h"
+#include "Arguments/Signature.h"
+#include "Payload/PatchableZipPayload.h"
+#include "Payload/Payload.h"
+#include "Payload/PayloadOverlay.h"
+#include "Payload/PayloadRegistry.h"
+
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/Twine.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace {
+
+using qssc::arguments::ArgumentSource;
+using qssc::arguments::ArgumentType;
+using qssc::arguments::BindArgumentsImplementation;
+using qssc::arguments::OptDiagnosticCallback;
+using qssc::arguments::PatchPoint;
+using qssc::arguments::Signature;
+using qssc::payload::PatchablePayload;
+using qssc::payload::PayloadOverlay;
+using qssc::payload::PatchableZipPayload;
+
+/// Encode value as bound to patchPoint, failing for missing and negative
+/// values
+llvm::Error encodeValue(PatchPoint const &patchPoint, ArgumentType const &value,
+                        llvm::SmallVectorImpl<char> &bytes) {
+  auto const &number = std::get<std::optional<double>>(value);
+  if (!number.has_value())
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "No value for " + patchPoint.expression());
+  if (number.value() < 0)
+    return llvm::createStringError(
+        llvm::inconvertibleErrorCode(),
+        "Cannot bind negative " + patchPoint.expression() + " at offset " +
+            llvm::Twine(patchPoint.offset()));
+
+  char encoded[sizeof(double)];
+  std::memcpy(encoded, &number.value(), sizeof(double));
+  bytes.append(encoded, encoded + sizeof(double));
+  return llvm::Error::success();
+}
+
+class TestBind;
+
+/// Factory of implementations binding the f64 patch points of signature to
+/// zip payloads, which records the payloads that are opened
+class TestBindFactory
+    : public qssc::arguments::BindArgumentsImplementationFactory {
+public:
+  explicit TestBindFactory(Signature signature)
+      : signature(std::move(signature)) {}
+
+  BindArgumentsImplementation *
+  create(OptDiagnosticCallback onDiagnostic) override;
+  BindArgumentsImplementation *
+  create(std::vector<char> &buf, OptDiagnosticCallback onDiagnostic) override;
+  BindArgumentsImplementation *
+  create(std::string &str, OptDiagnosticCallback onDiagnostic) override {
+    // binaries are always read into vectors
+    return nullptr;
+  }
+
+  bool supportsParallelPatching() const override { return parallel; }
+
+  void recordOpen(llvm::StringRef path, bool enableInMemory) {
+    ++numPayloadsOpened;
+    if (enableInMemory)
+      return;
+    // NOLINTNEXTLINE(clang-diagnostic-ctad-maybe-unsupported)
+    std::lock_guard const lock(mutex);
+    pathsOpened.push_back(path.str());
+  }
+
+  Signature const signature;
+  /// Whether patch points are encoded rather than patched in binaries
+  bool encodePatches = false;
+  /// Whether binaries may be patched concurrently
+  bool parallel = false;
+
+  std::atomic<unsigned> numPayloadsOpened{0};
+  std::atomic<unsigned> numColumnsEncoded{0};
+  std::atomic<unsigned> numPatched{0};
+  /// Paths of the payloads opened from disk
+  std::vector<std::string> pathsOpened;
+
+private:
+  std::mutex mutex;
+};
+
+/// Binds the f64 patch points of a signature by writing their values
+class TestBind : public BindArgumentsImplementation {
+public:
+  TestBind(TestBindFactory &factory, std::vector<char> *binary)
+      : factory(factory), binary(binary) {}
+
+  llvm::Error patch(PatchPoint const &patchPoint,
+                    ArgumentSource const &arguments) override {
+    ++factory.numPatched;
+    llvm::SmallVector<char, sizeof(double)> bytes;
+    if (auto err = encodeValue(
+            patchPoint, arguments.getArgumentValue(patchPoint.expression()),
+            bytes))
+      return err;
+    if (!binary || patchPoint.offset() + bytes.size() > binary->size())
+      return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                     "Patch point out of bounds");
+    std::copy(bytes.begin(), bytes.end(),
+              binary->begin() + patchPoint.offset());
+    return llvm::Error::success();
+  }
+
+  llvm::Error parseParamMapIntoSignature(llvm::StringRef paramMapContents,
+                                         llvm::StringRef paramMapFileName,
+                                         Signature &sig) override {
+    return llvm::Error::success();
+  }
+
+  PatchablePayload *getPayload(llvm::StringRef payloadOutputPath,
+                               bool enableInMemory) override {
+    factory.recordOpen(payloadOutputPath, enableInMemory);
+    return new PatchableZipPayload(payloadOutputPath, enableInMemory);
+  }
+
+  llvm::Expected<Signature> parseSignature(PatchablePayload *payload) override {
+    return factory.signature;
+  }
+
+  llvm::Expected<bool>
+  encodePatch(PatchPoint const &patchPoint, ArgumentType const &value,
+              llvm::SmallVectorImpl<char> &bytes) override {
+    if (!factory.encodePatches)
+      return false;
+    if (auto err = encodeValue(patchPoint, value, bytes))
+      return std::move(err);
+    return true;
+  }
+
+  llvm::Expected<bool>
+  encodePatchColumn(PatchPoint const &patchPoint,
+                    llvm::ArrayRef<double> values,
+                    llvm::SmallVectorImpl<char> &bytes) override {
+    ++factory.numColumnsEncoded;
+    return BindArgumentsImplementation::encodePatchColumn(patchPoint, values,
+                                                          bytes);
+  }
+
+private:
+  TestBindFactory &factory;
+  std::vector<char> *binary;
+};
+
+BindArgumentsImplementation *
+TestBindFactory::create(OptDiagnosticCallback onDiagnostic) {
+  return new TestBind(*this, nullptr);
+}
+
+BindArgumentsImplementation *
+TestBindFactory::create(std::vector<char> &buf,
+                        OptDiagnosticCallback onDiagnostic) {
+  return new TestBind(*this, &buf);
+}
+
+class MapArgumentSource : public ArgumentSource {
+public:
+  MapArgumentSource(double theta, double phi)
+      : values{{"theta", theta}, {"phi", phi}} {}
+
+  ArgumentType getArgumentValue(llvm::StringRef name) const override {
+    auto pos = values.find(name.str());
+    if (pos == values.end())
+      return std::nullopt;
+    return pos->second;
+  }
+
+  std::map<std::string, double> values;
+};
+
+/// Read the value bound at offset of member of the zip payload in data
+double readBound(std::string data, llvm::StringRef member, uint64_t offset) {
+  PatchableZipPayload payload(std::move(data), /*enableInMemory=*/true);
+  auto contents = payload.readMember(member, /*markForWriteBack=*/false);
+  if (!contents) {
+    ADD_FAILURE() << llvm::toString(contents.takeError());
+    return -1;
+  }
+  double value = -1;
+  if (offset + sizeof(double) <= contents->size())
+    std::memcpy(&value, contents->data() + offset, sizeof(double));
+  return value;
+}
+
+/// Read member of the zip payload in data
+std::string readMemberData(std::string data, llvm::StringRef member) {
+  PatchableZipPayload payload(std::move(data), /*enableInMemory=*/true);
+  auto contents = payload.readMember(member, /*markForWriteBack=*/false);
+  if (!contents) {
+    ADD_FAILURE() << llvm::toString(contents.takeError());
+    return std::string();
+  }
+  return std::string(contents->begin(), contents->end());
+}
+
+std::string readFile(llvm::StringRef path) {
+  auto buffer = llvm::MemoryBuffer::getFile(path, /*IsText=*/false,
+                                            /*RequiresNullTerminator=*/false);
+  if (!buffer)
+    return std::string();
+  return buffer.get()->getBuffer().str();
+}
+
+class BindArgumentsTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    // theta is bound in both binaries, phi in ctrl0.bin only
+    signature.addParameterPatchPoint("theta", "f64", "ctrl0.bin", 8);
+    signature.addParameterPatchPoint("phi", "f64", "ctrl0.bin", 24);
+    signature.addParameterPatchPoint("theta", "f64", "ctrl1.bin", 16);
+
+    auto payloadInfo =
+        qssc::payload::registry::PayloadRegistry::lookupPluginInfo("ZIP");
+    ASSERT_TRUE(payloadInfo.has_value());
+    const qssc::payload::PayloadConfig config{
+        "test", "test", qssc::config::QSSVerbosity::Warn};
+    auto created = payloadInfo.value()->createPluginInstance(config);
+    ASSERT_TRUE(bool(created));
+    auto payload = std::move(created.get());
+    payload->addFile("ctrl0.bin", std::vector<char>(64, '\0'));
+    payload->addFile("ctrl1.bin", std::vector<char>(64, '\0'));
+
+    llvm::raw_string_ostream output(base);
+    payload->write(output);
+    output.flush();
+  }
+
+  std::vector<ArgumentSource const *> getArgumentSets() const {
+    std::vector<ArgumentSource const *> sets;
+    for (auto const &source : sources)
+      sets.push_back(&source);
+    return sets;
+  }
+
+  /// Check that data is the base payload bound with source
+  static void expectBound(std::string const &data,
+                          MapArgumentSource const &source) {
+    EXPECT_EQ(readBound(data, "ctrl0.bin", 8), source.values.at("theta"));
+    EXPECT_EQ(readBound(data, "ctrl0.bin", 24), source.values.at("phi"));
+    EXPECT_EQ(readBound(data, "ctrl1.bin", 16), source.values.at("theta"));
+  }
+
+  Signature signature;
+  std::string base;
+  std::vector<MapArgumentSource> sources{{0.25, 1.5}, {0.5, 2.5}, {0.75, 3.5}};
+};
+
+TEST_F(BindArgumentsTest, BatchBindsEachArgumentSet) {
+  // As a user running a sweep, I want one bound payload per argument set.
+
+  llvm::ThreadPool pool(llvm::hardware_concurrency(2));
+  for (llvm::ThreadPool *threadPool :
+       {static_cast<llvm::ThreadPool *>(nullptr), &pool}) {
+    for (bool const encodePatches : {false, true}) {
+      TestBindFactory factory(signature);
+      factory.encodePatches = encodePatches;
+
+      std::vector<std::string> outputs;
+      ASSERT_FALSE(llvm::errorToBool(qssc::arguments::bindArgumentsBatch(
+          base, {}, getArgumentSets(), /*treatWarningsAsErrors=*/false,
+          /*enableInMemoryInput=*/true, &outputs, factory, std::nullopt,
+          threadPool)));
+
+      ASSERT_EQ(outputs.size(), sources.size());
+      for (size_t i = 0; i < sources.size(); ++i)
+        expectBound(outputs[i], sources[i]);
+    }
+  }
+}
+
+TEST_F(BindArgumentsTest, BatchMapsTheInputOnce) {
+  llvm::SmallString<128> inputPath;
+  ASSERT_FALSE(
+      llvm::sys::fs::createTemporaryFile("bind-batch-input", "qem", inputPath));
+  {
+    std::error_code ec;
+    llvm::raw_fd_ostream input(inputPath, ec);
+    ASSERT_FALSE(ec);
+    input << base;
+  }
+
+  std::vector<std::string> outputPaths;
+  for (size_t i = 0; i < sources.size(); ++i) {
+    llvm::SmallString<128> outputPath;
+    ASSERT_FALSE(llvm::sys::fs::createTemporaryFile("bind-batch-output", "qem",
+                                                    outputPath));
+    outputPaths.push_back(outputPath.str().str());
+  }
+
+  llvm::ThreadPool pool(llvm::hardware_concurrency(2));
+  TestBindFactory factory(signature);
+  auto err = qssc::arguments::bindArgumentsBatch(
+      inputPath, outputPaths, getArgumentSets(),
+      /*treatWarningsAsErrors=*/false, /*enableInMemoryInput=*/false, nullptr,
+      factory, std::nullopt, &pool);
+  EXPECT_FALSE(llvm::errorToBool(std::move(err)));
+
+  // the input is opened once for the signature and once per argument set,
+  // each time from the copy mapped by the batch rather than from disk
+  EXPECT_EQ(factory.numPayloadsOpened.load(), 1 + sources.size());
+  for (auto const &path : factory.pathsOpened)
+    EXPECT_NE(path, inputPath.str());
+
+  for (size_t i = 0; i < sources.size(); ++i)
+    expectBound(readFile(outputPaths[i]), sources[i]);
+
+  llvm::sys::fs::remove(inputPath);
+  for (auto const &path : outputPaths)
+    llvm::sys::fs::remove(path);
+}
+
+TEST_F(BindArgumentsTest, BatchRequiresOneOutputPerArgumentSet) {
+  TestBindFactory factory(signature);
+  std::vector<std::string> const outputPaths{"a.qem", "b.qem"};
+  auto err = qssc::arguments::bindArgumentsBatch(
+      base, outputPaths, getArgumentSets(), /*treatWarningsAsErrors=*/false,
+      /*enableInMemoryInput=*/true, nullptr, factory, std::nullopt, nullptr);
+  EXPECT_NE(llvm::toString(std::move(err))
+                .find("Expected one payload output path per argument set"),
+            std::string::npos);
+
+  err = qssc::arguments::bindArgumentsBatch(
+      base, {}, getArgumentSets(), /*treatWarningsAsErrors=*/false,
+      /*enableInMemoryInput=*/true, nullptr, factory, std::nullopt, nullptr);
+  EXPECT_NE(llvm::toString(std::move(err)).find("inMemoryOutputs"),
+            std::string::npos);
+  EXPECT_EQ(factory.numPayloadsOpened.load(), 0U);
+}
+
+TEST_F(BindArgumentsTest, BatchReportsFailedArgumentSetsInOrder) {
+  sources[0].values["theta"] = -1;
+  sources[2].values["phi"] = -1;
+
+  llvm::ThreadPool pool(llvm::hardware_concurrency(2));
+  TestBindFactory factory(signature);
+  std::vector<std::string> outputs;
+  auto message = llvm::toString(qssc::arguments::bindArgumentsBatch(
+      base, {}, getArgumentSets(), /*treatWarningsAsErrors=*/false,
+      /*enableInMemoryInput=*/true, &outputs, factory, std::nullopt, &pool));
+
+  auto first = message.find("Binding argument set 0: Cannot bind negative "
+                            "theta");
+  auto second = message.find("Binding argument set 2: Cannot bind negative "
+                             "phi at offset 24");
+  ASSERT_NE(first, std::string::npos) << message;
+  ASSERT_NE(second, std::string::npos) << message;
+  EXPECT_LT(first, second);
+  EXPECT_EQ(message.find("Binding argument set 1"), std::string::npos);
+
+  // the other argument sets are bound regardless
+  ASSERT_EQ(outputs.size(), sources.size());
+  expectBound(outputs[1], sources[1]);
+}
+
+TEST_F(BindArgumentsTest, ParallelPatchingBindsEachBinary) {
+  // Binaries are patched concurrently through the synchronized factory
+  // wrapping a factory that supports parallel patching.
+
+  llvm::ThreadPool pool(llvm::hardware_concurrency(2));
+  TestBindFactory factory(signature);
+  factory.parallel = true;
+
+  std::vector<std::string> outputs;
+  ASSERT_FALSE(llvm::errorToBool(qssc::arguments::bindArgumentsBatch(
+      base, {}, getArgumentSets(), /*treatWarningsAsErrors=*/false,
+      /*enableInMemoryInput=*/true, &outputs, factory, std::nullopt, &pool)));
+
+  ASSERT_EQ(outputs.size(), sources.size());
+  for (size_t i = 0; i < sources.size(); ++i)
+    expectBound(outputs[i], sources[i]);
+}
+
+TEST_F(BindArgumentsTest, ParallelPatchingReportsEachFailedBinary) {
+  // theta is bound in both binaries, so both fail to be patched
+  sources.resize(1);
+  sources[0].values["theta"] = -1;
+
+  llvm::ThreadPool pool(llvm::hardware_concurrency(2));
+  TestBindFactory factory(signature);
+  factory.parallel = true;
+
+  std::vector<std::string> outputs;
+  auto message = llvm::toString(qssc::arguments::bindArgumentsBatch(
+      base, {}, getArgumentSets(), /*treatWarningsAsErrors=*/false,
+      /*enableInMemoryInput=*/true, &outputs, factory, std::nullopt, &pool));
+
+  EXPECT_NE(message.find("Cannot bind negative theta at offset 8"),
+            std::string::npos)
+      << message;
+  EXPECT_NE(message.find("Cannot bind negative theta at offset 16"),
+            std::string::npos)
+      << message;
+}
+
+TEST_F(BindArgumentsTest, OverlaysReproduceBoundPayloads) {
+  // Overlays of argument sets bound concurrently against the shared base
+  // materialize the same payloads as binding each argument set in full.
+  sources.resize(2);
+
+  llvm::ThreadPool pool(llvm::hardware_concurrency(2));
+  for (bool const encodePatches : {false, true}) {
+    TestBindFactory factory(signature);
+    factory.encodePatches = encodePatches;
+
+    std::vector<std::string> payloads;
+    ASSERT_FALSE(llvm::errorToBool(qssc::arguments::bindArgumentsBatch(
+        base, {}, getArgumentSets(), /*treatWarningsAsErrors=*/false,
+        /*enableInMemoryInput=*/true, &payloads, factory, std::nullopt,
+        &pool)));
+
+    std::vector<std::string> overlays;
+    ASSERT_FALSE(llvm::errorToBool(qssc::arguments::bindArgumentsBatch(
+        base, {}, getArgumentSets(), /*treatWarningsAsErrors=*/false,
+        /*enableInMemoryInput=*/true, &overlays, factory, std::nullopt, &pool,
+        /*emitOverlays=*/true)));
+
+    ASSERT_EQ(overlays.size(), sources.size());
+    for (size_t i = 0; i < sources.size(); ++i) {
+      ASSERT_TRUE(PayloadOverlay::isOverlay(overlays[i]));
+      auto overlay = PayloadOverlay::deserialize(overlays[i]);
+      ASSERT_TRUE(bool(overlay)) << llvm::toString(overlay.takeError());
+      ASSERT_FALSE(llvm::errorToBool(overlay->verifyBase(base)));
+
+      PatchableZipPayload copy(std::string(base), /*enableInMemory=*/true);
+      ASSERT_FALSE(llvm::errorToBool(overlay->apply(copy)));
+      ASSERT_FALSE(llvm::errorToBool(copy.writeBack()));
+      std::string materialized;
+      ASSERT_FALSE(llvm::errorToBool(copy.writeString(&materialized)));
+
+      expectBound(materialized, sources[i]);
+      for (llvm::StringRef const member : {"ctrl0.bin", "ctrl1.bin"})
+        EXPECT_EQ(readMemberData(materialized, member),
+                  readMemberData(payloads[i], member));
+    }
+  }
+}
+
+TEST_F(BindArgumentsTest, ColumnsAreEncodedOncePerParameter) {
+  // sources as columns: theta, then phi
+  std::vector<std::string> const parameterNames{"theta", "phi"};
+  std::vector<double> const values{0.25, 0.5, 0.75, 1.5, 2.5, 3.5};
+  auto columns = qssc::arguments::ColumnarArguments::create(
+      parameterNames, values, sources.size());
+  ASSERT_TRUE(bool(columns)) << llvm::toString(columns.takeError());
+
+  llvm::ThreadPool pool(llvm::hardware_concurrency(2));
+  TestBindFactory factory(signature);
+  factory.encodePatches = true;
+
+  std::vector<std::string> outputs;
+  ASSERT_FALSE(llvm::errorToBool(qssc::arguments::bindArgumentColumns(
+      base, {}, *columns, /*treatWarningsAsErrors=*/false,
+      /*enableInMemoryInput=*/true, &outputs, factory, std::nullopt, &pool)));
+
+  // the theta patch points of both binaries share a column
+  EXPECT_EQ(factory.numColumnsEncoded.load(), 2U);
+  EXPECT_EQ(factory.numPatched.load(), 0U);
+  ASSERT_EQ(outputs.size(), sources.size());
+  for (size_t i = 0; i < sources.size(); ++i)
+    expectBound(outputs[i], sources[i]);
+}
+
+TEST_F(BindArgumentsTest, UnencodedColumnsArePatched) {
+  std::vector<std::string> const parameterNames{"theta", "phi"};
+  std::vector<double> const values{0.25, 0.5, 0.75, 1.5, 2.5, 3.5};
+  auto columns = qssc::arguments::ColumnarArguments::create(
+      parameterNames, values, sources.size());
+  ASSERT_TRUE(bool(columns)) << llvm::toString(columns.takeError());
+
+  // encodePatch returns false, so each point falls back to patch()
+  TestBindFactory factory(signature);
+  std::vector<std::string> outputs;
+  ASSERT_FALSE(llvm::errorToBool(qssc::arguments::bindArgumentColumns(
+      base, {}, *columns, /*treatWarningsAsErrors=*/false,
+      /*enableInMemoryInput=*/true, &outputs, factory, std::nullopt,
+      nullptr)));
+
+  EXPECT_EQ(factory.numColumnsEncoded.load(), 2U);
+  // three patch points per point
+  EXPECT_EQ(factory.numPatched.load(), 3 * sources.size());
+  ASSERT_EQ(outputs.size(), sources.size());
+  for (size_t i = 0; i < sources.size(); ++i)
+    expectBound(outputs[i], sources[i]);
+}
+
+} // anonymous namespace
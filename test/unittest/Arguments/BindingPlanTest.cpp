@@ -0,0 +1,118 @@
+//===- BindingPlanTest.cpp --------------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file implements test cases for binding plans.
+///
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+
+#include "Arguments/Arguments.h"
+#include "Arguments/BindingPlan.h"
+#include "Arguments/Signature.h"
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+
+#include <optional>
+#include <string>
+#include <utility>
+#include <variant>
+
+namespace {
+
+using qssc::arguments::ArgumentType;
+using qssc::arguments::BindingPlan;
+
+class CountingArgumentSource : public qssc::arguments::ArgumentSource {
+public:
+  ArgumentType getArgumentValue(llvm::StringRef name) const override {
+    ++lookups;
+    if (name == "theta")
+      return 0.5;
+    return std::nullopt;
+  }
+
+  mutable unsigned lookups = 0;
+};
+
+TEST(BindingPlan, ParametersAreResolvedOnce) {
+  qssc::arguments::Signature sig;
+  sig.addParameterPatchPoint("theta", "f64", "test/ctrl0.bin", 16);
+  sig.addParameterPatchPoint("phi", "f64", "test/ctrl0.bin", 48);
+  sig.addParameterPatchPoint("theta", "f64", "test/ctrl1.bin", 8);
+
+  BindingPlan const plan(std::move(sig));
+  ASSERT_EQ(plan.getNumParameters(), 2U);
+  EXPECT_EQ(plan.lookupParameter("theta"), 0U);
+  EXPECT_EQ(plan.lookupParameter("phi"), 1U);
+  EXPECT_FALSE(plan.lookupParameter("lambda").has_value());
+
+  ASSERT_EQ(plan.getBinaries().size(), 2U);
+  auto const &ctrl1 = plan.getBinaries()[1];
+  EXPECT_EQ(ctrl1.name, "test/ctrl1.bin");
+  ASSERT_EQ(ctrl1.entries.size(), 1U);
+  EXPECT_EQ(ctrl1.entries[0].offset, 8U);
+  EXPECT_EQ(ctrl1.entries[0].parameter, 0U);
+  EXPECT_EQ(ctrl1.entries[0].patchPoint->expression(), "theta");
+
+  CountingArgumentSource source;
+  auto values = plan.resolve(source);
+  EXPECT_EQ(source.lookups, 2U);
+  ASSERT_EQ(values.size(), 2U);
+  EXPECT_EQ(std::get<std::optional<double>>(values[0]), 0.5);
+  EXPECT_FALSE(std::get<std::optional<double>>(values[1]).has_value());
+}
+
+TEST(BindingPlan, CreateFromBinarySignatureView) {
+  qssc::arguments::Signature sig;
+  sig.addParameterPatchPoint("theta", "f64", "test/ctrl0.bin", 16);
+  sig.addParameterPatchPoint("phi", "f64", "test/ctrl0.bin", 48);
+  sig.addParameterPatchPoint("theta", "f64", "test/ctrl1.bin", 8);
+  std::string binary = sig.serializeBinary();
+
+  auto view = qssc::arguments::BinarySignatureView::create(binary);
+  ASSERT_TRUE(static_cast<bool>(view)) << llvm::toString(view.takeError());
+  auto created = BindingPlan::create(*view);
+  ASSERT_TRUE(static_cast<bool>(created))
+      << llvm::toString(created.takeError());
+  // the plan must not refer to the serialized signature
+  binary.assign(binary.size(), '\0');
+  BindingPlan const plan = std::move(created.get());
+
+  ASSERT_EQ(plan.getNumParameters(), 2U);
+  EXPECT_TRUE(plan.lookupParameter("theta").has_value());
+  EXPECT_TRUE(plan.lookupParameter("phi").has_value());
+  EXPECT_FALSE(plan.lookupParameter("lambda").has_value());
+
+  ASSERT_EQ(plan.getBinaries().size(), 2U);
+  auto const &ctrl0 = plan.getBinaries()[0];
+  EXPECT_EQ(ctrl0.name, "test/ctrl0.bin");
+  ASSERT_EQ(ctrl0.entries.size(), 2U);
+  EXPECT_EQ(ctrl0.entries[0].offset, 16U);
+  EXPECT_EQ(ctrl0.entries[0].parameter, plan.lookupParameter("theta"));
+  EXPECT_EQ(ctrl0.entries[1].offset, 48U);
+  EXPECT_EQ(ctrl0.entries[1].parameter, plan.lookupParameter("phi"));
+  EXPECT_EQ(ctrl0.entries[1].patchPoint->expression(), "phi");
+
+  auto const &ctrl1 = plan.getBinaries()[1];
+  EXPECT_EQ(ctrl1.name, "test/ctrl1.bin");
+  ASSERT_EQ(ctrl1.entries.size(), 1U);
+  EXPECT_EQ(ctrl1.entries[0].offset, 8U);
+  EXPECT_EQ(ctrl1.entries[0].parameter, plan.lookupParameter("theta"));
+  EXPECT_EQ(ctrl1.entries[0].patchPoint->patchType(), "f64");
+
+  CountingArgumentSource source;
+  auto values = plan.resolve(source);
+  EXPECT_EQ(source.lookups, 2U);
+}
+
+} // anonymous namespace
@@ -0,0 +1,115 @@
+//===- ColumnarArgumentsTest.cpp --------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file implements test cases for columnar arguments and column
+/// encoding.
+///
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+
+#include "Arguments/Arguments.h"
+#include "Arguments/ColumnarArguments.h"
+#include "Arguments/Signature.h"
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+
+#include <optional>
+#include <string>
+#include <variant>
+#include <vector>
+
+namespace {
+
+using qssc::arguments::ArgumentType;
+using qssc::arguments::ColumnarArguments;
+using qssc::arguments::PatchPoint;
+
+/// Encodes values of patch points of type "i8" as a single byte
+class ByteEncoder : public qssc::arguments::BindArgumentsImplementation {
+public:
+  llvm::Error patch(PatchPoint const &patchPoint,
+                    qssc::arguments::ArgumentSource const &arguments) override {
+    return llvm::Error::success();
+  }
+  llvm::Error
+  parseParamMapIntoSignature(llvm::StringRef paramMapContents,
+                             llvm::StringRef paramMapFileName,
+                             qssc::arguments::Signature &sig) override {
+    return llvm::Error::success();
+  }
+  qssc::payload::PatchablePayload *getPayload(llvm::StringRef payloadOutputPath,
+                                              bool enableInMemory) override {
+    return nullptr;
+  }
+  llvm::Expected<qssc::arguments::Signature>
+  parseSignature(qssc::payload::PatchablePayload *payload) override {
+    return qssc::arguments::Signature();
+  }
+  llvm::Expected<bool>
+  encodePatch(PatchPoint const &patchPoint, ArgumentType const &value,
+              llvm::SmallVectorImpl<char> &bytes) override {
+    if (patchPoint.patchType() != "i8")
+      return false;
+    bytes.push_back(static_cast<char>(*std::get<std::optional<double>>(value)));
+    return true;
+  }
+};
+
+TEST(ColumnarArguments, PointsReadTheirColumn) {
+  std::vector<std::string> const names{"theta", "phi"};
+  std::vector<double> const values{1.0, 2.0, 3.0, 4.0, 5.0, 6.0};
+  auto arguments = ColumnarArguments::create(names, values, 3);
+  ASSERT_TRUE(bool(arguments)) << llvm::toString(arguments.takeError());
+  EXPECT_EQ(arguments->getNumParameters(), 2U);
+  EXPECT_EQ(arguments->getNumPoints(), 3U);
+
+  auto phi = arguments->getColumn("phi");
+  ASSERT_TRUE(phi.has_value());
+  EXPECT_EQ(phi->front(), 4.0);
+
+  auto point = arguments->getPoint(1);
+  EXPECT_EQ(std::get<std::optional<double>>(point.getArgumentValue("theta")),
+            2.0);
+  EXPECT_FALSE(std::get<std::optional<double>>(point.getArgumentValue("x"))
+                   .has_value());
+}
+
+TEST(ColumnarArguments, MismatchedShapesAreRejected) {
+  std::vector<std::string> const names{"theta", "theta"};
+  std::vector<double> const values{1.0, 2.0};
+  EXPECT_TRUE(llvm::errorToBool(
+      ColumnarArguments::create(names, values, 3).takeError()));
+  EXPECT_TRUE(llvm::errorToBool(
+      ColumnarArguments::create(names, values, 1).takeError()));
+}
+
+TEST(ColumnarArguments, ColumnsAreEncodedThroughEncodePatch) {
+  ByteEncoder encoder;
+  std::vector<double> const values{1.0, 2.0, 3.0};
+  llvm::SmallVector<char> bytes;
+
+  PatchPoint const i8("theta", "i8", 0);
+  auto encoded = encoder.encodePatchColumn(i8, values, bytes);
+  ASSERT_TRUE(bool(encoded));
+  EXPECT_TRUE(encoded.get());
+  EXPECT_EQ(bytes, (llvm::SmallVector<char>{1, 2, 3}));
+
+  PatchPoint const f64("theta", "f64", 0);
+  encoded = encoder.encodePatchColumn(f64, values, bytes);
+  ASSERT_TRUE(bool(encoded));
+  EXPECT_FALSE(encoded.get());
+  EXPECT_EQ(bytes.size(), 3U);
+}
+
+} // anonymous namespace
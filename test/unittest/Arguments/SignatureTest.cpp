@@ -0,0 +1,117 @@
+//===- SignatureTest.cpp ----------------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file implements test cases for the circuit signature formats.
+///
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+
+#include "Arguments/Signature.h"
+
+#include "llvm/Support/Error.h"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace {
+
+using qssc::arguments::BinarySignatureView;
+using qssc::arguments::Signature;
+
+Signature createSignature() {
+  Signature sig;
+  sig.addParameterPatchPoint("theta", "f64", "test/ctrl0.bin", 16);
+  sig.addParameterPatchPoint("phi", "f64", "test/ctrl0.bin", 48);
+  sig.addParameterPatchPoint("theta", "f64", "test/ctrl1.bin", 8);
+  return sig;
+}
+
+void expectEqual(const Signature &a, const Signature &b) {
+  ASSERT_EQ(a.patchPointsByBinary.size(), b.patchPointsByBinary.size());
+  for (auto const &[binaryName, patchPoints] : a.patchPointsByBinary) {
+    auto pos = b.patchPointsByBinary.find(binaryName);
+    ASSERT_NE(pos, b.patchPointsByBinary.end()) << binaryName;
+    ASSERT_EQ(patchPoints.size(), pos->second.size());
+    for (size_t i = 0; i < patchPoints.size(); ++i) {
+      EXPECT_EQ(patchPoints[i].expression(), pos->second[i].expression());
+      EXPECT_EQ(patchPoints[i].patchType(), pos->second[i].patchType());
+      EXPECT_EQ(patchPoints[i].offset(), pos->second[i].offset());
+    }
+  }
+}
+
+TEST(Signature, TextAndBinaryFormatsRoundTrip) {
+  auto sig = createSignature();
+
+  auto fromText = Signature::deserialize(sig.serialize(), std::nullopt);
+  ASSERT_TRUE(bool(fromText)) << llvm::toString(fromText.takeError());
+  expectEqual(sig, fromText.get());
+
+  std::string const binary = sig.serializeBinary();
+  ASSERT_TRUE(BinarySignatureView::isBinarySignature(binary));
+  auto fromBinary = Signature::deserialize(binary, std::nullopt);
+  ASSERT_TRUE(bool(fromBinary)) << llvm::toString(fromBinary.takeError());
+  expectEqual(sig, fromBinary.get());
+}
+
+TEST(Signature, BinaryViewIndexesParameters) {
+  std::string const binary = createSignature().serializeBinary();
+  auto view = BinarySignatureView::create(binary);
+  ASSERT_TRUE(bool(view)) << llvm::toString(view.takeError());
+
+  EXPECT_EQ(view->getNumBinaries(), 2U);
+  EXPECT_EQ(view->getNumPatchPoints(), 3U);
+  EXPECT_EQ(view->getNumParameters(), 2U);
+  EXPECT_FALSE(view->findParameter("lambda").has_value());
+
+  auto theta = view->findParameter("theta");
+  ASSERT_TRUE(theta.has_value());
+  ASSERT_EQ(view->getNumParameterPatchPoints(*theta), 2U);
+  auto second = view->getParameterPatchPoint(*theta, 1);
+  EXPECT_EQ(view->getPatchPointOffset(second), 8U);
+  EXPECT_EQ(view->getBinaryName(view->getPatchPointBinary(second)),
+            "test/ctrl1.bin");
+}
+
+TEST(Signature, BinaryViewAccessorsAreBoundsChecked) {
+  std::string const binary = createSignature().serializeBinary();
+  auto view = BinarySignatureView::create(binary);
+  ASSERT_TRUE(bool(view)) << llvm::toString(view.takeError());
+
+  uint32_t const numBinaries = view->getNumBinaries();
+  uint32_t const numPatchPoints = view->getNumPatchPoints();
+  uint32_t const numParameters = view->getNumParameters();
+
+  EXPECT_TRUE(view->getBinaryName(numBinaries).empty());
+  EXPECT_EQ(view->getFirstPatchPoint(numBinaries), numPatchPoints);
+  EXPECT_EQ(view->getNumPatchPoints(numBinaries), 0U);
+
+  EXPECT_EQ(view->getPatchPointOffset(numPatchPoints), 0U);
+  EXPECT_TRUE(view->getPatchPointExpression(numPatchPoints).empty());
+  EXPECT_TRUE(view->getPatchPointType(numPatchPoints).empty());
+  EXPECT_EQ(view->getPatchPointBinary(numPatchPoints), numBinaries);
+
+  EXPECT_TRUE(view->getParameterName(numParameters).empty());
+  EXPECT_EQ(view->getNumParameterPatchPoints(numParameters), 0U);
+  EXPECT_EQ(view->getParameterPatchPoint(numParameters, 0), numPatchPoints);
+}
+
+TEST(Signature, TruncatedBinarySignatureIsRejected) {
+  std::string binary = createSignature().serializeBinary();
+  binary.pop_back();
+  auto view = BinarySignatureView::create(binary);
+  EXPECT_FALSE(bool(view));
+  llvm::consumeError(view.takeError());
+}
+
+} // anonymous namespace
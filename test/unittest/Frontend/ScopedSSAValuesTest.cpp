@@ -0,0 +1,149 @@
+//===- ScopedSSAValuesTest.cpp ----------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file implements test cases for the scoped table of SSA values.
+///
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+
+#include "Frontend/OpenQASM3/ScopedSSAValues.h"
+
+#include "mlir/IR/Block.h"
+#include "mlir/IR/BuiltinTypes.h"
+#include "mlir/IR/Location.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/IR/Value.h"
+
+#include "llvm/ADT/StringRef.h"
+
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace {
+
+using qssc::frontend::openqasm3::ScopedSSAValues;
+
+class ScopedSSAValuesTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    auto const type = mlir::IntegerType::get(&context, 32);
+    auto const loc = mlir::UnknownLoc::get(&context);
+    for (int i = 0; i < 4; ++i)
+      block.addArgument(type, loc);
+  }
+
+  /// Distinct values to set in the table
+  mlir::Value value(unsigned i) { return block.getArgument(i); }
+
+  /// Names of the visible values in iteration order
+  static std::vector<std::string> names(ScopedSSAValues const &table) {
+    std::vector<std::string> result;
+    for (auto const &entry : table)
+      result.push_back(entry.getKey().str());
+    return result;
+  }
+
+  mlir::MLIRContext context;
+  mlir::Block block;
+  ScopedSSAValues table;
+};
+
+TEST_F(ScopedSSAValuesTest, NestedScopesShadowAndRestoreValues) {
+  table.set("a", value(0));
+  {
+    ScopedSSAValues::Scope const outer(table);
+    table.set("a", value(1));
+    EXPECT_EQ(table.lookup("a"), value(1));
+    {
+      ScopedSSAValues::Scope const inner(table);
+      table.set("a", value(2));
+      // set twice within one scope, which is undone as a whole
+      table.set("a", value(3));
+      EXPECT_EQ(table.lookup("a"), value(3));
+    }
+    EXPECT_EQ(table.lookup("a"), value(1));
+  }
+  EXPECT_EQ(table.lookup("a"), value(0));
+}
+
+TEST_F(ScopedSSAValuesTest, ValuesAddedInScopeAreErasedOnExit) {
+  table.set("a", value(0));
+  {
+    ScopedSSAValues::Scope const scope(table);
+    table.set("b", value(1));
+    EXPECT_TRUE(table.contains("b"));
+    EXPECT_EQ(table.lookup("b"), value(1));
+  }
+  EXPECT_FALSE(table.contains("b"));
+  EXPECT_EQ(table.lookup("b"), std::nullopt);
+  EXPECT_EQ(names(table), std::vector<std::string>({"a"}));
+
+  // names erased on exit may be set again
+  table.set("b", value(2));
+  EXPECT_EQ(table.lookup("b"), value(2));
+  EXPECT_EQ(names(table), std::vector<std::string>({"a", "b"}));
+}
+
+TEST_F(ScopedSSAValuesTest, IsolatedScopesHideEnclosingValues) {
+  table.set("a", value(0));
+  {
+    ScopedSSAValues::Scope const scope(table);
+    table.set("b", value(1));
+    {
+      ScopedSSAValues::IsolatedScope const isolated(table);
+      EXPECT_FALSE(table.contains("a"));
+      EXPECT_FALSE(table.contains("b"));
+      EXPECT_EQ(table.begin(), table.end());
+
+      table.set("a", value(2));
+      {
+        ScopedSSAValues::Scope const nested(table);
+        table.set("c", value(3));
+        EXPECT_EQ(names(table), std::vector<std::string>({"a", "c"}));
+      }
+      EXPECT_EQ(names(table), std::vector<std::string>({"a"}));
+      EXPECT_EQ(table.lookup("a"), value(2));
+    }
+    EXPECT_EQ(table.lookup("a"), value(0));
+    EXPECT_EQ(table.lookup("b"), value(1));
+    EXPECT_FALSE(table.contains("c"));
+  }
+  // the enclosing scope is left as if it had not been isolated
+  EXPECT_FALSE(table.contains("b"));
+  EXPECT_EQ(names(table), std::vector<std::string>({"a"}));
+}
+
+TEST_F(ScopedSSAValuesTest, IterationFollowsFirstSetOrder) {
+  // names that are unlikely to hash in this order
+  table.set("zeta", value(0));
+  table.set("alpha", value(1));
+  table.set("mu", value(2));
+  {
+    ScopedSSAValues::Scope const scope(table);
+    // shadowing keeps the position of a name
+    table.set("zeta", value(3));
+    table.set("beta", value(3));
+    EXPECT_EQ(names(table),
+              std::vector<std::string>({"zeta", "alpha", "mu", "beta"}));
+
+    std::vector<mlir::Value> values;
+    for (auto const &entry : table)
+      values.push_back(entry.getValue());
+    EXPECT_EQ(values, std::vector<mlir::Value>(
+                          {value(3), value(1), value(2), value(3)}));
+  }
+  EXPECT_EQ(names(table), std::vector<std::string>({"zeta", "alpha", "mu"}));
+  EXPECT_EQ(table.lookup("zeta"), value(0));
+}
+
+} // anonymous namespace
@@ -0,0 +1,422 @@
+//===- ThreadedCompilationManagerTest.cpp -----------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file implements test cases for ThreadedCompilationManager.
+///
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+
+#include "HAL/Compile/ThreadedCompilationManager.h"
+#include "HAL/TargetSystem.h"
+#include "Payload/Payload.h"
+
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/IR/OwningOpRef.h"
+#include "mlir/Pass/PassManager.h"
+#include "mlir/Support/Timing.h"
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using qssc::hal::compile::ThreadedCompilationManager;
+
+/// Log of the emission events of a compilation, in order of occurrence.
+class EventLog {
+public:
+  void record(std::string event) {
+    // NOLINTNEXTLINE(clang-diagnostic-ctad-maybe-unsupported)
+    std::lock_guard const lock(mutex);
+    events.push_back(std::move(event));
+  }
+
+  /// Position of event in the log or std::nullopt if it did not occur.
+  std::optional<size_t> position(llvm::StringRef event) {
+    // NOLINTNEXTLINE(clang-diagnostic-ctad-maybe-unsupported)
+    std::lock_guard const lock(mutex);
+    auto it = std::find(events.begin(), events.end(), event);
+    if (it == events.end())
+      return std::nullopt;
+    return static_cast<size_t>(it - events.begin());
+  }
+
+  /// Remove all events from the log, returning those starting with prefix.
+  std::vector<std::string> take(llvm::StringRef prefix) {
+    // NOLINTNEXTLINE(clang-diagnostic-ctad-maybe-unsupported)
+    std::lock_guard const lock(mutex);
+    std::vector<std::string> taken;
+    for (auto &event : events)
+      if (llvm::StringRef(event).startswith(prefix))
+        taken.push_back(std::move(event));
+    events.clear();
+    return taken;
+  }
+
+private:
+  std::mutex mutex;
+  std::vector<std::string> events;
+};
+
+/// A target whose module is the nested module named after it.
+class TestTarget : public qssc::hal::TargetSystem {
+public:
+  TestTarget(std::string name, Target *parent, mlir::ModuleOp moduleOp,
+             EventLog &log)
+      : TargetSystem(std::move(name), parent), moduleOp(moduleOp), log(log) {}
+
+  /// Add a child target along with its module within the module of this
+  /// target.
+  TestTarget &addTestChild(std::string name) {
+    auto childModuleOp =
+        mlir::ModuleOp::create(moduleOp.getLoc(), llvm::StringRef(name));
+    moduleOp.push_back(childModuleOp);
+    auto child =
+        std::make_unique<TestTarget>(std::move(name), this, childModuleOp, log);
+    auto &ref = *child;
+    addChild(std::move(child));
+    return ref;
+  }
+
+  llvm::Expected<mlir::ModuleOp>
+  getModule(mlir::ModuleOp parentModuleOp) override {
+    if (!getParent())
+      return parentModuleOp;
+    for (auto childModuleOp :
+         parentModuleOp.getBody()->getOps<mlir::ModuleOp>())
+      if (childModuleOp.getName() == getName())
+        return childModuleOp;
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "No module for target " + getName());
+  }
+
+  llvm::Error addPasses(mlir::PassManager &pm) override {
+    return llvm::Error::success();
+  }
+
+  llvm::Error emitToPayload(mlir::ModuleOp targetModuleOp,
+                            qssc::payload::Payload &payload) override {
+    if (failEmit)
+      return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                     "Failed to emit " + getName());
+    std::this_thread::sleep_for(emitDelay);
+    log.record(("emit:" + getName()).str());
+    return llvm::Error::success();
+  }
+
+  llvm::Error
+  emitToPayloadPostChildren(mlir::ModuleOp targetModuleOp,
+                            qssc::payload::Payload &payload) override {
+    log.record(("post:" + getName()).str());
+    return llvm::Error::success();
+  }
+
+  uint64_t estimateCompilationCost(mlir::ModuleOp targetModuleOp) override {
+    return estimate;
+  }
+
+  /// Whether emitToPayload fails for this target.
+  bool failEmit = false;
+  /// Time spent by emitToPayload.
+  std::chrono::milliseconds emitDelay{0};
+  /// Value returned by estimateCompilationCost.
+  uint64_t estimate = 0;
+
+private:
+  mlir::ModuleOp moduleOp;
+  EventLog &log;
+};
+
+/// A payload discarding everything emitted to it.
+class TestPayload : public qssc::payload::Payload {
+public:
+  void write(llvm::raw_ostream &stream) override {}
+  void write(std::ostream &stream) override {}
+  void writePlain(std::ostream &stream) override {}
+  void writePlain(llvm::raw_ostream &stream) override {}
+  void addFile(llvm::StringRef filename, llvm::StringRef str) override {}
+};
+
+/// A system of three targets, root with the children a and b.
+struct TestSystem {
+  explicit TestSystem(mlir::MLIRContext &context)
+      : moduleOp(mlir::ModuleOp::create(mlir::UnknownLoc::get(&context))),
+        root("root", nullptr, *moduleOp, log) {
+    root.addTestChild("a");
+    root.addTestChild("b");
+  }
+
+  mlir::OwningOpRef<mlir::ModuleOp> moduleOp;
+  EventLog log;
+  TestTarget root;
+};
+
+/// Build a compilation manager for system counting the pass managers built.
+std::unique_ptr<ThreadedCompilationManager>
+createCountingManager(mlir::MLIRContext &context, TestSystem &system,
+                      std::atomic<int> &builds) {
+  return std::make_unique<ThreadedCompilationManager>(
+      system.root, &context, [&builds](mlir::PassManager &) -> llvm::Error {
+        builds++;
+        return llvm::Error::success();
+      });
+}
+
+TEST(ThreadedCompilationManager, PassManagersAreReusedBetweenCompilations) {
+  // As a service developer, I want the jobs of a session to skip building
+  // the target pipelines that an earlier job already built.
+
+  mlir::MLIRContext context;
+  TestSystem system(context);
+  std::atomic<int> builds{0};
+  auto manager = createCountingManager(context, system, builds);
+
+  ASSERT_FALSE(llvm::errorToBool(manager->compileMLIR(*system.moduleOp)));
+  EXPECT_EQ(builds, 3);
+  ASSERT_FALSE(llvm::errorToBool(manager->compileMLIR(*system.moduleOp)));
+  EXPECT_EQ(builds, 3);
+
+  // Pass managers built with other options are not reused...
+  manager->setPipelineOptionsKey("verify-each=0");
+  ASSERT_FALSE(llvm::errorToBool(manager->compileMLIR(*system.moduleOp)));
+  EXPECT_EQ(builds, 6);
+  ASSERT_FALSE(llvm::errorToBool(manager->compileMLIR(*system.moduleOp)));
+  EXPECT_EQ(builds, 6);
+
+  // ...but remain cached under their own key.
+  manager->setPipelineOptionsKey("");
+  ASSERT_FALSE(llvm::errorToBool(manager->compileMLIR(*system.moduleOp)));
+  EXPECT_EQ(builds, 6);
+
+  manager->invalidatePassManagerCache();
+  ASSERT_FALSE(llvm::errorToBool(manager->compileMLIR(*system.moduleOp)));
+  EXPECT_EQ(builds, 9);
+}
+
+TEST(ThreadedCompilationManager, TimedCompilationsRebuildPassManagers) {
+  mlir::MLIRContext context;
+  TestSystem system(context);
+  std::atomic<int> builds{0};
+  auto manager = createCountingManager(context, system, builds);
+
+  ASSERT_FALSE(llvm::errorToBool(manager->compileMLIR(*system.moduleOp)));
+  EXPECT_EQ(builds, 3);
+
+  {
+    mlir::DefaultTimingManager tm;
+    tm.setEnabled(true);
+    auto timing = tm.getRootScope();
+    manager->enableTiming(timing);
+    ASSERT_FALSE(llvm::errorToBool(manager->compileMLIR(*system.moduleOp)));
+    EXPECT_EQ(builds, 6);
+    ASSERT_FALSE(llvm::errorToBool(manager->compileMLIR(*system.moduleOp)));
+    EXPECT_EQ(builds, 9);
+
+    // Detach the manager from the timers before they are destroyed.
+    mlir::TimingScope noTiming;
+    manager->enableTiming(noTiming);
+  }
+
+  // The pass managers built without timing are still cached.
+  ASSERT_FALSE(llvm::errorToBool(manager->compileMLIR(*system.moduleOp)));
+  EXPECT_EQ(builds, 9);
+}
+
+TEST(ThreadedCompilationManager, DisabledCacheRebuildsPassManagers) {
+  mlir::MLIRContext context;
+  TestSystem system(context);
+  std::atomic<int> builds{0};
+  auto manager = createCountingManager(context, system, builds);
+  manager->enablePassManagerCache(false);
+
+  ASSERT_FALSE(llvm::errorToBool(manager->compileMLIR(*system.moduleOp)));
+  ASSERT_FALSE(llvm::errorToBool(manager->compileMLIR(*system.moduleOp)));
+  EXPECT_EQ(builds, 6);
+}
+
+TEST(ThreadedCompilationManager, ChildrenEmitBeforeParentPostChildren) {
+  // As a target developer, I want the post-children hook of a target to
+  // observe the payload emitted by all of its descendants, however the
+  // targets are scheduled.
+
+  for (bool const dependencyScheduling : {true, false}) {
+    mlir::MLIRContext context;
+    TestSystem system(context);
+    auto &a = *static_cast<TestTarget *>(system.root.getChildren()[0]);
+    a.addTestChild("a1").addTestChild("a11");
+    a.addTestChild("a2");
+
+    std::atomic<int> builds{0};
+    auto manager = createCountingManager(context, system, builds);
+    manager->enableDependencyScheduling(dependencyScheduling);
+
+    TestPayload payload;
+    ASSERT_FALSE(llvm::errorToBool(
+        manager->compilePayload(*system.moduleOp, payload)));
+
+    // Each target emits after its parent and completes before its parent.
+    std::pair<std::string, std::string> const edges[] = {
+        {"root", "a"}, {"root", "b"}, {"a", "a1"},
+        {"a", "a2"},   {"a1", "a11"}};
+    for (auto [parent, child] : edges) {
+      auto parentEmit = system.log.position("emit:" + parent);
+      auto parentPost = system.log.position("post:" + parent);
+      auto childEmit = system.log.position("emit:" + child);
+      auto childPost = system.log.position("post:" + child);
+      ASSERT_TRUE(parentEmit && parentPost && childEmit && childPost);
+      EXPECT_LT(*parentEmit, *childEmit) << parent << " -> " << child;
+      EXPECT_LT(*childEmit, *parentPost) << parent << " -> " << child;
+      EXPECT_LT(*childPost, *parentPost) << parent << " -> " << child;
+    }
+  }
+}
+
+TEST(ThreadedCompilationManager, FailedChildStopsDependants) {
+  for (bool const dependencyScheduling : {true, false}) {
+    mlir::MLIRContext context;
+    TestSystem system(context);
+    auto &a = *static_cast<TestTarget *>(system.root.getChildren()[0]);
+    a.addTestChild("a1").addTestChild("a11");
+    a.failEmit = true;
+
+    std::atomic<int> builds{0};
+    auto manager = createCountingManager(context, system, builds);
+    manager->enableDependencyScheduling(dependencyScheduling);
+
+    TestPayload payload;
+    auto message =
+        llvm::toString(manager->compilePayload(*system.moduleOp, payload));
+    EXPECT_FALSE(message.empty());
+    // The dependency driven scheduler returns the errors of all failed
+    // targets rather than a summary.
+    if (dependencyScheduling && context.isMultithreadingEnabled())
+      EXPECT_NE(message.find("Failed to emit a"), std::string::npos);
+
+    // Neither the descendants of a nor any of its ancestors' post-children
+    // hooks run.
+    EXPECT_TRUE(system.log.position("emit:root").has_value());
+    EXPECT_FALSE(system.log.position("emit:a1").has_value());
+    EXPECT_FALSE(system.log.position("emit:a11").has_value());
+    EXPECT_FALSE(system.log.position("post:a").has_value());
+    EXPECT_FALSE(system.log.position("post:root").has_value());
+  }
+}
+
+/// A system whose root has the children a, b and c, which are estimated to
+/// be increasingly expensive while a actually takes the longest to emit.
+struct OrderingTestSystem : TestSystem {
+  explicit OrderingTestSystem(mlir::MLIRContext &context)
+      : TestSystem(context) {
+    auto children = root.getChildren();
+    auto &a = *static_cast<TestTarget *>(children[0]);
+    auto &b = *static_cast<TestTarget *>(children[1]);
+    auto &c = root.addTestChild("c");
+    a.estimate = 1;
+    a.emitDelay = std::chrono::milliseconds(200);
+    b.estimate = 2;
+    b.emitDelay = std::chrono::milliseconds(100);
+    c.estimate = 3;
+  }
+};
+
+using Emissions = std::vector<std::string>;
+
+TEST(ThreadedCompilationManager, ChildrenAreOrderedByEstimate) {
+  // As a target developer, I want the most expensive of sibling targets to
+  // start compiling first.
+
+  // Children are submitted to the thread pool in order, so without threads
+  // they are also emitted in that order.
+  mlir::MLIRContext context(mlir::MLIRContext::Threading::DISABLED);
+  OrderingTestSystem system(context);
+  std::atomic<int> builds{0};
+  auto manager = createCountingManager(context, system, builds);
+
+  TestPayload payload;
+  ASSERT_FALSE(
+      llvm::errorToBool(manager->compilePayload(*system.moduleOp, payload)));
+  EXPECT_EQ(system.log.take("emit:"),
+            (Emissions{"emit:root", "emit:c", "emit:b", "emit:a"}));
+
+  manager->setChildOrderingPolicy(
+      ThreadedCompilationManager::ChildOrderingPolicy::Declaration);
+  ASSERT_FALSE(
+      llvm::errorToBool(manager->compilePayload(*system.moduleOp, payload)));
+  EXPECT_EQ(system.log.take("emit:"),
+            (Emissions{"emit:root", "emit:a", "emit:b", "emit:c"}));
+}
+
+TEST(ThreadedCompilationManager, RecordedCostsOverrideEstimates) {
+  mlir::MLIRContext context;
+  OrderingTestSystem system(context);
+  std::atomic<int> builds{0};
+  auto manager = createCountingManager(context, system, builds);
+
+  // Costs are recorded by the dependency driven scheduler...
+  TestPayload payload;
+  ASSERT_FALSE(
+      llvm::errorToBool(manager->compilePayload(*system.moduleOp, payload)));
+  system.log.take("emit:");
+
+  // ...and used by later compilations, here without threads to observe the
+  // submission order.
+  context.disableMultithreading();
+  ASSERT_FALSE(
+      llvm::errorToBool(manager->compilePayload(*system.moduleOp, payload)));
+  EXPECT_EQ(system.log.take("emit:"),
+            (Emissions{"emit:root", "emit:a", "emit:b", "emit:c"}));
+
+  manager->clearRecordedCosts();
+  ASSERT_FALSE(
+      llvm::errorToBool(manager->compilePayload(*system.moduleOp, payload)));
+  EXPECT_EQ(system.log.take("emit:"),
+            (Emissions{"emit:root", "emit:c", "emit:b", "emit:a"}));
+}
+
+TEST(ThreadedCompilationManager, EstimatesAreUsedUnlessAllCostsAreRecorded) {
+  mlir::MLIRContext context;
+  OrderingTestSystem system(context);
+  std::atomic<int> builds{0};
+  auto manager = createCountingManager(context, system, builds);
+
+  TestPayload payload;
+  ASSERT_FALSE(
+      llvm::errorToBool(manager->compilePayload(*system.moduleOp, payload)));
+  system.log.take("emit:");
+
+  // A sibling without a recorded cost makes the recorded costs of the others
+  // incomparable, so all of them are ordered by estimate.
+  system.root.addTestChild("d").estimate = 4;
+  context.disableMultithreading();
+  ASSERT_FALSE(
+      llvm::errorToBool(manager->compilePayload(*system.moduleOp, payload)));
+  EXPECT_EQ(system.log.take("emit:"),
+            (Emissions{"emit:root", "emit:d", "emit:c", "emit:b", "emit:a"}));
+}
+
+} // anonymous namespace
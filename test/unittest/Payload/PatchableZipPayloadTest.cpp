@@ -0,0 +1,120 @@
+//===- PatchableZipPayloadTest.cpp ------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file implements test cases for patching zip payloads in place.
+///
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+
+#include "Payload/PatchableZipPayload.h"
+#include "Payload/Payload.h"
+#include "Payload/PayloadBuffer.h"
+#include "Payload/PayloadRegistry.h"
+
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using qssc::payload::PatchableZipPayload;
+
+class PatchableZipPayloadTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    ASSERT_FALSE(llvm::sys::fs::createTemporaryFile("patchable", "qem",
+                                                    payloadPath));
+
+    auto payloadInfo =
+        qssc::payload::registry::PayloadRegistry::lookupPluginInfo("ZIP");
+    ASSERT_TRUE(payloadInfo.has_value());
+    const qssc::payload::PayloadConfig config{
+        "test", "test", qssc::config::QSSVerbosity::Warn};
+    auto created = payloadInfo.value()->createPluginInstance(config);
+    ASSERT_TRUE(bool(created));
+    auto payload = std::move(created.get());
+
+    for (size_t i = 0; i < binary.size(); ++i)
+      binary[i] = static_cast<char>(i * 7);
+    payload->addFile("binary.bin", std::vector<char>(binary));
+
+    std::error_code ec;
+    llvm::raw_fd_ostream output(payloadPath, ec);
+    ASSERT_FALSE(ec);
+    payload->write(output);
+  }
+
+  void TearDown() override { llvm::sys::fs::remove(payloadPath); }
+
+  llvm::SmallString<128> payloadPath;
+  std::vector<char> binary = std::vector<char>(4096);
+};
+
+TEST_F(PatchableZipPayloadTest, StoredMembersArePatchedInPlace) {
+  std::vector<char> const patch{'\x01', '\x02', '\x03', '\x04'};
+  {
+    PatchableZipPayload payload(payloadPath.str(), false);
+    ASSERT_FALSE(llvm::errorToBool(
+        payload.patchMember("binary.bin", 1000, patch)));
+    ASSERT_FALSE(llvm::errorToBool(payload.writeBack()));
+  }
+  std::copy(patch.begin(), patch.end(), binary.begin() + 1000);
+
+  // libzip verifies the member checksum when reading it back
+  PatchableZipPayload payload(payloadPath.str(), false);
+  ASSERT_NE(payload.getBackingZip(), nullptr);
+  auto member = payload.readMember("binary.bin", false);
+  ASSERT_TRUE(bool(member)) << llvm::toString(member.takeError());
+  EXPECT_EQ(member.get(), binary);
+}
+
+TEST_F(PatchableZipPayloadTest, PatchesOutOfBoundsAreRejected) {
+  PatchableZipPayload payload(payloadPath.str(), false);
+  std::vector<char> const patch(8, '\x7f');
+  EXPECT_TRUE(
+      llvm::errorToBool(payload.patchMember("binary.bin", 4092, patch)));
+}
+
+TEST_F(PatchableZipPayloadTest, InMemoryPayloadsAreCopiedOnce) {
+  auto input = llvm::MemoryBuffer::getFile(payloadPath, /*IsText=*/false,
+                                           /*RequiresNullTerminator=*/false);
+  ASSERT_TRUE(bool(input));
+  llvm::StringRef const data = input.get()->getBuffer();
+
+  std::vector<char> const patch{'\x05', '\x06', '\x07', '\x08'};
+  std::string output;
+  qssc::payload::PayloadBuffer::resetBytesCopied();
+  {
+    PatchableZipPayload payload(qssc::payload::PayloadBuffer::borrow(data));
+    ASSERT_FALSE(llvm::errorToBool(
+        payload.patchMember("binary.bin", 2000, patch)));
+    ASSERT_FALSE(llvm::errorToBool(payload.writeBack()));
+    ASSERT_FALSE(llvm::errorToBool(payload.writeString(&output)));
+  }
+  EXPECT_EQ(qssc::payload::PayloadBuffer::getBytesCopied(), data.size());
+  std::copy(patch.begin(), patch.end(), binary.begin() + 2000);
+
+  PatchableZipPayload payload(std::move(output), true);
+  ASSERT_NE(payload.getBackingZip(), nullptr);
+  auto member = payload.readMember("binary.bin", false);
+  ASSERT_TRUE(bool(member)) << llvm::toString(member.takeError());
+  EXPECT_EQ(member.get(), binary);
+}
+
+} // anonymous namespace
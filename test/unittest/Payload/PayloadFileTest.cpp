@@ -0,0 +1,100 @@
+//===- PayloadFileTest.cpp --------------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file implements test cases for PayloadFile storage.
+///
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+
+#include "Payload/Payload.h"
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using qssc::payload::PayloadFile;
+using qssc::payload::PayloadFileStore;
+
+TEST(PayloadFile, MemoryBufferIsNotCopied) {
+  auto buffer = llvm::MemoryBuffer::getMemBufferCopy("waveform bytes");
+  const char *data = buffer->getBufferStart();
+
+  PayloadFile const file(std::move(buffer));
+  EXPECT_EQ(file.getBuffer(), "waveform bytes");
+  EXPECT_EQ(file.getBuffer().data(), data);
+}
+
+TEST(PayloadFile, ByteVectorIsNotCopied) {
+  std::vector<char> bytes{'\0', 'a', '\0'};
+  const char *data = bytes.data();
+
+  PayloadFile const file(std::move(bytes));
+  EXPECT_EQ(file.size(), 3U);
+  EXPECT_EQ(file.getBuffer().data(), data);
+}
+
+TEST(PayloadFile, GetStringConvertsOnce) {
+  PayloadFile file(std::vector<char>{'a', 'b'});
+  std::string &str = file.getString();
+  EXPECT_EQ(str, "ab");
+
+  str.append("c");
+  EXPECT_EQ(&file.getString(), &str);
+  EXPECT_EQ(file.getBuffer(), "abc");
+}
+
+TEST(PayloadFileStore, ConcurrentWritersAreOrderedAtWriteTime) {
+  constexpr size_t numThreads = 8;
+  constexpr size_t filesPerThread = 64;
+  PayloadFileStore store;
+
+  std::vector<std::thread> threads;
+  std::vector<std::vector<std::string *>> handles(numThreads);
+  for (size_t t = 0; t < numThreads; ++t)
+    threads.emplace_back([&, t]() {
+      for (size_t i = 0; i < filesPerThread; ++i) {
+        auto name = "target" + std::to_string(t) + "/" + std::to_string(i);
+        std::string *handle = &store.getOrCreate(name).getString();
+        handle->assign(name);
+        handles[t].push_back(handle);
+      }
+    });
+  for (auto &thread : threads)
+    thread.join();
+
+  auto names = store.orderedNames();
+  ASSERT_EQ(names.size(), numThreads * filesPerThread);
+  EXPECT_TRUE(std::is_sorted(names.begin(), names.end()));
+
+  // Handles taken while other threads were inserting are still valid
+  for (size_t t = 0; t < numThreads; ++t)
+    for (size_t i = 0; i < filesPerThread; ++i)
+      EXPECT_EQ(*handles[t][i],
+                "target" + std::to_string(t) + "/" + std::to_string(i));
+
+  auto taken = store.take(names.front());
+  ASSERT_TRUE(taken.has_value());
+  EXPECT_EQ(store.lookup(names.front()), nullptr);
+  EXPECT_EQ(store.size(), names.size() - 1);
+}
+
+} // anonymous namespace
@@ -0,0 +1,137 @@
+//===- PayloadOverlayTest.cpp -----------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file implements test cases for recording and applying payload
+/// overlays.
+///
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+
+#include "Payload/Payload.h"
+#include "Payload/PayloadOverlay.h"
+
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using qssc::payload::OverlayPayload;
+using qssc::payload::OverlayRecordingPayload;
+using qssc::payload::PayloadOverlay;
+
+/// Payload holding its members in memory, which counts member reads
+class MemberMapPayload : public qssc::payload::PatchablePayload {
+public:
+  llvm::Expected<ContentBuffer &>
+  readMember(llvm::StringRef path, bool markForWriteBack = true) override {
+    auto pos = members.find(path);
+    if (pos == members.end())
+      return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                     "No member " + path);
+    ++numReads;
+    return pos->second;
+  }
+  llvm::Error writeBack() override { return llvm::Error::success(); }
+  llvm::Error writeString(std::string *outputString) override {
+    return llvm::Error::success();
+  }
+
+  llvm::StringMap<ContentBuffer> members;
+  unsigned numReads = 0;
+};
+
+class PayloadOverlayTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    base.members["a.bin"] = std::vector<char>(256, '\0');
+    base.members["b.bin"] = std::vector<char>(256, '\x11');
+  }
+
+  MemberMapPayload base;
+};
+
+TEST_F(PayloadOverlayTest, RecordsPatchesAndChangedMembers) {
+  OverlayRecordingPayload recorder(base, /*baseHash=*/42);
+  std::vector<char> const patch{'\x01', '\x02'};
+  ASSERT_FALSE(llvm::errorToBool(recorder.patchMember("a.bin", 10, patch)));
+  EXPECT_EQ(base.numReads, 0U);
+
+  auto member = recorder.readMember("b.bin");
+  ASSERT_TRUE(bool(member));
+  member.get()[100] = '\x22';
+  member.get()[104] = '\x22';
+  member.get()[200] = '\x33';
+  ASSERT_FALSE(llvm::errorToBool(recorder.writeBack()));
+
+  // nearby changes are coalesced into one patch
+  auto patches = recorder.getOverlay().getPatches();
+  ASSERT_EQ(patches.size(), 3U);
+  EXPECT_EQ(patches[0].member, "a.bin");
+  EXPECT_EQ(patches[0].offset, 10U);
+  EXPECT_EQ(patches[0].bytes, patch);
+  EXPECT_EQ(patches[1].member, "b.bin");
+  EXPECT_EQ(patches[1].offset, 100U);
+  EXPECT_EQ(patches[1].bytes.size(), 5U);
+  EXPECT_EQ(patches[2].offset, 200U);
+  EXPECT_EQ(patches[2].bytes, std::vector<char>{'\x33'});
+
+  // the base payload is not modified
+  EXPECT_EQ(base.members["b.bin"], std::vector<char>(256, '\x11'));
+}
+
+TEST_F(PayloadOverlayTest, SerializationRoundTrips) {
+  PayloadOverlay overlay(PayloadOverlay::hashBase("base"));
+  overlay.addPatch("a.bin", 3, std::vector<char>{'\x01', '\x02'});
+  overlay.addPatch("b.bin", 7, std::vector<char>{'\x03'});
+
+  std::string const serialized = overlay.serialize();
+  ASSERT_TRUE(PayloadOverlay::isOverlay(serialized));
+  auto deserialized = PayloadOverlay::deserialize(serialized);
+  ASSERT_TRUE(bool(deserialized)) << llvm::toString(deserialized.takeError());
+  EXPECT_FALSE(llvm::errorToBool(deserialized->verifyBase("base")));
+  EXPECT_TRUE(llvm::errorToBool(deserialized->verifyBase("other")));
+  ASSERT_EQ(deserialized->getPatches().size(), 2U);
+  EXPECT_EQ(deserialized->getPatches()[1].member, "b.bin");
+  EXPECT_EQ(deserialized->getPatches()[1].offset, 7U);
+
+  EXPECT_TRUE(llvm::errorToBool(
+      PayloadOverlay::deserialize(serialized.substr(0, serialized.size() - 1))
+          .takeError()));
+}
+
+TEST_F(PayloadOverlayTest, OverlaysAreAppliedLazily) {
+  PayloadOverlay overlay(/*baseHash=*/0);
+  overlay.addPatch("a.bin", 0, std::vector<char>{'\x01', '\x01'});
+  overlay.addPatch("a.bin", 1, std::vector<char>{'\x02'});
+  OverlayPayload payload(base, std::move(overlay));
+
+  auto unpatched = payload.readMember("b.bin");
+  ASSERT_TRUE(bool(unpatched));
+  EXPECT_EQ(&unpatched.get(), &base.members["b.bin"]);
+
+  auto patched = payload.readMember("a.bin");
+  ASSERT_TRUE(bool(patched));
+  EXPECT_EQ(patched.get()[0], '\x01');
+  EXPECT_EQ(patched.get()[1], '\x02');
+  EXPECT_EQ(patched.get()[2], '\0');
+  EXPECT_EQ(base.members["a.bin"][0], '\0');
+
+  EXPECT_TRUE(llvm::errorToBool(payload.writeBack()));
+}
+
+} // anonymous namespace
@@ -0,0 +1,139 @@
+//===- ZipStreamingTest.cpp -------------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file implements test cases for streaming and compressed zip payload
+/// output.
+///
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+
+#include "Payload/Payload.h"
+#include "Payload/PayloadRegistry.h"
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <utility>
+
+namespace {
+
+std::unique_ptr<qssc::payload::Payload> createZipPayload() {
+  auto payloadInfo =
+      qssc::payload::registry::PayloadRegistry::lookupPluginInfo("ZIP");
+  if (!payloadInfo.has_value())
+    return nullptr;
+  const qssc::payload::PayloadConfig config{"test", "test",
+                                            qssc::config::QSSVerbosity::Warn};
+  auto created = payloadInfo.value()->createPluginInstance(config);
+  if (!created) {
+    llvm::consumeError(created.takeError());
+    return nullptr;
+  }
+  return std::move(created.get());
+}
+
+size_t countOccurrences(llvm::StringRef haystack, llvm::StringRef needle) {
+  size_t count = 0;
+  for (size_t pos = haystack.find(needle); pos != llvm::StringRef::npos;
+       pos = haystack.find(needle, pos + 1))
+    ++count;
+  return count;
+}
+
+TEST(ZipStreaming, CommittedFilesAreWrittenImmediately) {
+  auto payload = createZipPayload();
+  ASSERT_NE(payload, nullptr);
+  ASSERT_TRUE(payload->supportsStreaming());
+
+  std::string output;
+  llvm::raw_string_ostream ostream(output);
+  ASSERT_FALSE(llvm::errorToBool(payload->beginStreaming(ostream)));
+
+  {
+    qssc::payload::Payload::EmissionScope emission(*payload);
+    payload->getFile("first.txt")->assign("first contents");
+    ASSERT_FALSE(llvm::errorToBool(emission.commit()));
+  }
+  // The committed file is in the stream before the archive is finished
+  EXPECT_TRUE(llvm::StringRef(output).startswith("PK\x03\x04"));
+  EXPECT_NE(llvm::StringRef(output).find("first contents"),
+            llvm::StringRef::npos);
+
+  // Files outside of an emission scope are written when finishing
+  payload->addFile("second.txt", "second contents");
+  EXPECT_EQ(llvm::StringRef(output).find("second contents"),
+            llvm::StringRef::npos);
+
+  ASSERT_FALSE(llvm::errorToBool(payload->finishStreaming()));
+  EXPECT_FALSE(payload->isStreaming());
+
+  llvm::StringRef const archive(output);
+  EXPECT_NE(archive.find("second contents"), llvm::StringRef::npos);
+  // first.txt, second.txt and the manifest
+  EXPECT_EQ(countOccurrences(archive, "PK\x03\x04"), 3U);
+  EXPECT_EQ(countOccurrences(archive, "PK\x01\x02"), 3U);
+  // The archive ends with a comment-less end of central directory record
+  ASSERT_GE(archive.size(), 22U);
+  EXPECT_TRUE(archive.drop_front(archive.size() - 22).startswith("PK\x05\x06"));
+}
+
+TEST(ZipStreaming, FileWrittenTwiceIsAnError) {
+  auto payload = createZipPayload();
+  ASSERT_NE(payload, nullptr);
+
+  std::string output;
+  llvm::raw_string_ostream ostream(output);
+  ASSERT_FALSE(llvm::errorToBool(payload->beginStreaming(ostream)));
+
+  for (int i = 0; i < 2; ++i) {
+    qssc::payload::Payload::EmissionScope emission(*payload);
+    payload->getFile("twice.txt")->assign("contents");
+    auto err = emission.commit();
+    EXPECT_EQ(llvm::errorToBool(std::move(err)), i == 1);
+  }
+  EXPECT_FALSE(llvm::errorToBool(payload->finishStreaming()));
+}
+
+TEST(ZipCompression, CompressibleFilesAreDeflated) {
+  auto payload = createZipPayload();
+  ASSERT_NE(payload, nullptr);
+
+  if (auto err = payload->setCompression("*.txt=deflate")) {
+    llvm::consumeError(std::move(err));
+    GTEST_SKIP() << "LLVM was built without zlib";
+  }
+
+  payload->addFile("test/waveform.txt", std::string(64 * 1024, 'a'));
+  std::string output;
+  llvm::raw_string_ostream ostream(output);
+  payload->write(ostream);
+
+  llvm::StringRef const archive(output);
+  EXPECT_TRUE(archive.startswith("PK\x03\x04"));
+  EXPECT_LT(archive.size(), 64U * 1024U);
+  EXPECT_EQ(countOccurrences(archive, "PK\x01\x02"), 2U);
+}
+
+TEST(ZipCompression, InvalidRulesAreRejected) {
+  auto payload = createZipPayload();
+  ASSERT_NE(payload, nullptr);
+
+  EXPECT_TRUE(llvm::errorToBool(payload->setCompression("*.bin=lzma")));
+  EXPECT_TRUE(llvm::errorToBool(payload->setCompression("=store")));
+  EXPECT_FALSE(llvm::errorToBool(payload->setCompression("")));
+}
+
+} // anonymous namespace
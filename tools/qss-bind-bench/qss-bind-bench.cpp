@@ -0,0 +1,412 @@
+//===- qss-bind-bench.cpp ---------------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements a benchmark of argument binding. It binds arguments
+// into a synthetic zip payload with a configurable number of binaries, binary
+// size and patch point density for each combination of in memory and on disk
+// input and output. It reports binds per second, the number of payload bytes
+// copied per bind and the peak resident set size, as a table or as JSON.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Arguments/Arguments.h"
+#include "Arguments/BindingPlan.h"
+#include "Arguments/Signature.h"
+#include "Payload/PatchableZipPayload.h"
+#include "Payload/Payload.h"
+#include "Payload/PayloadBuffer.h"
+#include "Payload/PayloadRegistry.h"
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Config/llvm-config.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/FileUtilities.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#if LLVM_ON_UNIX
+#include <sys/resource.h>
+#endif
+
+using namespace qssc::arguments;
+using namespace qssc::payload;
+
+namespace {
+llvm::cl::opt<unsigned>
+    numBinaries("num-binaries",
+                llvm::cl::desc("Number of patched binaries in the payload"),
+                llvm::cl::init(1));
+
+llvm::cl::opt<uint64_t>
+    binarySize("binary-size",
+               llvm::cl::desc("Size in bytes of each patched binary"),
+               llvm::cl::init(1 << 20));
+
+llvm::cl::opt<double> patchDensity(
+    "patch-density",
+    llvm::cl::desc("Number of patch points per KiB of each binary"),
+    llvm::cl::init(0.0625));
+
+llvm::cl::opt<unsigned> numParameters(
+    "num-parameters",
+    llvm::cl::desc("Number of parameters bound per payload, which are "
+                   "assigned to the patch points in turn"),
+    llvm::cl::init(64));
+
+llvm::cl::opt<unsigned>
+    numIterations("iterations",
+                  llvm::cl::desc("Number of binds per input/output mode"),
+                  llvm::cl::init(20));
+
+llvm::cl::list<std::string> modeNames(
+    "modes",
+    llvm::cl::desc("Input/output modes to run, e.g., disk->memory (default: "
+                   "all). Run one mode per process to measure its peak RSS "
+                   "on its own."),
+    llvm::cl::CommaSeparated);
+
+llvm::cl::opt<bool> emitJSON("json",
+                             llvm::cl::desc("Emit the results as JSON"),
+                             llvm::cl::init(false));
+
+constexpr llvm::StringLiteral signatureName = "signature.bin";
+constexpr llvm::StringLiteral patchType = "f64";
+
+/// Binds parameters by writing them as little endian doubles
+class BenchBindArguments : public BindArgumentsImplementation {
+public:
+  llvm::Error patch(PatchPoint const &patchPoint,
+                    ArgumentSource const &arguments) override {
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "Patch points are always encoded");
+  }
+
+  llvm::Error parseParamMapIntoSignature(llvm::StringRef paramMapContents,
+                                         llvm::StringRef paramMapFileName,
+                                         Signature &sig) override {
+    return llvm::Error::success();
+  }
+
+  PatchablePayload *getPayload(llvm::StringRef payloadOutputPath,
+                               bool enableInMemory) override {
+    return new PatchableZipPayload(payloadOutputPath, enableInMemory);
+  }
+
+  llvm::Expected<Signature>
+  parseSignature(PatchablePayload *payload) override {
+    auto signature = payload->readMember(signatureName, false);
+    if (!signature)
+      return signature.takeError();
+    return Signature::deserialize(
+        llvm::StringRef(signature->data(), signature->size()), std::nullopt);
+  }
+
+  /// Plans the bind straight from the mapped signature member without
+  /// materializing a Signature
+  llvm::Expected<BindingPlan>
+  parseBindingPlan(PatchablePayload *payload) override {
+    auto signature = payload->viewMember(signatureName);
+    if (!signature)
+      return signature.takeError();
+    auto view = BinarySignatureView::create(*signature);
+    if (!view)
+      return view.takeError();
+    return BindingPlan::create(*view);
+  }
+
+  llvm::Expected<bool>
+  encodePatch(PatchPoint const &patchPoint, ArgumentType const &value,
+              llvm::SmallVectorImpl<char> &bytes) override {
+    auto const &angle = std::get<std::optional<double>>(value);
+    if (!angle.has_value())
+      return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                     "Missing value for " +
+                                         patchPoint.expression());
+    char encoded[sizeof(double)];
+    llvm::support::endian::write<double, llvm::support::little>(encoded,
+                                                                *angle);
+    bytes.append(std::begin(encoded), std::end(encoded));
+    return true;
+  }
+
+  llvm::Expected<bool>
+  encodePatchColumn(PatchPoint const &patchPoint,
+                    llvm::ArrayRef<double> values,
+                    llvm::SmallVectorImpl<char> &bytes) override {
+    // a plain loop over the column, which the compiler vectorizes
+    size_t const begin = bytes.size();
+    bytes.resize_for_overwrite(begin + values.size() * sizeof(double));
+    char *out = bytes.data() + begin;
+    for (size_t i = 0; i < values.size(); ++i)
+      llvm::support::endian::write<double, llvm::support::little>(
+          out + i * sizeof(double), values[i]);
+    return true;
+  }
+};
+
+class BenchBindArgumentsFactory : public BindArgumentsImplementationFactory {
+public:
+  BindArgumentsImplementation *
+  create(OptDiagnosticCallback onDiagnostic) override {
+    return new BenchBindArguments();
+  }
+  BindArgumentsImplementation *
+  create(std::vector<char> &buf, OptDiagnosticCallback onDiagnostic) override {
+    return new BenchBindArguments();
+  }
+  BindArgumentsImplementation *
+  create(std::string &str, OptDiagnosticCallback onDiagnostic) override {
+    return new BenchBindArguments();
+  }
+};
+
+/// Binds the iteration number to every parameter
+class BenchArgumentSource : public ArgumentSource {
+public:
+  explicit BenchArgumentSource(double value) : value(value) {}
+  ArgumentType getArgumentValue(llvm::StringRef name) const override {
+    return value;
+  }
+
+private:
+  double value;
+};
+
+std::string parameterName(unsigned parameter) {
+  return "p" + std::to_string(parameter);
+}
+
+std::string binaryName(unsigned binary) {
+  return "binary" + std::to_string(binary) + ".bin";
+}
+
+uint64_t patchPointsPerBinary() {
+  return std::max<uint64_t>(1, patchDensity * binarySize / 1024);
+}
+
+/// Peak resident set size of the process in bytes, or 0 if unknown
+uint64_t getPeakRSS() {
+#if LLVM_ON_UNIX
+  struct rusage usage {};
+  if (getrusage(RUSAGE_SELF, &usage) != 0)
+    return 0;
+#if defined(__APPLE__)
+  return usage.ru_maxrss;
+#else
+  return static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+#endif
+#else
+  return 0;
+#endif
+}
+
+/// Create a zip payload with numBinaries binaries of binarySize bytes and a
+/// signature patching doubles spread evenly over each binary
+llvm::Expected<std::string> createPayload() {
+  auto payloadInfo = registry::PayloadRegistry::lookupPluginInfo("ZIP");
+  if (!payloadInfo.has_value())
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "ZIP payload is not registered");
+  const PayloadConfig config{"bench", "bench",
+                             qssc::config::QSSVerbosity::Warn};
+  auto created = payloadInfo.value()->createPluginInstance(config);
+  if (!created)
+    return created.takeError();
+  auto payload = std::move(created.get());
+
+  uint64_t const numPatchPoints = patchPointsPerBinary();
+  uint64_t const stride = binarySize / numPatchPoints;
+  if (stride < sizeof(double))
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "Binary too small for the patch points");
+  unsigned const parameters = std::max(numParameters.getValue(), 1U);
+  Signature sig;
+  uint64_t patchPoint = 0;
+  for (unsigned binary = 0; binary < numBinaries; ++binary) {
+    for (uint64_t i = 0; i < numPatchPoints; ++i, ++patchPoint)
+      sig.addParameterPatchPoint(parameterName(patchPoint % parameters),
+                                 patchType, binaryName(binary), i * stride);
+    payload->addFile(binaryName(binary), std::vector<char>(binarySize));
+  }
+  payload->addFile(signatureName, sig.serializeBinary());
+
+  std::string output;
+  llvm::raw_string_ostream stream(output);
+  payload->write(stream);
+  stream.flush();
+  return output;
+}
+
+struct Mode {
+  llvm::StringRef name;
+  bool inMemoryInput;
+  bool inMemoryOutput;
+};
+
+struct Result {
+  llvm::StringRef mode;
+  double bindsPerSecond;
+  double bytesCopiedPerBind;
+  /// Peak RSS of the process after running the mode
+  uint64_t peakRSS;
+};
+
+llvm::Expected<Result> runMode(Mode const &mode, llvm::StringRef payload,
+                               llvm::StringRef inputPath,
+                               llvm::StringRef outputPath) {
+  BenchBindArgumentsFactory factory;
+  PayloadBuffer::resetBytesCopied();
+  auto const start = std::chrono::steady_clock::now();
+  for (unsigned iteration = 0; iteration < numIterations; ++iteration) {
+    std::string output;
+    BenchArgumentSource const arguments(iteration);
+    if (auto err = bindArguments(
+            mode.inMemoryInput ? payload : inputPath,
+            mode.inMemoryOutput ? llvm::StringRef() : outputPath, arguments,
+            /*treatWarningsAsErrors=*/false, mode.inMemoryInput, &output,
+            factory, std::nullopt))
+      return std::move(err);
+  }
+  auto const elapsed = std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - start);
+
+  unsigned const binds = std::max(numIterations.getValue(), 1U);
+  return Result{mode.name, binds / elapsed.count(),
+                double(PayloadBuffer::getBytesCopied()) / binds, getPeakRSS()};
+}
+
+void printText(llvm::ArrayRef<Result> results, uint64_t payloadSize) {
+  llvm::outs() << "payload size: " << payloadSize << " bytes, "
+               << numBinaries << " binaries, "
+               << numBinaries * patchPointsPerBinary() << " patch points\n";
+  llvm::outs() << llvm::format("%-16s %12s %16s %12s %14s\n", "input->output",
+                               "binds/s", "bytes copied", "payloads",
+                               "peak RSS KiB");
+  for (auto const &result : results)
+    llvm::outs() << llvm::format(
+        "%-16s %12.1f %16.1f %12.2f %14llu\n", result.mode.str().c_str(),
+        result.bindsPerSecond, result.bytesCopiedPerBind,
+        result.bytesCopiedPerBind / payloadSize,
+        static_cast<unsigned long long>(result.peakRSS / 1024));
+}
+
+void printJSON(llvm::ArrayRef<Result> results, uint64_t payloadSize) {
+  llvm::json::OStream json(llvm::outs(), /*IndentSize=*/2);
+  json.object([&] {
+    json.attributeObject("config", [&] {
+      json.attribute("num_binaries", int64_t(numBinaries));
+      json.attribute("binary_size", int64_t(binarySize));
+      json.attribute("patch_points_per_binary",
+                     int64_t(patchPointsPerBinary()));
+      json.attribute("num_parameters", int64_t(numParameters));
+      json.attribute("iterations", int64_t(numIterations));
+      json.attribute("payload_size", int64_t(payloadSize));
+    });
+    json.attributeArray("results", [&] {
+      for (auto const &result : results)
+        json.object([&] {
+          json.attribute("mode", result.mode);
+          json.attribute("binds_per_second", result.bindsPerSecond);
+          json.attribute("bytes_copied_per_bind", result.bytesCopiedPerBind);
+          json.attribute("payloads_copied_per_bind",
+                         result.bytesCopiedPerBind / payloadSize);
+          json.attribute("peak_rss_bytes", int64_t(result.peakRSS));
+        });
+    });
+  });
+  llvm::outs() << "\n";
+}
+
+llvm::Error runBenchmark() {
+  Mode const modes[] = {{"disk->disk", false, false},
+                        {"disk->memory", false, true},
+                        {"memory->disk", true, false},
+                        {"memory->memory", true, true}};
+  llvm::SmallVector<Mode const *> selected;
+  for (auto const &mode : modes)
+    if (modeNames.empty() || llvm::is_contained(modeNames, mode.name))
+      selected.push_back(&mode);
+  for (auto const &name : modeNames)
+    if (llvm::none_of(modes,
+                      [&](Mode const &mode) { return mode.name == name; }))
+      return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                     "Unknown mode " + name);
+
+  auto payload = createPayload();
+  if (!payload)
+    return payload.takeError();
+
+  llvm::SmallString<128> inputPath;
+  llvm::SmallString<128> outputPath;
+  if (auto ec = llvm::sys::fs::createTemporaryFile("bind-bench-in", "qem",
+                                                   inputPath))
+    return llvm::errorCodeToError(ec);
+  llvm::FileRemover const inputRemover(inputPath);
+  if (auto ec = llvm::sys::fs::createTemporaryFile("bind-bench-out", "qem",
+                                                   outputPath))
+    return llvm::errorCodeToError(ec);
+  llvm::FileRemover const outputRemover(outputPath);
+  if (auto err = PayloadBuffer::borrow(*payload).writeToFile(inputPath))
+    return err;
+
+  llvm::SmallVector<Result> results;
+  for (auto const *mode : selected) {
+    auto result = runMode(*mode, *payload, inputPath, outputPath);
+    if (!result)
+      return result.takeError();
+    results.push_back(*result);
+  }
+
+  if (emitJSON)
+    printJSON(results, payload->size());
+  else
+    printText(results, payload->size());
+  return llvm::Error::success();
+}
+} // anonymous namespace
+
+auto main(int argc, char **argv) -> int {
+  llvm::InitLLVM const y(argc, argv);
+  llvm::cl::ParseCommandLineOptions(
+      argc, argv, "Benchmark binding arguments into payloads\n");
+
+  if (auto err = runBenchmark()) {
+    llvm::logAllUnhandledErrors(std::move(err), llvm::errs(),
+                                "qss-bind-bench: ");
+    return 1;
+  }
+  return 0;
+}
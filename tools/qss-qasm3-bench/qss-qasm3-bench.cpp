@@ -0,0 +1,208 @@
+//===- qss-qasm3-bench.cpp --------------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements a benchmark of the OpenQASM 3 frontend. It generates a
+// program with many variables in scope and deeply nested control flow, which
+// stresses the scoping of SSA values during QUIR generation, and reports the
+// time to parse it and generate QUIR, as a table or as JSON. The program may
+// also declare gates, so that the gate definition cache can be measured by
+// comparing runs with and without --qasm3-gate-cache: the first iteration
+// populates the cache and later iterations reuse its definitions.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Dialect/RegisterDialects.h"
+#include "Frontend/OpenQASM3/OpenQASM3Frontend.h"
+
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/DialectRegistry.h"
+#include "mlir/IR/Location.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/IR/OwningOpRef.h"
+#include "mlir/Support/Timing.h"
+
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <string>
+#include <utility>
+
+namespace {
+llvm::cl::opt<unsigned>
+    depth("depth", llvm::cl::desc("Nesting depth of the control flow"),
+          llvm::cl::init(64));
+
+llvm::cl::opt<unsigned> numVariables(
+    "num-variables",
+    llvm::cl::desc("Number of qubits and of integer variables in scope"),
+    llvm::cl::init(256));
+
+llvm::cl::opt<unsigned>
+    numGates("num-gates",
+             llvm::cl::desc("Number of gates declared and applied once each"),
+             llvm::cl::init(0));
+
+llvm::cl::opt<unsigned>
+    numIterations("iterations",
+                  llvm::cl::desc("Number of times the program is compiled"),
+                  llvm::cl::init(5));
+
+llvm::cl::opt<bool> emitJSON("json",
+                             llvm::cl::desc("Emit the results as JSON"),
+                             llvm::cl::init(false));
+
+llvm::cl::opt<bool>
+    printProgram("print-program",
+                 llvm::cl::desc("Print the generated program and exit"),
+                 llvm::cl::init(false));
+
+/// Generate a program declaring numVariables qubits and integers, followed
+/// by depth levels of alternately nested if statements and for loops. Each
+/// level assigns one of the integers and applies a gate to one of the qubits.
+/// numGates gates are declared first and each applied to one of the qubits.
+std::string generateProgram() {
+  unsigned const variables = std::max(numVariables.getValue(), 1U);
+  std::string program = "OPENQASM 3.0;\nbit c;\n";
+  for (unsigned i = 0; i < numGates; ++i)
+    program += "gate g" + std::to_string(i) + " q { U(0." +
+               std::to_string(i + 1) + ", 0.0, 0.0) q; U(0.0, 0.1, 0.0) q; " +
+               "}\n";
+  for (unsigned i = 0; i < variables; ++i)
+    program += "qubit $" + std::to_string(i) + ";\n";
+  for (unsigned i = 0; i < numGates; ++i)
+    program +=
+        "g" + std::to_string(i) + " $" + std::to_string(i % variables) + ";\n";
+  for (unsigned i = 0; i < variables; ++i)
+    program +=
+        "int[32] v" + std::to_string(i) + " = " + std::to_string(i) + ";\n";
+  program += "c = measure $0;\n";
+
+  for (unsigned level = 0; level < depth; ++level) {
+    std::string const index = std::to_string(level % variables);
+    if (level % 2 == 0)
+      program += "if (c == 1) {\n";
+    else
+      program += "for i" + std::to_string(level) + " in [0 : 1] {\n";
+    program += "v" + index + " = v" + index + " + 1;\n";
+    program += "U(0.1, 0.0, 0.0) $" + index + ";\n";
+  }
+  for (unsigned level = 0; level < depth; ++level)
+    program += "}\n";
+  return program;
+}
+
+struct Result {
+  /// Time of the first iteration, which populates the gate definition cache
+  double firstMilliseconds;
+  double meanMilliseconds;
+  double minMilliseconds;
+};
+
+llvm::Expected<Result> runBenchmark(std::string const &program) {
+  mlir::DialectRegistry registry;
+  qssc::dialect::registerDialects(registry);
+  mlir::MLIRContext context(registry);
+  mlir::DefaultTimingManager timingManager;
+
+  unsigned const iterations = std::max(numIterations.getValue(), 1U);
+  double first = 0;
+  double total = 0;
+  double min = std::numeric_limits<double>::max();
+  for (unsigned iteration = 0; iteration < iterations; ++iteration) {
+    mlir::OwningOpRef<mlir::ModuleOp> module(
+        mlir::ModuleOp::create(mlir::UnknownLoc::get(&context)));
+    mlir::TimingScope timing = timingManager.getRootScope();
+
+    auto const start = std::chrono::steady_clock::now();
+    if (auto err = qssc::frontend::openqasm3::parse(
+            program, /*sourceIsFilename=*/false, /*emitRawAST=*/false,
+            /*emitPrettyAST=*/false, /*emitMLIR=*/true, module.get(),
+            std::nullopt, timing))
+      return std::move(err);
+    double const elapsed = std::chrono::duration<double, std::milli>(
+                               std::chrono::steady_clock::now() - start)
+                               .count();
+    if (iteration == 0)
+      first = elapsed;
+    total += elapsed;
+    min = std::min(min, elapsed);
+  }
+  return Result{first, total / iterations, min};
+}
+
+void printText(Result const &result, uint64_t programSize) {
+  llvm::outs() << "program size: " << programSize << " bytes, depth "
+               << depth << ", " << numVariables << " variables, "
+               << numGates << " gates\n";
+  llvm::outs() << llvm::format("%12s %12s %12s\n", "first ms", "mean ms",
+                               "min ms");
+  llvm::outs() << llvm::format("%12.2f %12.2f %12.2f\n",
+                               result.firstMilliseconds,
+                               result.meanMilliseconds, result.minMilliseconds);
+}
+
+void printJSON(Result const &result, uint64_t programSize) {
+  llvm::json::OStream json(llvm::outs(), /*IndentSize=*/2);
+  json.object([&] {
+    json.attributeObject("config", [&] {
+      json.attribute("depth", int64_t(depth));
+      json.attribute("num_variables", int64_t(numVariables));
+      json.attribute("num_gates", int64_t(numGates));
+      json.attribute("iterations", int64_t(numIterations));
+      json.attribute("program_size", int64_t(programSize));
+    });
+    json.attributeObject("results", [&] {
+      json.attribute("first_ms", result.firstMilliseconds);
+      json.attribute("mean_ms", result.meanMilliseconds);
+      json.attribute("min_ms", result.minMilliseconds);
+    });
+  });
+  llvm::outs() << "\n";
+}
+} // anonymous namespace
+
+auto main(int argc, char **argv) -> int {
+  llvm::InitLLVM const y(argc, argv);
+  llvm::cl::ParseCommandLineOptions(
+      argc, argv, "Benchmark the OpenQASM 3 frontend on nested programs\n");
+
+  std::string const program = generateProgram();
+  if (printProgram) {
+    llvm::outs() << program;
+    return 0;
+  }
+
+  auto result = runBenchmark(program);
+  if (!result) {
+    llvm::logAllUnhandledErrors(result.takeError(), llvm::errs(),
+                                "qss-qasm3-bench: ");
+    return 1;
+  }
+  if (emitJSON)
+    printJSON(*result, program.size());
+  else
+    printText(*result, program.size());
+  return 0;
+}